@@ -227,5 +227,14 @@ public:
     explicit FilesystemException(const char* message);
 };
 
+class TransformException : public ApplicationException {
+protected:
+    TransformException();
+
+public:
+    explicit TransformException(const std::string& message);
+    explicit TransformException(const char* message);
+};
+
 
 #endif // APP_EXCEPTIONS_H
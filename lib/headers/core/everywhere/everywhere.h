@@ -7,6 +7,7 @@
 #include "misc/singleton.h"
 
 #include "misc/deltatime.h"
+#include "job/jobsystem.h"
 #include "window/window.h"
 
 #include "graphics/graphics.h"
@@ -19,23 +20,32 @@
 #include "camera/freecamera.h"
 #include "camera/targetcamera.h"
 
+#include "storage/shaderstorage.h"
 #include "storage/texturestorage.h"
 #include "storage/modelstorage.h"
+#include "storage/impostorstorage.h"
 
 #include "storage/lightstorage.h"
 #include "light/light.h"
 #include "light/pointlight.h"
 
 #include "storage/materialstorage.h"
+#include "render/frameringbuffer.h"
+#include "render/geometrypool.h"
+#include "render/lodselector.h"
+#include "render/materialtable.h"
+#include "render/qualitygovernor.h"
+#include "render/renderqueue.h"
 #include "space/space.h"
 #include "projection/projection.h"
 #include "projection/orthographic.h"
 #include "projection/perspective.h"
 
+#include <atomic>
 #include <string>
-#include <unordered_map>
 #include <typeinfo>
 #include <type_traits>
+#include <vector>
 
 
 class Everywhere final : public Singleton<Everywhere> {
@@ -47,80 +57,101 @@ private:
     }
 
 private:
-    std::unordered_map<std::string, ICanBeEverywhere*> m_units;
+    // one slot per registered type, Get is a single load; acquire pairs
+    // with the release in Init, so worker threads may read after init
+    template <typename U>
+    inline static std::atomic<U*> s_slot { nullptr };
+
+    struct Unit {
+        std::string name;
+        ICanBeEverywhere* unit;
+        void (*clearSlot)();
+    };
+
+private:
+    std::vector<Unit> m_units; // owning, in init order
 
     template <typename U>
-    U& FindBase() {
-        for (auto& unit : m_units) {
-            using Base = typename std::remove_pointer<decltype(unit.second)>::type;
-            using Derived = typename std::remove_pointer<U>::type;
+    static void ClearSlot() {
+        s_slot<U>.store(nullptr, std::memory_order_release);
+    }
 
-            if (std::is_base_of<Base, Derived>::value) {
-                return *dynamic_cast<U*>(unit.second);
+    template <typename U>
+    U* FindBase() const {
+        for (const auto& unit : m_units) {
+            if (auto derived = dynamic_cast<U*>(unit.unit)) {
+                return derived;
             }
         }
 
         throw EverywhereException { "Unit \"" + ClassName<U>() + "\" is not exists" };
     }
 
+    template <typename U>
+    U* Load() const {
+        U* unit = s_slot<U>.load(std::memory_order_acquire);
+
+        if (!unit) {
+            throw EverywhereException { "Unit \"" + ClassName<U>() + "\" is not exists" };
+        }
+
+        return unit;
+    }
+
 public:
     Everywhere();
     virtual ~Everywhere();
 
     template <typename U>
     U& Get() {
-        if (!m_units.count(ClassName<U>())) {
-            throw EverywhereException { "Unit \"" + ClassName<U>() + "\" is not exists" };
-        }
-
-        return *dynamic_cast<U*>(m_units.at(ClassName<U>()));
+        return *Load<U>();
     }
 
     template <typename U>
     const U& Get() const {
-        if (!m_units.count(ClassName<U>())) {
-            throw EverywhereException { "Unit \"" + ClassName<U>() + "\" is not exists" };
-        }
-
-        return *dynamic_cast<U*>(m_units.at(ClassName<U>()));
+        return *Load<U>();
     }
 
     template <typename U>
     U& FindSimilarClass() {
-        if (!m_units.count(ClassName<U>())) {
-            return FindBase<U>();
-        }
-
-        return *dynamic_cast<U*>(m_units.at(ClassName<U>()));
+        U* unit = s_slot<U>.load(std::memory_order_acquire);
+        return unit ? *unit : *FindBase<U>();
     }
 
     template <typename U>
     const U& FindSimilarClass() const {
-        if (!m_units.count(ClassName<U>())) {
-            return FindBase<U>();
-        }
-
-        return *dynamic_cast<U*>(m_units.at(ClassName<U>()));
+        U* unit = s_slot<U>.load(std::memory_order_acquire);
+        return unit ? *unit : *FindBase<U>();
     }
 
     template <typename U>
     void Init(U* unit) {
-        if (!dynamic_cast<ICanBeEverywhere*>(unit)) {
+        auto everywhereUnit = dynamic_cast<ICanBeEverywhere*>(unit);
+
+        if (!everywhereUnit) {
             throw EverywhereException { "Some unit cannot Init to Everywhere" };
         }
 
-        if (m_units.count(ClassName<U>())) {
+        if (s_slot<U>.load(std::memory_order_relaxed)) {
             throw EverywhereException { "Unit \"" + ClassName<U>() + "\" already exists" };
         }
 
-        m_units[ClassName<U>()] = unit;
+        m_units.push_back(Unit { ClassName<U>(), everywhereUnit, &Everywhere::ClearSlot<U> });
+        s_slot<U>.store(unit, std::memory_order_release);
     }
 
     template <typename U>
     void Free() {
-        if (m_units.count(ClassName<U>())) {
-            delete m_units[ClassName<U>()];
-            m_units[ClassName<U>()] = nullptr;
+        U* unit = s_slot<U>.exchange(nullptr, std::memory_order_acq_rel);
+        if (!unit) return;
+
+        const auto name = ClassName<U>();
+        for (auto it = m_units.begin(); it != m_units.end(); ++it) {
+            if (it->name == name) {
+                delete it->unit;
+                m_units.erase(it);
+                break;
+            }
         }
     }
 };
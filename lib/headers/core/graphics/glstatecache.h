@@ -0,0 +1,84 @@
+#ifndef GLSTATECACHE_H
+#define GLSTATECACHE_H
+
+#include <glad/glad.h>
+
+#include <cstdint>
+#include <limits>
+#include <unordered_map>
+
+
+// shadow copy of the context state, skips calls that would change nothing
+class GLStateCache final {
+private:
+    static constexpr GLuint UNKNOWN_BINDING { std::numeric_limits<GLuint>::max() };
+    static constexpr GLenum UNKNOWN_ENUM { GL_NONE };
+
+private:
+    GLuint m_program;
+    GLuint m_vertexArray;
+    GLuint m_elementBuffer; // belongs to the bound vertex array
+
+    GLenum m_activeTexture;
+    std::unordered_map<uint64_t, GLuint> m_textures; // unit + target
+    std::unordered_map<GLenum, GLuint> m_buffers;
+    std::unordered_map<uint64_t, GLuint> m_indexedBuffers; // target + index
+
+    std::unordered_map<GLenum, bool> m_capabilities;
+    GLenum m_depthFunc;
+    GLenum m_cullFace;
+    GLenum m_blendSource;
+    GLenum m_blendDestination;
+    GLuint m_depthMask;
+
+    uint64_t m_issuedCalls;
+    uint64_t m_skippedCalls;
+
+private:
+    static uint64_t PairKey(GLenum first, GLuint second);
+
+    // true when the call has to reach the driver
+    bool Update(GLuint& cached, GLuint value);
+
+public:
+    GLStateCache(const GLStateCache&) = delete;
+    GLStateCache(GLStateCache&&) noexcept = delete;
+    GLStateCache& operator=(const GLStateCache&) = delete;
+    GLStateCache& operator=(GLStateCache&&) noexcept = delete;
+
+public:
+    GLStateCache();
+    ~GLStateCache() = default;
+
+public:
+    void UseProgram(GLuint program);
+    void BindVertexArray(GLuint vertexArray);
+
+    void ActiveTexture(GLenum unit);
+    void BindTexture(GLenum unit, GLenum target, GLuint texture);
+
+    void BindBuffer(GLenum target, GLuint buffer);
+    void BindBufferBase(GLenum target, GLuint index, GLuint buffer);
+    // ranges move every frame, never skipped
+    void BindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size);
+
+    void SetCapability(GLenum capability, bool enabled);
+    void DepthFunc(GLenum func);
+    void DepthMask(bool enabled);
+    void CullFace(GLenum mode);
+    void BlendFunc(GLenum source, GLenum destination);
+
+    // deleted names revert their bindings to zero inside the driver
+    void ForgetTexture(GLuint texture);
+    void ForgetBuffer(GLuint buffer);
+    void ForgetVertexArray(GLuint vertexArray);
+
+    // after somebody touched the context behind the cache
+    void Invalidate();
+
+    uint64_t GetIssuedCallCount() const;
+    uint64_t GetSkippedCallCount() const;
+    void ResetCallCounters();
+};
+
+#endif // GLSTATECACHE_H
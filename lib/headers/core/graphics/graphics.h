@@ -24,6 +24,9 @@ protected:
 public:
     virtual void UpdateViewportSize() const = 0;
     virtual void Flush() const = 0;
+
+    virtual void SetAntialiasing(bool enabled) = 0;
+    virtual bool IsAntialiasing() const = 0;
 };
 
 #endif // GRAPHICS_H
@@ -2,12 +2,18 @@
 #define OPENGL_H
 
 #include "graphics.h"
+#include "graphics/glstatecache.h"
 #include "misc/color.h"
 
 
 class OpenGL final : public Graphics {
+private:
+    static GLStateCache* s_state; // of the living unit
+
 private:
     Color m_clearColor;
+    GLStateCache m_state;
+    bool m_antialiasing;
 
 private:
     void UpdateClearColor();
@@ -21,9 +27,16 @@ public:
 
 public:
     OpenGL();
-    ~OpenGL() = default;
+    ~OpenGL();
 
 public:
+    // every bind goes through here, throws while no OpenGL unit is alive
+    static GLStateCache& State();
+    static bool HasState();
+
+    GLStateCache& GetState();
+    const GLStateCache& GetState() const;
+
     Color GetClearColor() const;
     void SetClearColor(const Color& clearColor);
 
@@ -34,6 +47,9 @@ public: /* Graphics */
     void UpdateViewportSize() const override;
     void Flush() const override;
 
+    void SetAntialiasing(bool enabled) override;
+    bool IsAntialiasing() const override;
+
 public: /* IProcess */
     void Processing() override;
 };
@@ -21,6 +21,9 @@ public: /* Graphics */
     void UpdateViewportSize() const override;
     void Flush() const override;
 
+    void SetAntialiasing(bool enabled) override;
+    bool IsAntialiasing() const override;
+
 public: /* IProcess */
     void Processing() override;
 };
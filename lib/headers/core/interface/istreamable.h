@@ -0,0 +1,47 @@
+#ifndef ISTREAMABLE_H
+#define ISTREAMABLE_H
+
+#include <glad/glad.h>
+
+#include <algorithm>
+#include <cstddef>
+
+
+// texture whose finest mip levels may be dropped and brought back;
+// level 0 is the full size, the resident level the finest one in memory
+class IStreamable {
+public:
+    // levels below this size are never dropped
+    static constexpr GLsizei MIN_RESIDENT_SIZE { 64 };
+
+public:
+    virtual ~IStreamable() = default;
+
+public:
+    static GLsizei GetCoarsestLevel(GLsizei width, GLsizei height, GLsizei levelCount) {
+        GLsizei level { 0 };
+
+        while (level + 1 < levelCount &&
+               std::max(width, height) >> (level + 1) >= MIN_RESIDENT_SIZE) {
+            ++level;
+        }
+
+        return level;
+    }
+
+public:
+    // otherwise always fully resident
+    virtual bool IsStreamable() const = 0;
+
+    virtual GLsizei GetWidth() const = 0;
+    virtual GLsizei GetHeight() const = 0;
+    virtual GLsizei GetLevelCount() const = 0;
+
+    virtual GLsizei GetResidentLevel() const = 0;
+    virtual void SetResidentLevel(GLsizei level) = 0;
+
+    // GPU memory taken with the given resident level
+    virtual size_t GetResidentBytes(GLsizei level) const = 0;
+};
+
+#endif // ISTREAMABLE_H
@@ -0,0 +1,133 @@
+#ifndef JOBSYSTEM_H
+#define JOBSYSTEM_H
+
+#include "interface/icanbeeverywhere.h"
+#include "job/workstealingdeque.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+class JobCounter;
+
+enum class JobAffinity {
+    ANY,
+    MAIN_THREAD, // GL work, runs inside JobSystem::ProcessMainThreadJobs or Wait
+    WORKER       // long CPU work, never picked up by the main thread, not even inside Wait
+};
+
+struct Job {
+    std::function<void()> task;
+    JobCounter* counter;
+    JobAffinity affinity;
+};
+
+
+// jobs still running against it, continuations start when it drops to zero
+class JobCounter final {
+private:
+    friend class JobSystem;
+
+private:
+    std::atomic<size_t> m_pending;
+
+    std::mutex m_mutex;
+    std::vector<Job*> m_continuations;
+    std::exception_ptr m_exception; // first one thrown by a job
+
+public:
+    JobCounter(const JobCounter&) = delete;
+    JobCounter(JobCounter&&) noexcept = delete;
+    JobCounter& operator=(const JobCounter&) = delete;
+    JobCounter& operator=(JobCounter&&) noexcept = delete;
+
+public:
+    JobCounter();
+    ~JobCounter() = default;
+
+public:
+    bool IsDone() const;
+};
+
+
+// one Chase-Lev deque per worker, idle workers steal from random victims
+// and sleep when nothing is left; the main thread has no deque, what it
+// submits is injected, and inside Wait it only runs jobs of that counter
+class JobSystem final : public ICanBeEverywhere {
+public:
+    static constexpr size_t DEQUE_CAPACITY { 4096 };
+    static constexpr size_t NO_WORKER { SIZE_MAX };
+
+private:
+    static thread_local size_t s_workerIndex;
+
+private:
+    std::vector<std::unique_ptr<WorkStealingDeque>> m_deques;
+    std::vector<std::thread> m_threads;
+
+    std::mutex m_injectedMutex;
+    std::deque<Job*> m_injectedJobs; // from threads without a deque or with a full one
+
+    std::mutex m_mainThreadMutex;
+    std::deque<Job*> m_mainThreadJobs;
+
+    std::mutex m_wakeMutex;
+    std::condition_variable m_wake;
+    std::atomic<size_t> m_queuedJobs;
+    std::atomic<bool> m_stopping;
+
+private:
+    void WorkerLoop(size_t index);
+
+    WorkStealingDeque* GetOwnDeque() const;
+
+    Job* FindJob();
+    Job* PopMainThreadJob();
+    // an injected job of the counter the main thread waits on
+    Job* PopInjectedJob(const JobCounter& counter);
+    void Schedule(Job* job);
+    void Execute(Job* job);
+    void Finish(JobCounter& counter);
+
+public:
+    JobSystem(const JobSystem&) = delete;
+    JobSystem(JobSystem&&) noexcept = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+    JobSystem& operator=(JobSystem&&) noexcept = delete;
+
+public:
+    // zero workers: one per hardware thread besides the calling one
+    explicit JobSystem(size_t workerCount = 0);
+    ~JobSystem();
+
+public:
+    void Run(std::function<void()> task, JobCounter& counter,
+             JobAffinity affinity = JobAffinity::ANY);
+    // queued once the dependency reaches zero
+    void RunAfter(JobCounter& dependency, std::function<void()> task, JobCounter& counter,
+                  JobAffinity affinity = JobAffinity::ANY);
+
+    // runs other jobs meanwhile, rethrows the first exception of the counter's jobs
+    void Wait(JobCounter& counter);
+
+    // body gets [begin, end) ranges; ranges split in halves while larger than
+    // the grain, so idle threads steal the big halves first
+    void ParallelFor(size_t count, const std::function<void(size_t, size_t)>& body,
+                     size_t minGrain = 1);
+
+    void ProcessMainThreadJobs();
+
+    // the main thread included
+    size_t GetThreadCount() const;
+    bool IsMainThread() const;
+};
+
+#endif // JOBSYSTEM_H
@@ -0,0 +1,45 @@
+#ifndef WORKSTEALINGDEQUE_H
+#define WORKSTEALINGDEQUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+
+struct Job;
+
+
+// Chase-Lev deque with a fixed ring: the owner pushes and pops at the bottom,
+// any other thread steals from the top
+class WorkStealingDeque final {
+private:
+    std::vector<std::atomic<Job*>> m_ring;
+    int64_t m_mask;
+
+    alignas(64) std::atomic<int64_t> m_top;
+    alignas(64) std::atomic<int64_t> m_bottom;
+
+public:
+    WorkStealingDeque(const WorkStealingDeque&) = delete;
+    WorkStealingDeque(WorkStealingDeque&&) noexcept = delete;
+    WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+    WorkStealingDeque& operator=(WorkStealingDeque&&) noexcept = delete;
+
+public:
+    // capacity is rounded up to a power of two
+    explicit WorkStealingDeque(size_t capacity);
+    ~WorkStealingDeque() = default;
+
+public: /* owner */
+    // false when full, the caller injects the job instead
+    bool Push(Job* job);
+    Job* Pop();
+
+public: /* thieves */
+    Job* Steal();
+
+    bool IsEmpty() const;
+};
+
+#endif // WORKSTEALINGDEQUE_H
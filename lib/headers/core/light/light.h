@@ -5,6 +5,8 @@
 #include "mesh/mesh.h"
 #include "misc/color.h"
 
+#include <glm/glm.hpp>
+
 #include <memory>
 
 
@@ -19,6 +21,9 @@ protected:
     Color m_color;
     std::shared_ptr<Mesh> m_childMesh;
 
+private:
+    glm::mat4 m_lastGlobalMatrix;
+
 public:
     Light();
     virtual ~Light() = default;
@@ -29,6 +34,9 @@ public:
     Color GetColor() const;
     void SetColor(const Color& color);
 
+protected:
+    void MarkDirty() const;
+
 public: /* IProcess */
     void Processing() override;
 };
@@ -0,0 +1,53 @@
+#ifndef INDEXEDTEXTUREMATERIAL_H
+#define INDEXEDTEXTUREMATERIAL_H
+
+#include "texturematerial.h"
+#include "render/materialtable.h"
+
+#include <cstdint>
+
+
+// samples its textures from the TextureStorage arrays through a MaterialTable
+// record, so every such material with one shader goes out in one draw
+class IndexedTextureMaterial final : public TextureMaterial {
+private:
+    uint32_t m_tableIndex;
+    MaterialRecord m_record;
+
+private:
+    MaterialRecord MakeRecord() const;
+
+public:
+    IndexedTextureMaterial(const IndexedTextureMaterial&) = delete;
+    IndexedTextureMaterial(IndexedTextureMaterial&&) noexcept = delete;
+    IndexedTextureMaterial& operator=(const IndexedTextureMaterial&) = delete;
+    IndexedTextureMaterial& operator=(IndexedTextureMaterial&&) noexcept = delete;
+
+public:
+    ~IndexedTextureMaterial() = default;
+
+    explicit IndexedTextureMaterial(const TextureParams& diffuse,
+                                    const TextureParams& specular,
+                                    const TextureParams& emission);
+
+    explicit IndexedTextureMaterial(const TextureParams& diffuse,
+                                    const TextureParams& specular,
+                                    const TextureParams& emission,
+                                    float shininess);
+
+public: /* Material */
+    const void* GetBatchKey() const override;
+    uint32_t GetTableIndex() const override;
+    void RequestTextureResidency(float screenSize) const override;
+
+protected: /* TextureMaterial */
+    void OnParamsChanged() override;
+
+protected: /* Material */
+    void DoInitShader() override;
+
+public: /* IProcess */
+    void Processing() override;
+};
+
+#endif // INDEXEDTEXTUREMATERIAL_H
@@ -4,16 +4,21 @@
 #include "interface/iprocess.h"
 #include "misc/collectionof.h"
 #include "shader/shader.h"
-#include "transform/parenttransformation.h"
 
+#include <cstdint>
+#include <functional>
 #include <memory>
+#include <vector>
 
 
-class Material :
-    public IProcess,
-    public ParentTransformation {
+class Material : public IProcess {
+protected:
+    using UniformProcessing = std::function<void(Shader*)>;
+    using UniformProcessingVector = std::vector<UniformProcessing>;
+
 protected:
     std::shared_ptr<Shader> m_shader;
+    UniformProcessingVector m_uniformProcessingFunctions;
 
 public:
     Material(const Material&) = delete;
@@ -32,6 +37,16 @@ public:
     const std::shared_ptr<Shader> GetShader() const;
     void SetShader(const std::shared_ptr<Shader>& shader);
 
+    UniformProcessingVector& UniformProcessingFunctions();
+    const UniformProcessingVector& UniformProcessingFunctions() const;
+
+    // materials with equal keys share one bind and so one draw call
+    virtual const void* GetBatchKey() const;
+    // record in the MaterialTable, passed to the shader per instance
+    virtual uint32_t GetTableIndex() const;
+    // asks for the mip levels of its textures, screen size in pixels
+    virtual void RequestTextureResidency(float screenSize) const;
+
 protected:
     virtual void DoInitShader() = 0;
 
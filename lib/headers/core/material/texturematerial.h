@@ -34,6 +34,15 @@ public:
                              const TextureParams& emission,
                              float shininess);
 
+protected:
+    explicit TextureMaterial(const std::shared_ptr<Shader>& shader,
+                             const TextureParams& diffuse,
+                             const TextureParams& specular,
+                             const TextureParams& emission,
+                             float shininess);
+
+    virtual void OnParamsChanged();
+
 public:
     std::shared_ptr<Texture> GetDiffuse() const;
     std::shared_ptr<Texture> GetSpecular() const;
@@ -50,6 +59,9 @@ public:
     float GetShininess() const;
     void SetShininess(float shininess);
 
+public: /* Material */
+    void RequestTextureResidency(float screenSize) const override;
+
 protected: /* Material */
     void DoInitShader() override;
 
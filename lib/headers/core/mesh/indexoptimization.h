@@ -0,0 +1,53 @@
+#ifndef INDEXOPTIMIZATION_H
+#define INDEXOPTIMIZATION_H
+
+#include "misc/vertex.h"
+
+#include <glad/glad.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+
+// triangle lists reordered for the post-transform vertex cache,
+// vertices reordered for fetch locality
+namespace indexoptimization {
+
+// FIFO entries of the simulated post-transform cache
+static constexpr size_t ANALYSIS_CACHE_SIZE { 16 };
+
+struct VertexCacheStats {
+    size_t triangles {};
+    size_t vertices {};   // referenced ones
+    size_t transforms {}; // cache misses
+
+    // transforms per triangle, 0.5 is the best a large grid can get
+    float GetAcmr() const;
+    // transforms per vertex, 1.0 is the best
+    float GetAtvr() const;
+
+    VertexCacheStats& operator+=(const VertexCacheStats& other);
+};
+
+struct OptimizationStats {
+    VertexCacheStats before;
+    VertexCacheStats after;
+
+    OptimizationStats& operator+=(const OptimizationStats& other);
+};
+
+VertexCacheStats AnalyzeVertexCache(const std::vector<GLuint>& indices, size_t vertexCount,
+                                    size_t cacheSize = ANALYSIS_CACHE_SIZE);
+
+// Forsyth's linear-speed ordering, triangles only
+void OptimizeVertexCache(std::vector<GLuint>& indices, size_t vertexCount);
+// vertices in first use order, unreferenced ones dropped
+void OptimizeVertexFetch(std::vector<Vertex>& vertices, std::vector<GLuint>& indices);
+
+// both of the above on a triangle list, with the cache before and after
+OptimizationStats Optimize(std::vector<Vertex>& vertices, std::vector<GLuint>& indices);
+
+} // namespace indexoptimization
+
+#endif // INDEXOPTIMIZATION_H
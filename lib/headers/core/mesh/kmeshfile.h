@@ -0,0 +1,78 @@
+#ifndef KMESHFILE_H
+#define KMESHFILE_H
+
+#include "object/modeldata.h"
+#include "mesh/indexoptimization.h"
+#include "misc/bounds.h"
+#include "misc/mappedfile.h"
+#include "misc/vertex.h"
+#include "misc/vertexformat.h"
+
+#include <glad/glad.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+
+// compiled model next to its source as <source>.kmesh: vertices encoded in
+// the format of each mesh, indices in 16 bits when they fit, mesh bounds
+// and materials. Mapped on load,
+// meshes upload straight from the mapping. Stale once the source size or
+// content changes, an mtime change alone only costs a hash of the source.
+// Generated LODs go next to it as <source>.lod<N>.kmesh with their error
+class KMeshFile final {
+public:
+    static constexpr uint32_t VERSION { 4 };
+
+    struct MeshView {
+        const void* vertices;
+        size_t vertexCount;
+        VertexFormat format;
+        const void* indices;
+        GLenum indexType;
+        size_t indexCount;
+
+        Bounds bounds;
+        ImportedMaterial material;
+    };
+
+private:
+    MappedFile m_file;
+    std::vector<MeshView> m_meshes;
+    float m_error;
+
+public:
+    KMeshFile() = delete;
+    KMeshFile(const KMeshFile&) = delete;
+    KMeshFile(KMeshFile&&) noexcept = delete;
+    KMeshFile& operator=(const KMeshFile&) = delete;
+    KMeshFile& operator=(KMeshFile&&) noexcept = delete;
+
+public:
+    explicit KMeshFile(const std::filesystem::path& sourcePath, size_t lod = 0);
+    ~KMeshFile() = default;
+
+public:
+    static std::filesystem::path GetPath(const std::filesystem::path& sourcePath, size_t lod = 0);
+    static bool IsUpToDate(const std::filesystem::path& sourcePath, size_t lod = 0);
+
+    // false when the file can't be written
+    static bool Write(const std::filesystem::path& sourcePath,
+                      const std::vector<ImportedMesh>& meshes,
+                      size_t lod = 0, float error = 0.0f);
+    // imports the source with Assimp and writes the result,
+    // adds the vertex cache of the imported meshes to the stats
+    static bool Compile(const std::filesystem::path& sourcePath,
+                        const std::filesystem::path& textureDirectory,
+                        indexoptimization::OptimizationStats* stats = nullptr);
+
+    size_t GetMeshCount() const;
+    MeshView& GetMesh(size_t meshId);
+    const MeshView& GetMesh(size_t meshId) const;
+    // of a generated LOD against the source, model units
+    float GetError() const;
+};
+
+#endif // KMESHFILE_H
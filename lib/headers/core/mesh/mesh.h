@@ -3,8 +3,12 @@
 
 #include "object/object.h"
 #include "misc/vertex.h"
+#include "misc/bounds.h"
+#include "misc/vertexformat.h"
+#include "render/geometrypool.h"
 
 #include <glad/glad.h>
+#include <glm/glm.hpp>
 
 #include <cstddef>
 #include <vector>
@@ -14,6 +18,8 @@ enum class AttribIndex : GLuint {
     POSITION,
     NORMAL,
     TEXTURE,
+    INSTANCE_TRANSFORM, // mat4, takes four locations
+    INSTANCE_MATERIAL = INSTANCE_TRANSFORM + 4, // MaterialTable index
 };
 
 enum class MeshDrawingMode : GLenum {
@@ -31,10 +37,14 @@ public:
     friend void swap(Mesh&, Mesh&);
 
 private:
-    GLuint vao, vbo, ebo;
+    GeometryRange m_geometry; // inside the GeometryPool
 
     std::vector<Vertex> m_verices;
     std::vector<GLuint> m_indices;
+    Bounds m_bounds; // local space
+
+    VertexFormat m_format; // in the GeometryPool
+    glm::mat4 m_dequantization;
 
     size_t m_materialId;
     MeshDrawingMode m_drawingMode;
@@ -51,8 +61,15 @@ public:
     Mesh& operator=(Mesh&&) noexcept = delete;
 
 public:
+    // without a format only the streams holding data are kept, at full precision
     Mesh(const std::vector<Vertex>& verices, const std::vector<GLuint>& indices);
     Mesh(std::vector<Vertex>&& verices, std::vector<GLuint>&& indices) noexcept;
+    Mesh(std::vector<Vertex>&& verices, std::vector<GLuint>&& indices,
+         const VertexFormat& format) noexcept;
+    // uploads straight from the given memory, already encoded in the format
+    // within the bounds, keeps no CPU copy
+    Mesh(const void* verices, size_t vertexCount, const VertexFormat& format,
+         const void* indices, GLenum indexType, size_t indexCount, const Bounds& bounds);
     virtual ~Mesh();
 
 public:
@@ -63,6 +80,15 @@ public:
     void SetDrawingMode(MeshDrawingMode drawingMode);
     void SetDrawingMode(GLenum drawingMode);
 
+    const GeometryRange& GetGeometry() const;
+    const Bounds& GetBounds() const;
+    const VertexFormat& GetVertexFormat() const;
+    // takes quantized positions back to local space, part of the instance transform
+    const glm::mat4& GetDequantization() const;
+    GLsizei GetIndexCount() const;
+
+    Bounds GetLocalBounds() const override;
+
 public: /* IProcess */
     void Processing() override;
 };
@@ -0,0 +1,27 @@
+#ifndef MESHSIMPLIFICATION_H
+#define MESHSIMPLIFICATION_H
+
+#include "misc/vertex.h"
+
+#include <glad/glad.h>
+
+#include <cstddef>
+#include <vector>
+
+
+// quadric error metric edge collapses on triangle lists, the base of the
+// generated LODs. Collapses move a vertex onto a neighbour (half-edge), so
+// no attribute is ever interpolated; vertices on borders and on seams,
+// where one position has several vertices, are never moved
+namespace meshsimplification {
+
+// collapses until at most targetIndexCount indices are left or the next
+// collapse would move the surface further than targetError, in model units;
+// the vertices are untouched, unreferenced ones are left to OptimizeVertexFetch.
+// Returns the error reached, in model units
+float Simplify(const std::vector<Vertex>& vertices, std::vector<GLuint>& indices,
+               size_t targetIndexCount, float targetError);
+
+} // namespace meshsimplification
+
+#endif // MESHSIMPLIFICATION_H
@@ -0,0 +1,36 @@
+#ifndef BOUNDS_H
+#define BOUNDS_H
+
+#include "misc/vertex.h"
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+
+// axis-aligned box and bounding sphere around the same geometry
+struct Bounds final {
+public:
+    glm::vec3 min;
+    glm::vec3 max;
+    glm::vec3 center; // of the sphere
+    float radius;
+
+public:
+    Bounds();
+    explicit Bounds(const glm::vec3& min, const glm::vec3& max);
+
+    static Bounds FromVertices(const std::vector<Vertex>& vertices);
+
+public:
+    bool IsEmpty() const;
+
+    // box of the transformed box, sphere of the transformed sphere
+    Bounds Transformed(const glm::mat4& transform) const;
+    void Merge(const Bounds& other);
+
+    // world center in xyz, radius in w
+    glm::vec4 ToSphere(const glm::mat4& transform) const;
+};
+
+#endif // BOUNDS_H
@@ -3,12 +3,19 @@
 
 #include <string>
 #include <filesystem>
+#include <functional>
+#include <ostream>
 
 
 namespace filesystem {
 
 std::string GetContentFile(const std::filesystem::path& path);
 
+// writes a file beside the path and renames it over, so readers never see
+// a half written file; false when anything fails
+bool ReplaceContentFile(const std::filesystem::path& path,
+                        const std::function<void(std::ostream&)>& write);
+
 }
 
 #endif // FILESYSTEM_H
@@ -0,0 +1,36 @@
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+
+// read-only view of a whole file; mapped where the platform allows,
+// read into memory otherwise
+class MappedFile final {
+private:
+    const uint8_t* m_data;
+    size_t m_size;
+
+    bool m_mapped;
+    std::vector<uint8_t> m_buffer; // when not mapped
+
+public:
+    MappedFile() = delete;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile(MappedFile&&) noexcept = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile& operator=(MappedFile&&) noexcept = delete;
+
+public:
+    explicit MappedFile(const std::filesystem::path& path);
+    ~MappedFile();
+
+public:
+    const uint8_t* GetData() const;
+    size_t GetSize() const;
+};
+
+#endif // MAPPEDFILE_H
@@ -0,0 +1,27 @@
+#ifndef SOURCESTAMP_H
+#define SOURCESTAMP_H
+
+#include <cstdint>
+#include <filesystem>
+
+
+// identifies the source file a compiled file was made from,
+// stored as is inside the compiled file
+struct SourceStamp final {
+public:
+    uint64_t size;
+    int64_t time;
+    uint64_t hash; // FNV-1a of the content
+
+public:
+    static SourceStamp Of(const std::filesystem::path& sourcePath);
+
+public:
+    // a different size never matches; a different time costs a hash of the
+    // source, on a match the time is taken over so it is cheap next time
+    bool Matches(const std::filesystem::path& sourcePath);
+};
+
+static_assert(sizeof(SourceStamp) == 24, "SourceStamp is part of file formats");
+
+#endif // SOURCESTAMP_H
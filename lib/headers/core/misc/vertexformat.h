@@ -0,0 +1,69 @@
+#ifndef VERTEXFORMAT_H
+#define VERTEXFORMAT_H
+
+#include "misc/bounds.h"
+#include "misc/vertex.h"
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+
+
+enum class PositionEncoding : uint8_t {
+    FLOAT3,
+    UNORM16, // inside the mesh box, scaled back by the instance transform
+};
+
+enum class NormalEncoding : uint8_t {
+    NONE,
+    FLOAT3,
+    SNORM_2_10_10_10,
+};
+
+enum class TextureEncoding : uint8_t {
+    NONE,
+    FLOAT2,
+    HALF2,
+};
+
+
+// how a mesh keeps its vertices in the GeometryPool; the vertex fetch
+// decodes every encoding, so all formats feed the same shader inputs,
+// missing streams read as zero
+struct VertexFormat final {
+public:
+    PositionEncoding position;
+    NormalEncoding normal;
+    TextureEncoding texture;
+
+public:
+    VertexFormat();
+    explicit VertexFormat(PositionEncoding position, NormalEncoding normal,
+                          TextureEncoding texture);
+
+    // the Vertex layout
+    static VertexFormat Full();
+    // drops streams without data, the quantized one also packs the rest
+    static VertexFormat Choose(const Vertex* vertices, size_t count, bool quantize);
+    static bool FromKey(uint32_t key, VertexFormat& format);
+
+public:
+    bool operator==(const VertexFormat& other) const;
+    bool operator!=(const VertexFormat& other) const;
+
+    uint32_t GetKey() const;
+    GLsizei GetStride() const;
+    bool IsQuantized() const;
+
+    // maps quantized positions back into the box, identity otherwise
+    glm::mat4 GetDequantization(const Bounds& bounds) const;
+
+    // GetStride() * count bytes; the bounds have to hold every position
+    void Encode(const Vertex* vertices, size_t count, const Bounds& bounds, uint8_t* result) const;
+
+    void SetAttribFormats(GLuint vertexArray, GLuint binding) const;
+};
+
+#endif // VERTEXFORMAT_H
@@ -4,16 +4,29 @@
 #include "object.h"
 
 #include <filesystem>
+#include <memory>
 #include <vector>
 
 
+class ModelData;
+
+// a LOD file or a LOD generated from the source file
+struct ModelLod {
+    std::filesystem::path path;
+    size_t level; // of the generated LOD, 0 for files
+    std::shared_ptr<ModelData> data; // resolved once, the storage keeps it too
+};
+
+
 class Model : public Object {
 public:
     friend void swap(Model&, Model&);
 
 protected:
-    std::vector<std::filesystem::path> m_lods;
-    float m_distanceStep;
+    std::vector<ModelLod> m_lods;
+    std::vector<float> m_lodErrors; // model units, known once a generated LOD is imported
+    size_t m_lodId; // selected last frame
+    bool m_isImpostor; // drawn as the impostor of the source last frame
 
 public:
     Model() = delete;
@@ -31,15 +44,21 @@ public:
                    std::filesystem::path textureDirectory);
 
 public:
-    std::vector<std::filesystem::path>& GetLODs();
-    const std::vector<std::filesystem::path>& GetLODs() const;
+    std::vector<ModelLod>& GetLODs();
+    const std::vector<ModelLod>& GetLODs() const;
+
+    // of the most detailed LOD
+    Bounds GetLocalBounds() const override;
 
 private:
-    // Add after the calculation of the number of LODs.
-    void UpdateDistanceStep();
+    // LOD files next to the source, generated LODs when there are none
     void UpdateLODs(const std::filesystem::path& path);
-    float GetDistanceToCamera() const;
-    size_t GetCurrentLodId() const;
+    const std::shared_ptr<ModelData>& GetLodData(size_t lodId) const;
+    void UpdateLodErrors();
+    size_t SelectLod(const Bounds& bounds, const glm::mat4& transform);
+    bool SelectImpostor(const Bounds& bounds, const glm::mat4& transform);
+    // the wanted LOD or the closest one already uploaded
+    std::shared_ptr<ModelData> GetReadyLod(size_t lodId) const;
 
 public: /* IProcess */
     void Processing() override;
@@ -2,17 +2,91 @@
 #define MODELDATA_H
 
 #include "object.h"
+#include "mesh/indexoptimization.h"
+#include "misc/bounds.h"
+#include "misc/vertex.h"
+#include "misc/vertexformat.h"
+#include "texture/decodedimage.h"
 
 #include <assimp/scene.h>
+#include <glad/glad.h>
+#include <glm/glm.hpp>
 
+#include <atomic>
+#include <cstddef>
+#include <exception>
 #include <filesystem>
+#include <memory>
 #include <vector>
 
 
+enum class ModelDataState {
+    IMPORTING, // on a worker, nothing to draw
+    UPLOADING, // CPU data is complete, GL objects are created frame by frame
+    READY,
+    FAILED
+};
+
+class KMeshFile;
+
+// what the importer decided, the GL side is created on upload;
+// an empty texture path stands for the default texture
+struct ImportedMaterial {
+    bool textured;
+    std::filesystem::path diffuse;
+    std::filesystem::path specular;
+    std::filesystem::path emission;
+
+    // decoded on the import worker, null for compiled and default textures;
+    // shared by the meshes of a model that use the same image
+    std::shared_ptr<const DecodedImage> diffuseImage;
+    std::shared_ptr<const DecodedImage> specularImage;
+    std::shared_ptr<const DecodedImage> emissionImage;
+};
+
+struct ImportedMesh {
+    std::vector<Vertex> vertices;
+    std::vector<GLuint> indices;
+    VertexFormat format; // on the GPU, picked per mesh
+    ImportedMaterial material;
+    indexoptimization::OptimizationStats optimization; // empty unless triangles
+};
+
+
 class ModelData : public Object {
 public:
     friend void swap(ModelData&, ModelData&);
 
+public:
+    // simplified from the source when no hand made LODs exist
+    static constexpr size_t GENERATED_LOD_COUNT { 3 };
+
+private:
+    Bounds m_bounds; // of all meshes, model space
+
+    std::filesystem::path m_path;
+    std::filesystem::path m_textureDirectory;
+    size_t m_lod; // generated LOD of the source, 0 for the source itself
+    float m_error;
+
+    std::atomic<ModelDataState> m_state;
+    std::vector<ImportedMesh> m_importedMeshes;
+    std::unique_ptr<KMeshFile> m_compiled; // instead of the imported meshes when up to date
+    // of the source, shared with its generated LODs so Assimp reads it once
+    std::shared_ptr<std::vector<ImportedMesh>> m_sourceMeshes;
+    size_t m_uploadedMeshes;
+    std::exception_ptr m_importError;
+
+private:
+    size_t GetMeshCount() const;
+    ImportedMaterial& GetMeshMaterial(size_t meshId);
+    const ImportedMaterial& GetMeshMaterial(size_t meshId) const;
+    // the image files of every material, read on the worker so the upload only copies pixels
+    void DecodeTextures();
+    // vertices, indices and the decoded images not in the texture storage yet
+    size_t GetMeshBytes(size_t meshId) const;
+    void UploadMesh(size_t meshId);
+
 public:
     ModelData() = delete;
     ModelData(const ModelData&) = delete;
@@ -23,8 +97,33 @@ public:
 public:
     explicit ModelData(const std::filesystem::path& path);
     explicit ModelData(const std::filesystem::path& path,
-                       const std::filesystem::path& textureDirectory);
-    virtual ~ModelData() = default;
+                       const std::filesystem::path& textureDirectory,
+                       size_t lod = 0);
+    virtual ~ModelData();
+
+public:
+    // before Import: the source fills them, its generated LODs start from them
+    // when it ran first; empty when the source was compiled
+    void ShareSourceMeshes(std::shared_ptr<std::vector<ImportedMesh>> meshes);
+    // CPU only, safe on any thread
+    void Import();
+    // main thread, creates meshes and materials until the byte budget is spent,
+    // returns the bytes used; rethrows the import error of a failed model
+    size_t Upload(size_t budget);
+
+    ModelDataState GetState() const;
+    bool IsReady() const;
+
+    size_t GetLod() const;
+    // how far a generated LOD may stray from the source surface,
+    // model units; 0 for sources
+    float GetError() const;
+
+    const Bounds& GetBounds() const;
+    void UpdateBounds();
+
+    // queues every mesh for drawing at the given world transform
+    void AddToRenderQueue(const glm::mat4& transform);
 };
 
 
@@ -32,7 +131,7 @@ class ModelDataImporter final {
 private:
     std::filesystem::path m_filepath;
     std::filesystem::path m_textureDirectory;
-    ModelData* m_modelData;
+    std::vector<ImportedMesh>& m_meshes;
 
 public:
     ModelDataImporter() = delete;
@@ -44,15 +143,16 @@ public:
 public:
     ModelDataImporter(std::filesystem::path filepath,
                       std::filesystem::path textureDirectory,
-                      ModelData* modelData);
+                      std::vector<ImportedMesh>& meshes);
     ~ModelDataImporter() = default;
 
 private:
-    bool CreateTextureMaterialByFilename(const std::filesystem::path& textureDirectory) const;
-    bool CreateTextureMaterialByDefaultFilenames() const;
-    size_t GetMaterialId(aiMesh* mesh, const aiScene* scene) const;
+    bool FindTextureMaterialByFilename(const std::filesystem::path& textureDirectory,
+                                       ImportedMaterial& result) const;
+    bool FindTextureMaterialByDefaultFilenames(ImportedMaterial& result) const;
+    ImportedMaterial GetMaterial(aiMesh* mesh, const aiScene* scene) const;
     void CheckCorrectModelPath() const;
-    void CreateTextureMaterialByAssimpMaterial(aiMaterial* material) const;
+    ImportedMaterial GetTextureMaterialByAssimpMaterial(aiMaterial* material) const;
 
 private:
     void ProcessSceneNode(aiNode* node, const aiScene* scene);
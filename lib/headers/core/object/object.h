@@ -4,6 +4,7 @@
 #include "interface/iprocess.h"
 #include "transform/transformable.h"
 #include "misc/collectionof.h"
+#include "misc/bounds.h"
 
 
 class Object :
@@ -27,6 +28,10 @@ public:
     CollectionOf<Object>& Children();
     const CollectionOf<Object>& Children() const;
 
+    // own space, children included; empty when anything below is unknown
+    virtual Bounds GetLocalBounds() const;
+    Bounds GetWorldBounds() const;
+
 public: /* IProcess */
     void Processing() override;
 };
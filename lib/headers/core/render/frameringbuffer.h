@@ -0,0 +1,93 @@
+#ifndef FRAMERINGBUFFER_H
+#define FRAMERINGBUFFER_H
+
+#include "interface/icanbeeverywhere.h"
+#include "interface/iprocess.h"
+
+#include <glad/glad.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+
+// bytes of the current frame, written through the pointer,
+// read by the GPU at the offset of the buffer
+struct FrameAllocation {
+    void* data {};
+    GLuint buffer {};
+    GLintptr offset {};
+    GLsizeiptr size {};
+};
+
+
+// one persistently mapped coherent buffer split into a region per frame in flight;
+// a fence guards each region, so writes never wait on glBufferSubData
+class FrameRingBuffer final :
+    public ICanBeEverywhere,
+    public IProcess {
+public:
+    static constexpr size_t FRAMES_IN_FLIGHT { 3 };
+    static constexpr size_t DEFAULT_REGION_SIZE { size_t { 4 } << 20 };
+    static constexpr size_t DEFAULT_ALIGNMENT { 16 };
+
+private:
+    struct Storage {
+        GLuint buffer {};
+        uint8_t* mapping {};
+        size_t regionSize {};
+    };
+
+    struct Region {
+        GLsync fence {};
+        std::vector<Storage> retired; // outgrown, deleted once the fence passes
+    };
+
+private:
+    Storage m_storage;
+    std::array<Region, FRAMES_IN_FLIGHT> m_regions;
+    size_t m_region;
+    size_t m_offset; // within the current region
+
+    size_t m_uniformAlignment;
+    size_t m_storageAlignment;
+
+private:
+    static Storage CreateStorage(size_t regionSize);
+    static void DeleteStorage(Storage& storage);
+
+    // a bigger buffer for the rest of the frame, the old one stays until its fence
+    void Grow(size_t minRegionSize);
+    void WaitForRegion(Region& region);
+
+public:
+    FrameRingBuffer(const FrameRingBuffer&) = delete;
+    FrameRingBuffer(FrameRingBuffer&&) noexcept = delete;
+    FrameRingBuffer& operator=(const FrameRingBuffer&) = delete;
+    FrameRingBuffer& operator=(FrameRingBuffer&&) noexcept = delete;
+
+public:
+    FrameRingBuffer();
+    ~FrameRingBuffer();
+
+    explicit FrameRingBuffer(size_t regionSize);
+
+public:
+    // valid until the end of the frame; alignment must be a power of two
+    FrameAllocation Allocate(size_t size, size_t alignment = DEFAULT_ALIGNMENT);
+    FrameAllocation Allocate(const void* data, size_t size, size_t alignment = DEFAULT_ALIGNMENT);
+
+    // offset alignments for glBindBufferRange
+    size_t GetUniformAlignment() const;
+    size_t GetStorageAlignment() const;
+
+    size_t GetRegionSize() const;
+    size_t GetUsedSize() const; // this frame
+
+public: /* IProcess */
+    // ends the frame: fences its region and waits for the next one to be free
+    void Processing() override;
+};
+
+#endif // FRAMERINGBUFFER_H
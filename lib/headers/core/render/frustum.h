@@ -0,0 +1,41 @@
+#ifndef FRUSTUM_H
+#define FRUSTUM_H
+
+#include <glm/glm.hpp>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+
+class Frustum final {
+public:
+    static constexpr size_t PLANE_COUNT { 6 };
+
+private:
+    // normalized, xyz: normal pointing inside, w: distance
+    std::array<glm::vec4, PLANE_COUNT> m_planes;
+
+public:
+    Frustum();
+    ~Frustum() = default;
+    Frustum(const Frustum& other) = default;
+    Frustum& operator=(const Frustum& other) = default;
+
+    // planes of projection * view (Gribb-Hartmann)
+    explicit Frustum(const glm::mat4& viewProjection);
+
+public:
+    const std::array<glm::vec4, PLANE_COUNT>& GetPlanes() const;
+
+    bool TestSphere(const glm::vec4& sphere) const;
+    // conservative: boxes crossing two planes near a corner may pass
+    bool TestAabb(const glm::vec3& min, const glm::vec3& max) const;
+
+    // SoA input, writes 1 into visible[i] for spheres touching the frustum,
+    // four spheres per step with SSE
+    void TestSpheres(const float* x, const float* y, const float* z, const float* radius,
+                     size_t count, uint8_t* visible) const;
+};
+
+#endif // FRUSTUM_H
@@ -0,0 +1,135 @@
+#ifndef GEOMETRYPOOL_H
+#define GEOMETRYPOOL_H
+
+#include "interface/icanbeeverywhere.h"
+#include "misc/vertex.h"
+#include "misc/vertexformat.h"
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <vector>
+
+
+// layout fixed by glMultiDrawElementsIndirect
+struct DrawElementsIndirectCommand {
+    GLuint count;
+    GLuint instanceCount;
+    GLuint firstIndex;
+    GLint baseVertex;
+    GLuint baseInstance;
+};
+
+
+struct GeometryRange {
+    static constexpr size_t NO_PAGE { SIZE_MAX };
+
+    size_t page { NO_PAGE };
+    uint32_t id {}; // unique per allocation, groups draws of one geometry
+
+    GLint baseVertex {};
+    GLsizei vertexCount {};
+    GLuint firstIndex {};
+    GLsizei indexCount {};
+
+    bool IsValid() const;
+};
+
+
+// vertex and index ranges of every mesh share a few large immutable buffers,
+// so a whole material goes out as one multi draw; a page holds one vertex format
+// and one index type
+class GeometryPool final : public ICanBeEverywhere {
+public:
+    static constexpr size_t PAGE_VERTICES { size_t { 1 } << 20 };
+    static constexpr size_t PAGE_INDICES { size_t { 3 } << 20 };
+
+private:
+    // first fit over free ranges, neighbours merge on release
+    class RangeAllocator final {
+    public:
+        static constexpr size_t NO_SPACE { SIZE_MAX };
+
+    private:
+        std::map<size_t, size_t> m_freeRanges; // offset -> size
+
+    public:
+        explicit RangeAllocator(size_t capacity);
+
+        size_t Allocate(size_t size);
+        void Release(size_t offset, size_t size);
+    };
+
+    struct Page {
+        GLuint vertexBuffer;
+        GLuint indexBuffer;
+        RangeAllocator vertices;
+        RangeAllocator indices;
+        size_t vertexArray;
+        GLenum indexType;
+    };
+
+    // one vertex format + per-instance mat4 and material
+    struct VertexArray {
+        VertexFormat format;
+        GLuint vao;
+    };
+
+private:
+    std::vector<VertexArray> m_vertexArrays;
+    std::vector<Page> m_pages;
+    size_t m_boundPage;
+    uint32_t m_nextRangeId;
+
+    // commands of this frame in the FrameRingBuffer
+    GLuint m_indirectBuffer;
+    GLintptr m_indirectOffset;
+
+private:
+    // the vertex array of that format, created when missing
+    size_t GetVertexArray(const VertexFormat& format);
+    size_t AddPage(const VertexFormat& format, GLenum indexType,
+                   size_t vertexCount, size_t indexCount);
+
+public:
+    GeometryPool(const GeometryPool&) = delete;
+    GeometryPool(GeometryPool&&) noexcept = delete;
+    GeometryPool& operator=(const GeometryPool&) = delete;
+    GeometryPool& operator=(GeometryPool&&) noexcept = delete;
+
+public:
+    GeometryPool();
+    ~GeometryPool();
+
+public:
+    // 16 bits whenever every index of the mesh fits
+    static GLenum ChooseIndexType(size_t vertexCount);
+    static size_t GetIndexSize(GLenum indexType);
+
+    GeometryRange Allocate(const std::vector<Vertex>& vertices,
+                           const std::vector<GLuint>& indices);
+    GeometryRange Allocate(const Vertex* vertices, size_t vertexCount,
+                           const GLuint* indices, size_t indexCount);
+    // vertices already encoded in the format, indices narrowed when they fit
+    GeometryRange Allocate(const void* vertices, size_t vertexCount, const VertexFormat& format,
+                           const GLuint* indices, size_t indexCount);
+    // indices of GL_UNSIGNED_SHORT or GL_UNSIGNED_INT
+    GeometryRange Allocate(const void* vertices, size_t vertexCount, const VertexFormat& format,
+                           const void* indices, GLenum indexType, size_t indexCount);
+    void Release(GeometryRange& range);
+
+    size_t GetPageCount() const;
+
+    // copied into the FrameRingBuffer, valid for this frame
+    void UploadInstances(const std::vector<glm::mat4>& transforms,
+                         const std::vector<uint32_t>& materialIndices);
+    void UploadCommands(const std::vector<DrawElementsIndirectCommand>& commands);
+
+    // draws commands [first, first + count) of the uploaded command buffer
+    void MultiDraw(size_t page, GLenum mode, size_t firstCommand, size_t commandCount);
+};
+
+#endif // GEOMETRYPOOL_H
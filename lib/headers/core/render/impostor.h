@@ -0,0 +1,58 @@
+#ifndef IMPOSTOR_H
+#define IMPOSTOR_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <cstddef>
+
+
+class ModelData;
+
+// a model rendered from FRAMES x FRAMES directions spread over the sphere by an
+// octahedral map, into an atlas of albedo and one of normal and depth; drawn as
+// a quad facing the baked direction closest to the camera
+class Impostor final {
+public:
+    static constexpr GLsizei FRAMES { 8 };       // per side of the atlas
+    static constexpr GLsizei FRAME_SIZE { 128 }; // pixels
+    static constexpr GLsizei ATLAS_SIZE { FRAMES * FRAME_SIZE };
+    // the last one is a texel per frame, smaller ones would mix neighbours
+    static constexpr GLsizei ATLAS_LEVELS { 8 };
+
+private:
+    GLuint m_albedo;      // rgb, coverage in a
+    GLuint m_normalDepth; // model space normal in rgb, depth along the frame direction in a
+    glm::vec4 m_sphere;   // model space center, radius in w
+
+private:
+    static GLuint CreateAtlas();
+
+    void Bake(const ModelData& modelData);
+
+public:
+    Impostor(const Impostor&) = delete;
+    Impostor(Impostor&&) noexcept = delete;
+    Impostor& operator=(const Impostor&) = delete;
+    Impostor& operator=(Impostor&&) noexcept = delete;
+
+public:
+    // bakes right away, the model data must be ready
+    explicit Impostor(const ModelData& modelData);
+    ~Impostor();
+
+public:
+    // towards the viewer of frame [x, y], model space; impostor.vert does the same
+    static glm::vec3 GetFrameDirection(GLsizei x, GLsizei y);
+    // the up the frame camera looks with, its right is normalize(cross(up, direction))
+    static glm::vec3 GetFrameUp(const glm::vec3& direction);
+
+    // both atlases with their mip levels, all resident
+    static size_t GetAtlasBytes();
+
+    GLuint GetAlbedo() const;
+    GLuint GetNormalDepth() const;
+    const glm::vec4& GetSphere() const;
+};
+
+#endif // IMPOSTOR_H
@@ -0,0 +1,82 @@
+#ifndef LODSELECTOR_H
+#define LODSELECTOR_H
+
+#include "interface/icanbeeverywhere.h"
+#include "interface/iprocess.h"
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <vector>
+
+
+// picks LODs by their error in pixels: the coarsest LOD whose error stays
+// under the threshold, independent of the far plane and the resolution.
+// A LOD switch needs the threshold crossed by the hysteresis share,
+// so objects at a band edge don't flip every frame
+class LodSelector final :
+    public ICanBeEverywhere,
+    public IProcess {
+public:
+    static constexpr float DEFAULT_MAX_SCREEN_ERROR { 1.0f }; // pixels
+    static constexpr float DEFAULT_HYSTERESIS { 0.25f };
+    // LOD files have no recorded error: the first one is taken below this
+    // bounding sphere diameter in pixels, each next one at half the size
+    static constexpr float FULL_DETAIL_SCREEN_SIZE { 512.0f };
+    static constexpr float UNKNOWN_ERROR { -1.0f };
+    // bounding sphere diameter in pixels below which a model turns to its impostor
+    static constexpr float DEFAULT_IMPOSTOR_SCREEN_SIZE { 48.0f };
+
+private:
+    // of the current frame
+    glm::vec3 m_cameraPosition;
+    float m_pixelScale; // pixels per world unit, at distance one for perspective
+    bool m_isPerspective;
+    float m_depthNear;
+
+    float m_maxScreenError;
+    float m_hysteresis;
+    float m_bias;
+    float m_impostorScreenSize;
+
+public:
+    LodSelector(const LodSelector&) = delete;
+    LodSelector(LodSelector&&) noexcept = delete;
+    LodSelector& operator=(const LodSelector&) = delete;
+    LodSelector& operator=(LodSelector&&) noexcept = delete;
+
+public:
+    LodSelector();
+    ~LodSelector() = default;
+
+public:
+    // lodErrors in model units, UNKNOWN_ERROR where none is recorded;
+    // sphere in world space, modelScale from model to world units
+    size_t Select(const std::vector<float>& lodErrors, const glm::vec4& sphere,
+                  float modelScale, size_t currentLod) const;
+
+    float GetPixelsPerUnit(const glm::vec3& position) const;
+
+    // past the last LOD, with the same hysteresis and bias; sphere in world space
+    bool WantsImpostor(const glm::vec4& sphere, bool isImpostor) const;
+
+    // in log2 steps of the error threshold, above zero is coarser
+    float GetBias() const;
+    void SetBias(float bias);
+
+    float GetMaxScreenError() const;
+    void SetMaxScreenError(float pixels);
+
+    float GetHysteresis() const;
+    void SetHysteresis(float hysteresis);
+
+    // zero turns impostors off
+    float GetImpostorScreenSize() const;
+    void SetImpostorScreenSize(float pixels);
+
+public: /* IProcess */
+    // takes the camera and the projection of the frame, before the space
+    void Processing() override;
+};
+
+#endif // LODSELECTOR_H
@@ -0,0 +1,66 @@
+#ifndef MATERIALTABLE_H
+#define MATERIALTABLE_H
+
+#include "interface/icanbeeverywhere.h"
+#include "texture/texturearray.h"
+
+#include <glad/glad.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+
+// std430 layout, mirrors MaterialRecord in texture-shader.frag
+struct MaterialRecord {
+    TextureSlot diffuse;
+    TextureSlot specular;
+    TextureSlot emission;
+    float shininess;
+    float padding;
+};
+
+
+// per-material parameters of indexed materials in one shader storage buffer,
+// a draw only carries the index of its record
+class MaterialTable final : public ICanBeEverywhere {
+public:
+    static constexpr GLuint MATERIALS_BINDING_POINT { 1 };
+
+private:
+    const bool m_isEnabled;
+
+    std::vector<MaterialRecord> m_records;
+    std::vector<uint32_t> m_freeIndices;
+
+    GLuint m_ssbo;
+    size_t m_capacity;
+    bool m_isDirty;
+
+public:
+    MaterialTable(const MaterialTable&) = delete;
+    MaterialTable(MaterialTable&&) noexcept = delete;
+    MaterialTable& operator=(const MaterialTable&) = delete;
+    MaterialTable& operator=(MaterialTable&&) noexcept = delete;
+
+public:
+    MaterialTable();
+    ~MaterialTable();
+
+    // disabled table keeps the per-texture binding path for new materials
+    explicit MaterialTable(bool isEnabled);
+
+public:
+    bool IsEnabled() const;
+
+    uint32_t Add(const MaterialRecord& record);
+    void Set(uint32_t index, const MaterialRecord& record);
+    void Release(uint32_t index);
+
+    size_t Size() const;
+
+    // uploads pending changes and binds the buffer
+    void Bind();
+};
+
+#endif // MATERIALTABLE_H
@@ -0,0 +1,115 @@
+#ifndef QUALITYGOVERNOR_H
+#define QUALITYGOVERNOR_H
+
+#include "interface/icanbeeverywhere.h"
+#include "interface/iprocess.h"
+
+#include <glad/glad.h>
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+
+
+// the knobs the governor turns, each kept between a highest and a lowest setting;
+// the biases grow towards the lowest, the light count shrinks
+struct QualitySettings {
+    float lodBias {};          // LodSelector
+    GLsizei textureMipBias {}; // TextureStorage
+    size_t maxActiveLights {}; // LightStorage
+    bool antialiasing {};      // Graphics
+};
+
+
+// holds the frame time under a target by trading quality: the CPU time of the
+// frame and the GPU time from timer queries are smoothed, and the slower one
+// decides. Over the target for a while gives up one knob step, in the order
+// of the fields above; well under it for longer takes the last one back.
+// Every adjustment is logged to std::clog
+class QualityGovernor final :
+    public ICanBeEverywhere,
+    public IProcess {
+public:
+    static constexpr float DEFAULT_TARGET_FRAME_TIME { 1.0f / 60.0f }; // seconds
+
+    // shares of the target, the band between them changes nothing
+    static constexpr float DEGRADE_LOAD { 0.95f };
+    static constexpr float UPGRADE_LOAD { 0.7f };
+
+    static constexpr size_t DEGRADE_FRAMES { 15 };  // in a row over the band
+    static constexpr size_t UPGRADE_FRAMES { 120 }; // in a row under the band
+    static constexpr size_t SETTLE_FRAMES { 30 };   // after an adjustment
+
+    static constexpr float SMOOTHING { 0.1f };
+    static constexpr float LOD_BIAS_STEP { 0.5f };
+    static constexpr size_t LIGHTS_STEP { 2 };
+
+    // GPU times are read this many frames late, without waiting
+    static constexpr size_t TIMER_QUERIES { 4 };
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+private:
+    QualitySettings m_highest;
+    QualitySettings m_lowest;
+    QualitySettings m_settings;
+
+    float m_targetFrameTime;
+    bool m_isEnabled;
+
+    Clock::time_point m_frameBegin;
+    float m_cpuTime; // smoothed, seconds
+    float m_gpuTime;
+
+    std::array<GLuint, TIMER_QUERIES> m_queries;
+    size_t m_query; // the one of this frame
+    size_t m_issuedQueries;
+
+    size_t m_overFrames;
+    size_t m_underFrames;
+    size_t m_settleFrames;
+
+private:
+    void ReadGpuTime();
+    void Control();
+
+    bool Degrade();
+    bool Upgrade();
+    void Apply() const;
+    void Log(const char* knob, float from, float to) const;
+
+public:
+    QualityGovernor(const QualityGovernor&) = delete;
+    QualityGovernor(QualityGovernor&&) noexcept = delete;
+    QualityGovernor& operator=(const QualityGovernor&) = delete;
+    QualityGovernor& operator=(QualityGovernor&&) noexcept = delete;
+
+public:
+    QualityGovernor();
+    ~QualityGovernor();
+
+public:
+    // right after DeltaTime, starts the CPU and GPU timers of the frame
+    void BeginFrame();
+
+    float GetTargetFrameTime() const;
+    void SetTargetFrameTime(float seconds);
+
+    // the settings are clamped into the new bounds and applied
+    void SetBounds(const QualitySettings& highest, const QualitySettings& lowest);
+    const QualitySettings& GetSettings() const;
+
+    // disabled, the settings stay where they are
+    bool IsEnabled() const;
+    void SetEnabled(bool isEnabled);
+
+    float GetCpuTime() const;
+    float GetGpuTime() const;
+
+public: /* IProcess */
+    // before the buffer swap, stops the timers and adjusts the next frame
+    void Processing() override;
+};
+
+#endif // QUALITYGOVERNOR_H
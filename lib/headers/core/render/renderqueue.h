@@ -0,0 +1,132 @@
+#ifndef RENDERQUEUE_H
+#define RENDERQUEUE_H
+
+#include "interface/icanbeeverywhere.h"
+#include "interface/iprocess.h"
+#include "render/geometrypool.h"
+#include "render/frustum.h"
+#include "misc/bounds.h"
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+
+class Mesh;
+class Material;
+
+
+struct DrawPacket {
+    uint64_t key;
+
+    Mesh* mesh;
+    Material* material;
+    size_t materialId;
+
+    GLuint program;
+    uint32_t geometry; // pool page and range id
+    GLenum drawingMode;
+
+    glm::mat4 transform;
+    glm::vec4 sphere; // world center, radius in w
+    float viewDepth;
+};
+
+
+struct CullingStats {
+    size_t testedObjects;
+    size_t culledObjects;
+    size_t testedPackets;
+    size_t culledPackets;
+};
+
+
+class RenderQueue final :
+    public ICanBeEverywhere,
+    public IProcess {
+public: /* sort key layout, most significant first */
+    static constexpr uint32_t LAYER_BITS { 2 };
+    static constexpr uint32_t PROGRAM_BITS { 14 };
+    static constexpr uint32_t MATERIAL_BITS { 16 };
+    static constexpr uint32_t GEOMETRY_BITS { 16 };
+    static constexpr uint32_t DEPTH_BITS { 16 };
+
+private:
+    struct SortItem {
+        uint64_t key;
+        uint32_t index;
+    };
+
+    // one glMultiDrawElementsIndirect call
+    struct Batch {
+        Material* material; // first of the batch, binds for all of them
+        size_t page;
+        GLenum drawingMode;
+        size_t firstCommand;
+        size_t commandCount;
+    };
+
+private:
+    std::vector<DrawPacket> m_packets;
+    std::vector<SortItem> m_sortItems;
+    std::vector<SortItem> m_sortScratch;
+    std::vector<glm::mat4> m_instanceTransforms;
+    std::vector<uint32_t> m_instanceMaterials;
+    std::vector<DrawElementsIndirectCommand> m_commands;
+    std::vector<Batch> m_batches;
+
+    Frustum m_frustum;
+    std::vector<float> m_cullX, m_cullY, m_cullZ, m_cullRadius;
+    std::vector<uint8_t> m_visible;
+    CullingStats m_cullingStats;
+
+    std::vector<float> m_materialScreenSizes; // by material id, pixels
+
+    size_t m_drawCallCount;
+
+public:
+    RenderQueue(const RenderQueue&) = delete;
+    RenderQueue(RenderQueue&&) noexcept = delete;
+    RenderQueue& operator=(const RenderQueue&) = delete;
+    RenderQueue& operator=(RenderQueue&&) noexcept = delete;
+
+public:
+    RenderQueue();
+    ~RenderQueue();
+
+private:
+    static uint64_t MakeSortKey(const DrawPacket& packet, float depthFar);
+
+    // drops packets outside the frustum in one SIMD pass
+    void Cull();
+    // streams in the texture levels the visible packets are drawn at
+    void RequestTextures();
+    void BuildSortKeys();
+    void Sort();
+    void BuildCommands();
+    void Submit();
+
+public:
+    // takes the frustum of this frame, call before collection
+    void BeginFrame();
+
+    // coarse test for a whole object before its meshes are added
+    bool IsVisible(const Bounds& bounds, const glm::mat4& transform);
+
+    // collection phase, no GL calls
+    void Add(Mesh& mesh, const glm::mat4& transform);
+
+    const Frustum& GetFrustum() const;
+    size_t GetPacketCount() const;
+    size_t GetDrawCallCount() const;
+    const CullingStats& GetCullingStats() const;
+
+public: /* IProcess */
+    // sorting and submission phase
+    void Processing() override;
+};
+
+#endif // RENDERQUEUE_H
@@ -0,0 +1,92 @@
+#ifndef DYNAMICAABBTREE_H
+#define DYNAMICAABBTREE_H
+
+#include "misc/bounds.h"
+#include "render/frustum.h"
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <vector>
+
+
+class Object;
+
+
+// incremental bounding volume hierarchy over object boxes: leaves hold fattened
+// boxes so small moves need no tree update, inserts pick the cheapest sibling
+// by surface area and rotations keep it balanced, Rebuild runs a binned SAH build
+class DynamicAABBTree final {
+public:
+    static constexpr int NULL_NODE { -1 };
+    static constexpr float FAT_MARGIN { 0.1f };
+
+private:
+    struct Node {
+        glm::vec3 min;
+        glm::vec3 max;
+        Object* object;
+
+        int parent; // next free node while unused
+        int left;
+        int right;
+        int height; // leaf: 0, free: -1
+
+        bool IsLeaf() const;
+    };
+
+private:
+    std::vector<Node> m_nodes;
+    int m_root;
+    int m_freeList;
+    size_t m_leafCount;
+    size_t m_changeCount; // since the last rebuild
+
+    mutable std::vector<int> m_stack;
+
+private:
+    int AllocateNode();
+    void FreeNode(int node);
+
+    void InsertLeaf(int leaf);
+    void RemoveLeaf(int leaf);
+    int Balance(int node);
+    void RefitUpwards(int node);
+
+    int BuildRange(std::vector<int>& leaves, size_t begin, size_t end);
+
+    template <typename Overlaps>
+    void Query(const Overlaps& overlaps, std::vector<Object*>& result) const;
+
+public:
+    DynamicAABBTree(const DynamicAABBTree&) = delete;
+    DynamicAABBTree(DynamicAABBTree&&) noexcept = delete;
+    DynamicAABBTree& operator=(const DynamicAABBTree&) = delete;
+    DynamicAABBTree& operator=(DynamicAABBTree&&) noexcept = delete;
+
+public:
+    DynamicAABBTree();
+    ~DynamicAABBTree() = default;
+
+public:
+    // returns the proxy id of the new leaf
+    int Insert(const Bounds& bounds, Object* object);
+    void Remove(int proxy);
+    // true when the leaf left its fat box and was reinserted
+    bool Move(int proxy, const Bounds& bounds);
+
+    void Clear();
+    void Rebuild();
+
+    size_t GetLeafCount() const;
+    size_t GetChangeCount() const;
+    int GetHeight() const;
+
+    // objects whose boxes touch the volume are appended to result
+    void QueryFrustum(const Frustum& frustum, std::vector<Object*>& result) const;
+    void QuerySphere(const glm::vec3& center, float radius, std::vector<Object*>& result) const;
+    void QueryRay(const glm::vec3& origin, const glm::vec3& direction, float maxDistance,
+                  std::vector<Object*>& result) const;
+};
+
+#endif // DYNAMICAABBTREE_H
@@ -5,22 +5,91 @@
 #include "transform/transformable.h"
 #include "misc/collectionof.h"
 #include "object/object.h"
+#include "scene/dynamicaabbtree.h"
+#include "transform/transformhierarchy.h"
 
+#include <glm/glm.hpp>
 
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+
+// objects enter and leave the tree and the hierarchy one by one through
+// Add and Remove; moved ones are found by their transform version
 class Scene :
     public IProcess,
     public Transformable {
+private:
+    // where the tree last saw an object
+    struct Proxy {
+        Object* object;
+        int id;
+        uint64_t version; // of the local transform
+    };
+
+    struct HierarchyEntry {
+        std::weak_ptr<Object> owner; // expired once the object is gone
+        Object* object;              // null once removed
+    };
+
 private:
     CollectionOf<Object> m_objects;
 
+    TransformHierarchy m_hierarchy;
+    std::vector<HierarchyEntry> m_hierarchyObjects; // by node
+    size_t m_staleNodes; // removed, or appended out of breadth first order
+
+    DynamicAABBTree m_tree;
+    std::vector<Proxy> m_proxies; // dense, walked every frame
+    std::unordered_map<Object*, size_t> m_proxyIndices;
+    std::vector<Object*> m_unboundedObjects; // no known bounds, always processed
+    std::vector<size_t> m_movedProxies;      // ascending
+    std::vector<Object*> m_visibleObjects;
+
+    glm::mat4 m_syncedMatrix;
+    size_t m_syncedModelGeneration;
+
+private:
+    void SyncTree();
+
+    // objects and their children breadth first, drops the removed nodes
+    void RebuildHierarchy();
+    void ReleaseHierarchy();
+    // the object and its children, appended
+    void AddToHierarchy(const std::shared_ptr<Object>& object);
+    void RemoveFromHierarchy(Object& object);
+    void UpdateHierarchy();
+
+    void AddToTree(Object& object);
+    void RemoveFromTree(Object& object);
+    void AddProxy(Object& object, const Bounds& bounds);
+    // swaps the last proxy in
+    void RemoveProxy(size_t index);
+    // every object inserted again, when the whole scene moved
+    void RebuildTree();
+    // unbounded objects whose models finished loading
+    void InsertBounded();
+
+    void FindMoved();
+    void RefitMoved();
+    void ProcessObject(Object& object);
+
 public:
     Scene();
     virtual ~Scene();
 
 public:
-    CollectionOf<Object>& GetObjects();
+    // objects change only through Add and Remove, so the tree never keeps a destroyed one
+    void Add(const std::shared_ptr<Object>& object);
+    void Remove(const std::shared_ptr<Object>& object);
     const CollectionOf<Object>& GetObjects() const;
 
+    const DynamicAABBTree& GetTree() const;
+    const TransformHierarchy& GetHierarchy() const;
+
 public: /* IProcess */
     void Processing() override;
 };
@@ -2,29 +2,44 @@
 #define SHADER_H
 
 #include "interface/iprocess.h"
-#include "transform/parenttransformation.h"
+#include "uniformhandle.h"
 
 #include <glad/glad.h>
 #include <glm/glm.hpp>
 
-#include <functional>
 #include <filesystem>
+#include <map>
+#include <string>
+#include <unordered_map>
 #include <vector>
 
 
-class Shader final :
-    public IProcess,
-    public ParentTransformation {
+// name -> value, ordered so equal sets give equal storage keys
+using ShaderDefines = std::map<std::string, std::string>;
+
+
+class Shader final : public IProcess {
+public:
+    static const std::filesystem::path DEFAULT_VERTEX_PATH;
+    static const std::filesystem::path DEFAULT_FRAGMENT_PATH;
+
 private:
-    using UniformProcessing = std::function<void(Shader*)>;
-    using UniformProcessingVector = std::vector<UniformProcessing>;
+    using UniformTable = std::vector<UniformHandle>;
+    using UniformIndices = std::unordered_map<std::string, size_t>;
 
     static constexpr GLuint INFOLOG_SIZE { 512 };
     static constexpr GLint LOCATION_ERROR_FLAG { -1 };
 
 private:
     GLuint m_program;
-    UniformProcessingVector m_uniformProcessingFunctions;
+    ShaderDefines m_defines;
+
+    UniformTable m_uniforms;
+    UniformIndices m_uniformIndices;
+
+    UniformHandle m_modelUniform;
+    UniformHandle m_viewUniform;
+    UniformHandle m_projectionUniform;
 
 public:
     Shader();
@@ -37,6 +52,10 @@ public:
     Shader(const std::filesystem::path& vertexPath,
            const std::filesystem::path& fragmentPath);
 
+    Shader(const std::filesystem::path& vertexPath,
+           const std::filesystem::path& fragmentPath,
+           const ShaderDefines& defines);
+
 private:
     void CreateProgram(const std::filesystem::path& vertexPath,
                        const std::filesystem::path& fragmentPath);
@@ -45,13 +64,32 @@ private:
     void LinkShadersToProgram(GLuint* vertex, GLuint* fragment);
     void DeleteShaders(GLuint* vertex, GLuint* fragment);
 
+    void ReflectUniforms();
+    void AddUniform(const std::string& uniformName, GLint location, GLenum type);
+
 public:
     void Use() const;
 
-    UniformProcessingVector& UniformProcessingFunctions();
-    const UniformProcessingVector& UniformProcessingFunctions() const;
+    GLuint GetProgram() const;
+    const ShaderDefines& GetDefines() const;
+
+    UniformHandle GetUniform(const std::string& uniformName) const;
+    bool HasUniform(const std::string& uniformName) const;
+
+    void SetBool(const UniformHandle& uniform, bool value) const;
+    void SetInt(const UniformHandle& uniform, GLint value) const;
+    void SetUInt(const UniformHandle& uniform, GLuint value) const;
+    void SetFloat(const UniformHandle& uniform, GLfloat value) const;
+    void SetDouble(const UniformHandle& uniform, GLdouble value) const;
+
+    void SetVec1(const UniformHandle& uniform, const glm::vec1& value) const;
+    void SetVec2(const UniformHandle& uniform, const glm::vec2& value) const;
+    void SetVec3(const UniformHandle& uniform, const glm::vec3& value) const;
+    void SetVec4(const UniformHandle& uniform, const glm::vec4& value) const;
 
-    void CheckLocationError(GLint location, const std::string& uniformName) const;
+    void SetMat2(const UniformHandle& uniform, const glm::mat2& value) const;
+    void SetMat3(const UniformHandle& uniform, const glm::mat3& value) const;
+    void SetMat4(const UniformHandle& uniform, const glm::mat4& value) const;
 
     void SetBool(const std::string& uniformName, bool value) const;
     void SetInt(const std::string& uniformName, GLint value) const;
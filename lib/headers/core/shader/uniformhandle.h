@@ -0,0 +1,33 @@
+#ifndef UNIFORMHANDLE_H
+#define UNIFORMHANDLE_H
+
+#include <glad/glad.h>
+
+
+class UniformHandle final {
+private:
+    static constexpr GLint MISSING_LOCATION { -1 };
+
+private:
+    GLint m_location;
+    GLenum m_type;
+
+public:
+    UniformHandle();
+    ~UniformHandle() = default;
+    UniformHandle(const UniformHandle& other) = default;
+    UniformHandle(UniformHandle&& other) noexcept = default;
+    UniformHandle& operator=(const UniformHandle& other) = default;
+    UniformHandle& operator=(UniformHandle&& other) noexcept = default;
+
+    explicit UniformHandle(GLint location, GLenum type);
+
+public:
+    GLint GetLocation() const;
+    GLenum GetType() const;
+
+    bool IsValid() const;
+    bool IsMissing() const;
+};
+
+#endif // UNIFORMHANDLE_H
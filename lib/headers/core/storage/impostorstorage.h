@@ -0,0 +1,79 @@
+#ifndef IMPOSTORSTORAGE_H
+#define IMPOSTORSTORAGE_H
+
+#include "interface/icanbeeverywhere.h"
+#include "interface/iprocess.h"
+#include "render/impostor.h"
+#include "shader/shader.h"
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+
+class ModelData;
+
+// impostors by model data: baked on the main thread a few per frame,
+// then every impostor goes out as one instanced draw after the render queue;
+// their atlases count against the texture budget
+class ImpostorStorage final :
+    public ICanBeEverywhere,
+    public IProcess {
+public:
+    static constexpr size_t BAKES_PER_FRAME { 1 };
+    // the textures of a model stream in at the frame size for this long before its bake
+    static constexpr size_t BAKE_DELAY_FRAMES { 8 };
+    static constexpr GLuint INSTANCES_BINDING_POINT { 2 };
+
+private:
+    using KeyType = const ModelData*;
+
+    struct Entry {
+        std::shared_ptr<ModelData> modelData; // keeps the key alive
+        std::unique_ptr<Impostor> impostor;   // null until baked
+        size_t waitedFrames;
+        std::vector<glm::mat4> instances;     // of this frame
+    };
+
+private:
+    std::unordered_map<KeyType, Entry> m_impostors;
+    std::shared_ptr<Shader> m_shader;
+    GLuint m_vertexArray; // empty, the quad comes from gl_VertexID
+    size_t m_drawCallCount;
+
+public:
+    ImpostorStorage(const ImpostorStorage&) = delete;
+    ImpostorStorage(ImpostorStorage&&) noexcept = delete;
+    ImpostorStorage& operator=(const ImpostorStorage&) = delete;
+    ImpostorStorage& operator=(ImpostorStorage&&) noexcept = delete;
+
+public:
+    ImpostorStorage();
+    ~ImpostorStorage();
+
+private:
+    static void RequestTextures(const ModelData& modelData);
+
+    void Bake();
+    void Draw();
+
+public:
+    // collection phase, no GL calls; the first call for a ready model queues its bake,
+    // false until the impostor is baked, the model is drawn as usual meanwhile
+    bool Add(const std::shared_ptr<ModelData>& modelData, const glm::mat4& transform);
+
+    bool IsBaked(const ModelData& modelData) const;
+
+    size_t Size() const;
+    size_t GetDrawCallCount() const;
+
+public: /* IProcess */
+    // bakes, then draws the impostors added this frame
+    void Processing() override;
+};
+
+#endif // IMPOSTORSTORAGE_H
@@ -2,24 +2,60 @@
 #define LIGHTSTORAGE_H
 
 #include "interface/icanbeeverywhere.h"
+#include "interface/iprocess.h"
 #include "misc/collectionof.h"
 #include "light/directionallight.h"
 #include "light/pointlight.h"
 #include "light/spotlight.h"
 
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
 
 class LightStorage final :
-    public ICanBeEverywhere {
+    public ICanBeEverywhere,
+    public IProcess {
 public:
-    static const size_t MAX_DIRECTIONAL_LIGHTS;
-    static const size_t MAX_POINT_LIGHTS;
-    static const size_t MAX_SPOT_LIGHTS;
+    static constexpr size_t MAX_DIRECTIONAL_LIGHTS { 4 };
+    static constexpr size_t MAX_POINT_LIGHTS { 12 };
+    static constexpr size_t MAX_SPOT_LIGHTS { 6 };
+
+    static constexpr GLuint LIGHTS_BINDING_POINT { 0 };
+
+private: /* std140 layout of the "Lights" uniform block */
+    struct LightBlock {
+        GLuint counts[4]; // x: directional, y: point, z: spot
+
+        glm::vec4 directionalDirection[MAX_DIRECTIONAL_LIGHTS];
+        glm::vec4 directionalAmbient[MAX_DIRECTIONAL_LIGHTS];
+        glm::vec4 directionalDiffuse[MAX_DIRECTIONAL_LIGHTS];
+        glm::vec4 directionalSpecular[MAX_DIRECTIONAL_LIGHTS];
+
+        glm::vec4 pointPosition[MAX_POINT_LIGHTS];
+        glm::vec4 pointAmbient[MAX_POINT_LIGHTS];
+        glm::vec4 pointDiffuse[MAX_POINT_LIGHTS];
+        glm::vec4 pointSpecular[MAX_POINT_LIGHTS];
+        glm::vec4 pointAttenuation[MAX_POINT_LIGHTS]; // x: constant, y: linear, z: quadratic
+
+        glm::vec4 spotPosition[MAX_SPOT_LIGHTS];
+        glm::vec4 spotDirection[MAX_SPOT_LIGHTS];
+        glm::vec4 spotAmbient[MAX_SPOT_LIGHTS];
+        glm::vec4 spotDiffuse[MAX_SPOT_LIGHTS];
+        glm::vec4 spotSpecular[MAX_SPOT_LIGHTS];
+        glm::vec4 spotAttenuation[MAX_SPOT_LIGHTS]; // x: constant, y: linear, z: quadratic
+        glm::vec4 spotCutoff[MAX_SPOT_LIGHTS]; // x: cos(cutoff), y: cos(outer cutoff)
+    };
 
 private:
     CollectionOfPtr<DirectionalLight> m_directionalLights;
     CollectionOfPtr<PointLight> m_pointLights;
     CollectionOfPtr<SpotLight> m_spotLights;
 
+    LightBlock m_lightBlock;
+    GLuint m_ubo;
+    bool m_isDirty;
+    size_t m_maxActiveLights; // point and spot lights together
+
 public:
     LightStorage();
     virtual ~LightStorage();
@@ -30,6 +66,10 @@ public:
     LightStorage& operator=(const LightStorage&) = delete;
     LightStorage& operator=(LightStorage&&) noexcept = delete;
 
+private:
+    void PackLightBlock();
+    void UploadLightBlock();
+
 public:
     CollectionOfPtr<DirectionalLight>& GetDirectionalLights();
     const CollectionOfPtr<DirectionalLight>& GetDirectionalLights() const;
@@ -39,6 +79,16 @@ public:
 
     CollectionOfPtr<SpotLight>& GetSpotLights();
     const CollectionOfPtr<SpotLight>& GetSpotLights() const;
+
+    void MarkDirty();
+    bool IsDirty() const;
+
+    // point and spot lights past the limit are left out, directional ones always stay
+    void SetMaxActiveLights(size_t count);
+    size_t GetMaxActiveLights() const;
+
+public: /* IProcess */
+    void Processing() override;
 };
 
 #endif // LIGHTSTORAGE_H
@@ -3,6 +3,8 @@
 
 #include "object/modeldata.h"
 #include "interface/icanbeeverywhere.h"
+#include "interface/iprocess.h"
+#include "job/jobsystem.h"
 
 #include <unordered_map>
 #include <filesystem>
@@ -11,14 +13,31 @@
 #include <memory>
 
 
-class ModelStorage final : public ICanBeEverywhere {
+// models import on JobSystem workers and go to the GPU on the main thread
+// under a per-frame upload budget
+class ModelStorage final :
+    public ICanBeEverywhere,
+    public IProcess {
+public:
+    static constexpr size_t UPLOAD_BUDGET_BYTES { size_t { 32 } << 20 };
+
 private:
     using StoredType = ModelData;
     using KeyType = std::string;
     using ValueType = std::shared_ptr<StoredType>;
 
+    // generated LODs wait for their source and start from its meshes
+    struct SourceImport {
+        std::unique_ptr<JobCounter> counter; // kept until the storage is gone
+        std::weak_ptr<std::vector<ImportedMesh>> meshes;
+    };
+
 private:
     mutable std::unordered_map<KeyType, ValueType> m_models {};
+    mutable std::vector<ValueType> m_pendingModels {}; // not ready yet
+    mutable JobCounter m_imports {};
+    mutable std::unordered_map<KeyType, SourceImport> m_sourceImports {}; // by source path
+    size_t m_readyGeneration {};
 
 public:
     ModelStorage(const ModelStorage&) = delete;
@@ -31,16 +50,28 @@ public:
     ~ModelStorage();
 
 public:
-    bool HasModel(std::filesystem::path path) const;
+    bool HasModel(std::filesystem::path path, size_t lod = 0) const;
 
     void CreateModelData(std::filesystem::path path) const;
     void CreateModelData(std::filesystem::path path,
-                         std::filesystem::path textureDirectory) const;
+                         std::filesystem::path textureDirectory,
+                         size_t lod = 0) const;
 
     const ValueType Get(std::filesystem::path path) const;
 
     const ValueType Get(std::filesystem::path path,
                         std::filesystem::path textureDirectory) const;
+
+    // a LOD generated from the source, created on first use
+    const ValueType GetLod(std::filesystem::path path, size_t lod) const;
+
+    bool HasPendingModels() const;
+    // changes whenever a model became ready
+    size_t GetReadyGeneration() const;
+
+public: /* IProcess */
+    // uploads imported models, rethrows import errors
+    void Processing() override;
 };
 
 #endif // MODELSTORAGE_H
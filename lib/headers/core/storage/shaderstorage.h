@@ -0,0 +1,54 @@
+#ifndef SHADERSTORAGE_H
+#define SHADERSTORAGE_H
+
+#include "shader/shader.h"
+#include "interface/icanbeeverywhere.h"
+
+#include <unordered_map>
+#include <filesystem>
+#include <string>
+#include <memory>
+
+
+class ShaderStorage final : public ICanBeEverywhere {
+private:
+    using StoredType = Shader;
+    using KeyType = std::string;
+    using ValueType = std::shared_ptr<StoredType>;
+
+private:
+    mutable std::unordered_map<KeyType, ValueType> m_shaders {};
+
+public:
+    ShaderStorage(const ShaderStorage&) = delete;
+    ShaderStorage(ShaderStorage&&) noexcept = delete;
+    ShaderStorage& operator=(const ShaderStorage&) = delete;
+    ShaderStorage& operator=(ShaderStorage&&) noexcept = delete;
+
+public:
+    ShaderStorage();
+    ~ShaderStorage();
+
+private:
+    static KeyType MakeKey(const std::filesystem::path& vertexPath,
+                           const std::filesystem::path& fragmentPath,
+                           const ShaderDefines& defines);
+
+public:
+    bool HasShader(const std::filesystem::path& vertexPath,
+                   const std::filesystem::path& fragmentPath,
+                   const ShaderDefines& defines = {}) const;
+
+    const ValueType Get(const std::filesystem::path& vertexPath,
+                        const std::filesystem::path& fragmentPath) const;
+
+    const ValueType Get(const std::filesystem::path& vertexPath,
+                        const std::filesystem::path& fragmentPath,
+                        const ShaderDefines& defines) const;
+
+    const ValueType GetDefaultShader() const;
+
+    size_t Size() const;
+};
+
+#endif // SHADERSTORAGE_H
@@ -1,26 +1,82 @@
 #ifndef TEXTURESTORAGE_H
 #define TEXTURESTORAGE_H
 
+#include "texture/decodedimage.h"
 #include "texture/texture.h"
+#include "texture/texturearray.h"
 #include "texture/textureparams.h"
 #include "interface/icanbeeverywhere.h"
+#include "interface/iprocess.h"
+#include "interface/istreamable.h"
 
 #include <unordered_map>
+#include <cstddef>
+#include <cstdint>
 #include <initializer_list>
 #include <filesystem>
 #include <string>
 #include <memory>
+#include <vector>
 
 
-class TextureStorage final : public ICanBeEverywhere {
+struct TextureStreamingStats {
+    size_t budgetBytes {};
+    size_t residentBytes {};
+    size_t externalBytes {}; // part of the resident ones, see SetExternalBytes
+    size_t fullBytes {};    // everything at level 0
+    size_t streamedTextures {};
+    size_t pinnedTextures {}; // uncompressed, always fully resident
+    size_t uploadedLevels {}; // during the last frame
+    size_t evictedLevels {};
+};
+
+
+// textures and texture arrays; compiled ones keep only the mip levels
+// their on-screen size asks for, least recently used ones give levels
+// back while the budget is exceeded
+class TextureStorage final :
+    public ICanBeEverywhere,
+    public IProcess {
+public:
+    static constexpr size_t DEFAULT_BUDGET_BYTES { 256u << 20 };
+    static constexpr size_t MAX_LEVELS_PER_FRAME { 4 };
+
+    // arrays are bound to consecutive units starting at FIRST_ARRAY_UNIT
+    static constexpr size_t MAX_TEXTURE_ARRAYS { 16 };
+    static constexpr GLenum FIRST_ARRAY_UNIT { GL_TEXTURE16 };
+
 private:
     using StoredType = Texture;
     using KeyType = std::string;
     using ValueType = std::shared_ptr<StoredType>;
 
+    struct StreamState {
+        uint64_t lastUsedFrame {};
+        GLsizei wantedLevel {};
+        GLsizei targetLevel {}; // planned during Processing, applied once at its end
+    };
+
 private:
     mutable std::unordered_map<KeyType, ValueType> m_textures {};
 
+    std::vector<std::unique_ptr<TextureArray>> m_arrays {}; // one per image size
+    std::unordered_map<KeyType, TextureSlot> m_slots {};
+
+    std::unordered_map<IStreamable*, StreamState> m_streamStates {};
+    uint64_t m_frame {};
+    size_t m_budgetBytes {};
+    size_t m_externalBytes {};
+    GLsizei m_mipBias {}; // levels added to every request
+    TextureStreamingStats m_stats {};
+
+private:
+    StreamState& GetStreamState(IStreamable& texture);
+    std::vector<IStreamable*> GetStreamables() const;
+    size_t GetResidentBytes() const;
+
+    // the array of that size and format, created when missing
+    size_t GetArray(GLsizei width, GLsizei height, GLenum format);
+
 public:
     TextureStorage(const TextureStorage&) = delete;
     TextureStorage(TextureStorage&&) noexcept = delete;
@@ -43,6 +99,10 @@ public:
     ValueType Get(std::filesystem::path path, GLenum textureUnit);
     const ValueType Get(std::filesystem::path path, GLenum textureUnit) const;
 
+    // the image is only uploaded when its path isn't stored yet
+    ValueType Get(const DecodedImage& image, GLenum textureUnit);
+    bool HasTexture(std::filesystem::path path) const;
+
     ValueType GetDefaultTexture();
     const ValueType GetDefaultTexture() const;
 
@@ -50,6 +110,34 @@ public:
     const ValueType GetDefaultTexture(GLenum textureUnit) const;
 
     std::filesystem::path GetDefaultTexturePath() const;
+
+    // packs the image into the array of its size and format on first use,
+    // compiled images stay compressed
+    TextureSlot GetSlot(std::filesystem::path path);
+    // uncompressed, its mip levels are generated on the next BindArrays
+    TextureSlot GetSlot(const DecodedImage& image);
+    bool HasSlot(std::filesystem::path path) const;
+    size_t GetArrayCount() const;
+    void BindArrays() const;
+
+    // screen size is the largest extent in pixels the texture is drawn at this frame
+    void Request(IStreamable& texture, float screenSize);
+    void RequestSlot(TextureSlot slot, float screenSize);
+
+    void SetBudget(size_t bytes);
+    size_t GetBudget() const;
+
+    // resident GPU memory owned elsewhere, impostor atlases, counted against the budget
+    void SetExternalBytes(size_t bytes);
+    size_t GetExternalBytes() const;
+
+    // streams that many levels coarser than the screen size asks for
+    void SetMipBias(GLsizei levels);
+    GLsizei GetMipBias() const;
+    const TextureStreamingStats& GetStreamingStats() const;
+
+public: /* IProcess */
+    void Processing() override;
 };
 
 #endif // TEXTURESTORAGE_H
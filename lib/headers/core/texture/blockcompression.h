@@ -0,0 +1,22 @@
+#ifndef BLOCKCOMPRESSION_H
+#define BLOCKCOMPRESSION_H
+
+#include <cstddef>
+#include <cstdint>
+
+
+// encoders for 4x4 pixel blocks, pixels in rows from the top left
+namespace blockcompression {
+
+static constexpr size_t BLOCK_SIZE { 4 };
+static constexpr size_t BC4_BLOCK_BYTES { 8 };
+static constexpr size_t BC7_BLOCK_BYTES { 16 };
+
+// one channel, 16 values
+void EncodeBc4(const uint8_t* values, uint8_t* block);
+// RGBA, 16 pixels of 4 bytes; mode 6 only, one subset with 4 bit indices
+void EncodeBc7(const uint8_t* pixels, uint8_t* block);
+
+} // namespace blockcompression
+
+#endif // BLOCKCOMPRESSION_H
@@ -0,0 +1,66 @@
+#ifndef COMPRESSEDIMAGE_H
+#define COMPRESSEDIMAGE_H
+
+#include "misc/mappedfile.h"
+
+#include <glad/glad.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+
+// block compressed image with its whole mip chain, compiled next to the
+// source image as <source>.dds and mapped on load. Colour goes to BC7,
+// grey to BC4; rows are stored bottom up, like the flipped stb loads
+class CompressedImage final {
+public:
+    static constexpr uint32_t VERSION { 1 };
+
+    struct Level {
+        const uint8_t* data;
+        GLsizei size; // bytes
+        GLsizei width;
+        GLsizei height;
+    };
+
+private:
+    MappedFile m_file;
+
+    GLenum m_format;
+    GLsizei m_width;
+    GLsizei m_height;
+    std::vector<Level> m_levels;
+
+public:
+    CompressedImage() = delete;
+    CompressedImage(const CompressedImage&) = delete;
+    CompressedImage(CompressedImage&&) noexcept = delete;
+    CompressedImage& operator=(const CompressedImage&) = delete;
+    CompressedImage& operator=(CompressedImage&&) noexcept = delete;
+
+public:
+    explicit CompressedImage(const std::filesystem::path& sourcePath);
+    ~CompressedImage() = default;
+
+public:
+    static std::filesystem::path GetPath(const std::filesystem::path& sourcePath);
+    static bool IsUpToDate(const std::filesystem::path& sourcePath);
+    // false when the image can't be decoded or written
+    static bool Compile(const std::filesystem::path& sourcePath);
+
+    static GLsizei GetLevelBytes(GLenum format, GLsizei width, GLsizei height);
+
+    // single channel formats are read as grey
+    static void ApplySwizzle(GLuint texture, GLenum format);
+
+    GLenum GetFormat() const;
+    GLsizei GetWidth() const;
+    GLsizei GetHeight() const;
+
+    GLsizei GetLevelCount() const;
+    const Level& GetLevel(GLsizei level) const;
+};
+
+#endif // COMPRESSEDIMAGE_H
@@ -0,0 +1,44 @@
+#ifndef DECODEDIMAGE_H
+#define DECODEDIMAGE_H
+
+#include <glad/glad.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+
+// RGBA8 pixels of an image file, decoded on any thread; flips its rows
+// itself, the global stb flip flag is never touched
+class DecodedImage final {
+private:
+    std::filesystem::path m_path; // canonical
+    GLsizei m_width;
+    GLsizei m_height;
+    int m_channels; // of the file, before the expansion to RGBA
+    std::vector<uint8_t> m_pixels;
+
+public:
+    DecodedImage() = delete;
+    DecodedImage(const DecodedImage&) = delete;
+    DecodedImage(DecodedImage&&) noexcept = default;
+    DecodedImage& operator=(const DecodedImage&) = delete;
+    DecodedImage& operator=(DecodedImage&&) noexcept = default;
+
+public:
+    explicit DecodedImage(const std::filesystem::path& path, bool flipVertical);
+    ~DecodedImage() = default;
+
+public:
+    const std::filesystem::path& GetPath() const;
+
+    GLsizei GetWidth() const;
+    GLsizei GetHeight() const;
+    int GetChannels() const;
+
+    const uint8_t* GetPixels() const;
+    size_t GetBytes() const;
+};
+
+#endif // DECODEDIMAGE_H
@@ -2,6 +2,9 @@
 #define TEXTURE_H
 
 #include "interface/iprocess.h"
+#include "interface/istreamable.h"
+#include "texture/compressedimage.h"
+#include "texture/decodedimage.h"
 
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
@@ -10,6 +13,7 @@
 
 #include <cstddef>
 #include <filesystem>
+#include <memory>
 
 
 enum class TextureChannelComponents : int {
@@ -21,7 +25,11 @@ enum class TextureChannelComponents : int {
 };
 
 
-class Texture final : public IProcess {
+// immutable storage; compiled images keep their mapping and only hold
+// the levels from the resident one down
+class Texture final :
+    public IProcess,
+    public IStreamable {
 private:
     const TextureChannelComponents m_textureChannelComponents;
     GLenum m_textureUnit; // GL_TEXTURE0 - always activated by default
@@ -31,13 +39,21 @@ private:
     int m_height;
     int m_channels;
 
+    GLenum m_format;
+    GLsizei m_levels;
+    GLsizei m_residentLevel;
+    std::unique_ptr<CompressedImage> m_image;
+
     GLuint tex;
 
 private:
-    void InitTextureWrapParameters() const;
-    void InitTextureFilterParameter() const;
+    void InitTextureWrapParameters(GLuint texture) const;
+    void InitTextureFilterParameter(GLuint texture) const;
     void InitTexture(const std::filesystem::path& texturePath,
                      bool flipVertical);
+    void InitDecodedTexture(const DecodedImage& image);
+    // from the compiled <texture>.dds, starts at the coarsest resident level
+    void InitCompressedTexture(const std::filesystem::path& texturePath);
 
 public:
     Texture() = delete;
@@ -53,9 +69,10 @@ public:
     explicit Texture(const std::filesystem::path& texturePath, GLenum textureUnit);
     explicit Texture(const std::filesystem::path& texturePath,
                      GLenum textureUnit, bool flipVertical);
+    // from pixels decoded off the main thread, the image may be dropped afterwards
+    explicit Texture(const DecodedImage& image, GLenum textureUnit);
 
 private:
-    void Unbind() const;
     void UpdateSamplePosition();
 
 public:
@@ -66,6 +83,18 @@ public:
 
     GLenum NextTextureUnit() const;
 
+public: /* IStreamable */
+    bool IsStreamable() const override;
+
+    GLsizei GetWidth() const override;
+    GLsizei GetHeight() const override;
+    GLsizei GetLevelCount() const override;
+
+    GLsizei GetResidentLevel() const override;
+    void SetResidentLevel(GLsizei level) override;
+
+    size_t GetResidentBytes(GLsizei level) const override;
+
 public: /* IProcess */
     void Processing() override;
 };
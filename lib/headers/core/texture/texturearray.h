@@ -0,0 +1,86 @@
+#ifndef TEXTUREARRAY_H
+#define TEXTUREARRAY_H
+
+#include "interface/istreamable.h"
+#include "texture/compressedimage.h"
+#include "texture/decodedimage.h"
+
+#include <glad/glad.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <vector>
+
+
+// where a texture lives once it is packed into an array
+struct TextureSlot {
+    uint32_t array {};
+    uint32_t layer {};
+};
+
+
+// GL_TEXTURE_2D_ARRAY of images with one size and format,
+// grows by doubling its layers; compressed arrays stream their levels
+class TextureArray final : public IStreamable {
+private:
+    const GLsizei m_width;
+    const GLsizei m_height;
+    const GLenum m_format;
+    const GLsizei m_levels;
+    GLsizei m_residentLevel;
+
+    GLsizei m_layers;
+    GLsizei m_capacity;
+    std::vector<std::unique_ptr<CompressedImage>> m_images; // per layer, when compressed
+    bool m_mipmapsDirty; // uncompressed layers were added since the last UpdateMipmaps
+
+    GLuint tex;
+
+private:
+    bool IsCompressed() const;
+    // moves the layers into new storage
+    void Recreate(GLsizei capacity, GLsizei residentLevel);
+    void Reserve(GLsizei capacity);
+
+public:
+    TextureArray() = delete;
+    TextureArray(const TextureArray&) = delete;
+    TextureArray(TextureArray&&) = delete;
+    TextureArray& operator=(const TextureArray&) = delete;
+    TextureArray& operator=(TextureArray&&) = delete;
+
+public:
+    // compressed formats take compiled images only
+    explicit TextureArray(GLsizei width, GLsizei height, GLenum format = GL_RGBA8);
+    ~TextureArray();
+
+public:
+    GLenum GetFormat() const;
+    GLsizei GetLayerCount() const;
+
+    // returns the layer the image was written to
+    uint32_t AddLayer(const std::filesystem::path& texturePath, bool flipVertical);
+    // level 0 only, the levels below wait for UpdateMipmaps
+    uint32_t AddLayer(const DecodedImage& image);
+    uint32_t AddLayer(std::unique_ptr<CompressedImage> image);
+
+    // one glGenerateTextureMipmap for all layers added since the last call
+    void UpdateMipmaps();
+    void Bind(GLenum textureUnit) const;
+
+public: /* IStreamable */
+    bool IsStreamable() const override;
+
+    GLsizei GetWidth() const override;
+    GLsizei GetHeight() const override;
+    GLsizei GetLevelCount() const override;
+
+    GLsizei GetResidentLevel() const override;
+    void SetResidentLevel(GLsizei level) override;
+
+    size_t GetResidentBytes(GLsizei level) const override;
+};
+
+#endif // TEXTUREARRAY_H
@@ -7,6 +7,7 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/quaternion.hpp>
 
+#include <cstdint>
 #include <ostream>
 #include <string>
 
@@ -24,6 +25,14 @@ private:
     Axis m_axis;
     glm::quat m_axisOrientation;
 
+    // changes with every modification, equal versions mean equal values
+    uint64_t m_version;
+    mutable uint64_t m_matrixVersion;
+    mutable glm::mat4 m_matrix;
+
+private:
+    static uint64_t s_lastVersion;
+
 private:
     Transform(const glm::vec3& position,
               const glm::quat& orientation,
@@ -82,7 +91,10 @@ public:
     glm::quat GetAxisOrientation() const;
     void SetAxisOrientation(const glm::quat& axisOrientation);
 
+    uint64_t GetVersion() const;
+
 private:
+    void Touch();
     void UpdateAxisByAxisOrientation();
 
 public:
@@ -143,6 +155,7 @@ public: /* Additional position methods */
 };
 
 
+// parent + local, composed without going through a matrix
 Transform operator+(Transform lhs, const Transform& rhs);
 std::ostream& operator<<(std::ostream& out, const Transform& rhs);
 
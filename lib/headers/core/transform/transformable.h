@@ -4,10 +4,31 @@
 #include "localtransformation.h"
 #include "parenttransformation.h"
 
+#include <glm/glm.hpp>
+
+#include <cstdint>
+
+
+class TransformHierarchy;
 
 class Transformable :
     public ParentTransformation,
     public LocalTransformation {
+private:
+    // recomputed only when the parent or local version changed
+    mutable Transform m_globalTransform;
+    mutable uint64_t m_globalParentVersion;
+    mutable uint64_t m_globalLocalVersion;
+
+    mutable glm::mat4 m_globalMatrix;
+    mutable uint64_t m_matrixParentVersion;
+    mutable uint64_t m_matrixLocalVersion;
+
+    // world matrix source while the node is registered in a hierarchy
+    TransformHierarchy* m_hierarchy;
+    uint32_t m_hierarchyNode;
+    mutable uint64_t m_hierarchyVersion; // of the local transform it holds
+
 public:
     Transformable();
     Transformable(const Transformable& other);
@@ -21,8 +42,15 @@ public:
     explicit Transformable(const ParentTransformation& parent, const LocalTransformation& local);
 
 public:
-    virtual Transform GetGlobalTransform();
-    virtual const Transform GetGlobalTransform() const;
+    virtual const Transform& GetGlobalTransform() const;
+    const glm::mat4& GetGlobalMatrix() const;
+
+    void BindHierarchy(TransformHierarchy& hierarchy, uint32_t node);
+    void UnbindHierarchy();
+    bool IsInHierarchy() const;
+    uint32_t GetHierarchyNode() const;
+    // pushes the local transform into the hierarchy for its next update
+    void SyncHierarchy() const;
 
 public:
     friend void swap(Transformable&, Transformable&);
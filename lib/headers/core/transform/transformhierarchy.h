@@ -0,0 +1,78 @@
+#ifndef TRANSFORMHIERARCHY_H
+#define TRANSFORMHIERARCHY_H
+
+#include "transform.h"
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+
+// local TRS of a whole node tree in flat arrays, parents stored before
+// their children, so world matrices come out of one linear pass
+class TransformHierarchy final {
+public:
+    using NodeId = uint32_t;
+    using Range = std::pair<size_t, size_t>; // [first, second)
+
+    static constexpr NodeId NO_PARENT { std::numeric_limits<NodeId>::max() };
+
+private:
+    std::vector<float> m_positionX, m_positionY, m_positionZ;
+    std::vector<float> m_orientationX, m_orientationY, m_orientationZ, m_orientationW;
+    std::vector<float> m_scaleX, m_scaleY, m_scaleZ;
+
+    std::vector<NodeId> m_parents;
+    std::vector<uint8_t> m_dirty;
+
+    std::vector<glm::mat4> m_localMatrices;
+    std::vector<glm::mat4> m_worldMatrices;
+
+    // nodes of equal depth are contiguous when added breadth first
+    std::vector<uint32_t> m_depths;
+    std::vector<size_t> m_levelBegins;
+    bool m_breadthFirst;
+
+    glm::mat4 m_root; // parent of the top level nodes
+    bool m_rootDirty;
+
+public:
+    TransformHierarchy(const TransformHierarchy&) = delete;
+    TransformHierarchy(TransformHierarchy&&) noexcept = delete;
+    TransformHierarchy& operator=(const TransformHierarchy&) = delete;
+    TransformHierarchy& operator=(TransformHierarchy&&) noexcept = delete;
+
+public:
+    TransformHierarchy();
+    ~TransformHierarchy() = default;
+
+public:
+    // the parent has to be added already
+    NodeId Add(NodeId parent, const Transform& local);
+    void SetLocal(NodeId node, const Transform& local);
+    void SetRoot(const glm::mat4& root);
+    void Clear();
+
+    size_t GetSize() const;
+    bool IsDirty(NodeId node) const;
+    const glm::mat4& GetWorldMatrix(NodeId node) const;
+
+    // levels may be split across threads: UpdateLocal over any ranges,
+    // then UpdateWorld level after level
+    bool IsBreadthFirst() const;
+    size_t GetLevelCount() const;
+    Range GetLevel(size_t level) const;
+
+    void UpdateLocal(size_t begin, size_t end);
+    void UpdateWorld(size_t begin, size_t end);
+    void ClearDirty();
+
+    // single threaded, all of the above
+    void Update();
+};
+
+#endif // TRANSFORMHIERARCHY_H
@@ -311,3 +311,17 @@ FilesystemException::FilesystemException(const std::string& message) :
 
 FilesystemException::FilesystemException(const char* message) :
     FilesystemException { std::string { message } } {}
+
+
+TransformException::TransformException() :
+    ApplicationException {} {
+    m_message = "[TransformException] ";
+}
+
+TransformException::TransformException(const std::string& message) :
+    TransformException {} {
+    m_message += message;
+}
+
+TransformException::TransformException(const char* message) :
+    TransformException { std::string { message } } {}
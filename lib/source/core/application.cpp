@@ -19,6 +19,9 @@
 
 namespace {
 
+// texture materials sample from size-bucketed arrays and batch across materials
+static const bool USE_INDEXED_MATERIALS { true };
+
 /* Temp Methods */
 
 Space* CreateDemoSpace() {
@@ -32,14 +35,14 @@ Space* CreateDemoSpace() {
                 auto tempModel = std::make_shared<Model>(
                     R"obj(./resources/models/lodtest/lodtest.obj)obj");
                 tempModel->GetTransform().AddPosition({ i * 2, j * 2, k * 2 });
-                tempScene->GetObjects().Add(tempModel);
+                tempScene->Add(tempModel);
             }
         }
     }
 
     //auto tempModelLOD = std::make_shared<Model>(
     //    R"obj(./resources/models/lodtest/lodtest.obj)obj");
-    //tempScene->GetObjects().Add(tempModelLOD);
+    //tempScene->Add(tempModelLOD);
 
     auto tempDirectionalLight_01 = std::make_shared<DirectionalLight>();
     tempDirectionalLight_01->GetTransform().AddRotationYX({ -45.0f, -145.0f, 0.0f });
@@ -47,12 +50,12 @@ Space* CreateDemoSpace() {
     //auto tempDirectionalLight_02 = std::make_shared<DirectionalLight>();
     //tempDirectionalLight_02->GetTransform().AddRotationYX({ 0.0f, 180.0f, -45.0f });
 
-    tempScene->GetObjects().Add(tempDirectionalLight_01);
-    //tempScene->GetObjects().Add(tempDirectionalLight_02);
+    tempScene->Add(tempDirectionalLight_01);
+    //tempScene->Add(tempDirectionalLight_02);
 
     //auto tempSpotLight_01 = std::make_shared<SpotLight>(2.0f, 15.0f);
     //tempSpotLight_01->GetTransform().AddRotationXY(-45.0f, 45.0f);
-    //tempScene->GetObjects().Add(tempSpotLight_01);
+    //tempScene->Add(tempSpotLight_01);
 
     Space* tempSpace = new Space {};
     tempSpace->GetScenes().Add(tempScene);
@@ -87,13 +90,22 @@ Application::Application(const std::string& title) {
     try {
         // Objects are created in strict order
         Everywhere::Instance().Init<DeltaTime>(new DeltaTime {});
+        Everywhere::Instance().Init<JobSystem>(new JobSystem {});
         Everywhere::Instance().Init<MaterialStorage>(new MaterialStorage {});
-        Everywhere::Instance().Init<LightStorage>(new LightStorage {});
         Everywhere::Instance().Init<Projection>(new Perspective {});
         Everywhere::Instance().Init<Window>(new Window { ScreenSize { 960, 540 }, title });
         Everywhere::Instance().Init<Graphics>(new OpenGL {});
+        Everywhere::Instance().Init<ShaderStorage>(new ShaderStorage {});
+        Everywhere::Instance().Init<FrameRingBuffer>(new FrameRingBuffer {});
+        Everywhere::Instance().Init<GeometryPool>(new GeometryPool {});
+        Everywhere::Instance().Init<LightStorage>(new LightStorage {});
+        Everywhere::Instance().Init<RenderQueue>(new RenderQueue {});
+        Everywhere::Instance().Init<LodSelector>(new LodSelector {});
         Everywhere::Instance().Init<TextureStorage>(new TextureStorage {});
+        Everywhere::Instance().Init<MaterialTable>(new MaterialTable { ::USE_INDEXED_MATERIALS });
         Everywhere::Instance().Init<ModelStorage>(new ModelStorage {});
+        Everywhere::Instance().Init<ImpostorStorage>(new ImpostorStorage {});
+        Everywhere::Instance().Init<QualityGovernor>(new QualityGovernor {});
         Everywhere::Instance().Init<Input>(new Input {});
         Everywhere::Instance().Init<Camera>(new FreeCamera {});
         Everywhere::Instance().Init<Space>(CreateDemoSpace());
@@ -111,13 +123,22 @@ Application::~Application() {
     Everywhere::Instance().Free<Space>();
     Everywhere::Instance().Free<Camera>();
     Everywhere::Instance().Free<Input>();
+    Everywhere::Instance().Free<QualityGovernor>();
+    Everywhere::Instance().Free<ImpostorStorage>();
     Everywhere::Instance().Free<ModelStorage>();
+    Everywhere::Instance().Free<MaterialTable>();
     Everywhere::Instance().Free<TextureStorage>();
+    Everywhere::Instance().Free<LodSelector>();
+    Everywhere::Instance().Free<RenderQueue>();
+    Everywhere::Instance().Free<LightStorage>();
+    Everywhere::Instance().Free<GeometryPool>();
+    Everywhere::Instance().Free<FrameRingBuffer>();
+    Everywhere::Instance().Free<ShaderStorage>();
     Everywhere::Instance().Free<Graphics>();
     Everywhere::Instance().Free<Window>();
     Everywhere::Instance().Free<Projection>();
-    Everywhere::Instance().Free<LightStorage>();
     Everywhere::Instance().Free<MaterialStorage>();
+    Everywhere::Instance().Free<JobSystem>();
     Everywhere::Instance().Free<DeltaTime>();
 
     glfwTerminate();
@@ -126,12 +147,26 @@ Application::~Application() {
 void Application::MainLoop() {
     while (Everywhere::Instance().Get<Window>().CanProcess()) {
         Everywhere::Instance().Get<DeltaTime>().Update();
+        Everywhere::Instance().Get<QualityGovernor>().BeginFrame();
+        Everywhere::Instance().Get<JobSystem>().ProcessMainThreadJobs();
         Everywhere::Instance().Get<Graphics>().Processing();
         Everywhere::Instance().Get<Input>().Processing();
 
         DemoMainLoop();
 
+        // collect draws, then upload lights and submit
+        Everywhere::Instance().Get<ModelStorage>().Processing();
+        Everywhere::Instance().Get<RenderQueue>().BeginFrame();
+        Everywhere::Instance().Get<LodSelector>().Processing();
         Everywhere::Instance().Get<Space>().Processing();
+        Everywhere::Instance().Get<LightStorage>().Processing();
+        Everywhere::Instance().Get<RenderQueue>().Processing();
+        Everywhere::Instance().Get<ImpostorStorage>().Processing();
+        // mip levels asked for while drawing, in use from the next frame
+        Everywhere::Instance().Get<TextureStorage>().Processing();
+        Everywhere::Instance().Get<FrameRingBuffer>().Processing();
+        // holds the frame time for the next frames
+        Everywhere::Instance().Get<QualityGovernor>().Processing();
 
         Everywhere::Instance().Get<Window>().Processing();
     }
@@ -6,12 +6,13 @@ Everywhere::Everywhere() :
     m_units {} {}
 
 Everywhere::~Everywhere() {
-    for (auto& [key, value] : m_units) {
-        if (value) {
-            delete value;
-            value = nullptr;
-        }
-    }
+    // later units may use earlier ones while shutting down
+    while (!m_units.empty()) {
+        Unit& unit = m_units.back();
+
+        unit.clearSlot();
+        delete unit.unit;
 
-    m_units.clear();
+        m_units.pop_back();
+    }
 }
@@ -0,0 +1,200 @@
+#include "graphics/glstatecache.h"
+
+
+uint64_t GLStateCache::PairKey(GLenum first, GLuint second) {
+    return (static_cast<uint64_t>(first) << 32) | static_cast<uint64_t>(second);
+}
+
+bool GLStateCache::Update(GLuint& cached, GLuint value) {
+    if (cached == value) {
+        ++m_skippedCalls;
+        return false;
+    }
+
+    cached = value;
+    ++m_issuedCalls;
+    return true;
+}
+
+GLStateCache::GLStateCache() :
+    m_program { UNKNOWN_BINDING },
+    m_vertexArray { UNKNOWN_BINDING },
+    m_elementBuffer { UNKNOWN_BINDING },
+    m_activeTexture { UNKNOWN_ENUM },
+    m_textures {},
+    m_buffers {},
+    m_indexedBuffers {},
+    m_capabilities {},
+    m_depthFunc { UNKNOWN_ENUM },
+    m_cullFace { UNKNOWN_ENUM },
+    m_blendSource { UNKNOWN_ENUM },
+    m_blendDestination { UNKNOWN_ENUM },
+    m_depthMask { UNKNOWN_BINDING },
+    m_issuedCalls {},
+    m_skippedCalls {} {}
+
+void GLStateCache::UseProgram(GLuint program) {
+    if (Update(m_program, program)) {
+        glUseProgram(program);
+    }
+}
+
+void GLStateCache::BindVertexArray(GLuint vertexArray) {
+    if (Update(m_vertexArray, vertexArray)) {
+        glBindVertexArray(vertexArray);
+        m_elementBuffer = UNKNOWN_BINDING;
+    }
+}
+
+void GLStateCache::ActiveTexture(GLenum unit) {
+    if (Update(m_activeTexture, unit)) {
+        glActiveTexture(unit);
+    }
+}
+
+void GLStateCache::BindTexture(GLenum unit, GLenum target, GLuint texture) {
+    GLuint& cached = m_textures.emplace(PairKey(unit, target), UNKNOWN_BINDING).first->second;
+
+    if (cached == texture) {
+        ++m_skippedCalls;
+        return;
+    }
+
+    ActiveTexture(unit);
+    Update(cached, texture);
+    glBindTexture(target, texture);
+}
+
+void GLStateCache::BindBuffer(GLenum target, GLuint buffer) {
+    GLuint& cached = (target == GL_ELEMENT_ARRAY_BUFFER)
+        ? m_elementBuffer
+        : m_buffers.emplace(target, UNKNOWN_BINDING).first->second;
+
+    if (Update(cached, buffer)) {
+        glBindBuffer(target, buffer);
+    }
+}
+
+void GLStateCache::BindBufferBase(GLenum target, GLuint index, GLuint buffer) {
+    GLuint& cached = m_indexedBuffers.emplace(PairKey(target, index), UNKNOWN_BINDING).first->second;
+
+    if (Update(cached, buffer)) {
+        glBindBufferBase(target, index, buffer);
+        m_buffers[target] = buffer; // the generic binding moves too
+    }
+}
+
+void GLStateCache::BindBufferRange(GLenum target, GLuint index, GLuint buffer,
+                                   GLintptr offset, GLsizeiptr size) {
+    // a later BindBufferBase of the same buffer has to reach the driver
+    m_indexedBuffers[PairKey(target, index)] = UNKNOWN_BINDING;
+    m_buffers[target] = buffer;
+    ++m_issuedCalls;
+
+    glBindBufferRange(target, index, buffer, offset, size);
+}
+
+void GLStateCache::SetCapability(GLenum capability, bool enabled) {
+    auto found = m_capabilities.find(capability);
+
+    if (found != m_capabilities.end() && found->second == enabled) {
+        ++m_skippedCalls;
+        return;
+    }
+
+    m_capabilities[capability] = enabled;
+    ++m_issuedCalls;
+
+    if (enabled) {
+        glEnable(capability);
+    } else {
+        glDisable(capability);
+    }
+}
+
+void GLStateCache::DepthFunc(GLenum func) {
+    if (Update(m_depthFunc, func)) {
+        glDepthFunc(func);
+    }
+}
+
+void GLStateCache::DepthMask(bool enabled) {
+    const GLuint mask = enabled ? GL_TRUE : GL_FALSE;
+
+    if (Update(m_depthMask, mask)) {
+        glDepthMask(static_cast<GLboolean>(mask));
+    }
+}
+
+void GLStateCache::CullFace(GLenum mode) {
+    if (Update(m_cullFace, mode)) {
+        glCullFace(mode);
+    }
+}
+
+void GLStateCache::BlendFunc(GLenum source, GLenum destination) {
+    if (m_blendSource == source && m_blendDestination == destination) {
+        ++m_skippedCalls;
+        return;
+    }
+
+    m_blendSource = source;
+    m_blendDestination = destination;
+    ++m_issuedCalls;
+
+    glBlendFunc(source, destination);
+}
+
+void GLStateCache::ForgetTexture(GLuint texture) {
+    for (auto& binding : m_textures) {
+        if (binding.second == texture) binding.second = 0;
+    }
+}
+
+void GLStateCache::ForgetBuffer(GLuint buffer) {
+    if (m_elementBuffer == buffer) m_elementBuffer = 0;
+
+    for (auto& binding : m_buffers) {
+        if (binding.second == buffer) binding.second = 0;
+    }
+
+    for (auto& binding : m_indexedBuffers) {
+        if (binding.second == buffer) binding.second = 0;
+    }
+}
+
+void GLStateCache::ForgetVertexArray(GLuint vertexArray) {
+    if (m_vertexArray == vertexArray) {
+        m_vertexArray = 0;
+        m_elementBuffer = UNKNOWN_BINDING;
+    }
+}
+
+void GLStateCache::Invalidate() {
+    m_program = UNKNOWN_BINDING;
+    m_vertexArray = UNKNOWN_BINDING;
+    m_elementBuffer = UNKNOWN_BINDING;
+    m_activeTexture = UNKNOWN_ENUM;
+    m_textures.clear();
+    m_buffers.clear();
+    m_indexedBuffers.clear();
+    m_capabilities.clear();
+    m_depthFunc = UNKNOWN_ENUM;
+    m_cullFace = UNKNOWN_ENUM;
+    m_blendSource = UNKNOWN_ENUM;
+    m_blendDestination = UNKNOWN_ENUM;
+    m_depthMask = UNKNOWN_BINDING;
+}
+
+uint64_t GLStateCache::GetIssuedCallCount() const {
+    return m_issuedCalls;
+}
+
+uint64_t GLStateCache::GetSkippedCallCount() const {
+    return m_skippedCalls;
+}
+
+void GLStateCache::ResetCallCounters() {
+    m_issuedCalls = 0;
+    m_skippedCalls = 0;
+}
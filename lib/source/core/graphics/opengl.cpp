@@ -7,19 +7,24 @@
 #include "everywhere.h"
 
 
+GLStateCache* OpenGL::s_state { nullptr };
+
 void OpenGL::UpdateClearColor() {
     glClearColor(m_clearColor.Red(), m_clearColor.Green(),
                  m_clearColor.Blue(), m_clearColor.Alpha());
 }
 
 void OpenGL::InitOpenGL() {
-    glEnable(GL_MULTISAMPLE);
+    m_state.SetCapability(GL_MULTISAMPLE, m_antialiasing);
+
+    m_state.SetCapability(GL_DEPTH_TEST, true);
+    m_state.DepthFunc(GL_LESS);
+    m_state.DepthMask(true);
 
-    glEnable(GL_DEPTH_TEST);
-    glDepthFunc(GL_LESS);
+    m_state.SetCapability(GL_CULL_FACE, true);
+    m_state.CullFace(GL_BACK);
 
-    glEnable(GL_CULL_FACE);
-    glCullFace(GL_BACK);
+    m_state.SetCapability(GL_BLEND, false);
     glFrontFace(GL_CCW);
 
     glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
@@ -38,8 +43,37 @@ void OpenGL::Init() {
 
 OpenGL::OpenGL() :
     Graphics {},
-    m_clearColor { Color::BLACK } {
+    m_clearColor { Color::BLACK },
+    m_state {},
+    m_antialiasing { true } {
     Init();
+    s_state = &m_state;
+}
+
+OpenGL::~OpenGL() {
+    if (s_state == &m_state) {
+        s_state = nullptr;
+    }
+}
+
+GLStateCache& OpenGL::State() {
+    if (!s_state) {
+        throw OpenGLException { "There is no OpenGL state to use" };
+    }
+
+    return *s_state;
+}
+
+bool OpenGL::HasState() {
+    return s_state != nullptr;
+}
+
+GLStateCache& OpenGL::GetState() {
+    return m_state;
+}
+
+const GLStateCache& OpenGL::GetState() const {
+    return m_state;
 }
 
 void OpenGL::UpdateViewportSize() const {
@@ -51,6 +85,16 @@ void OpenGL::Flush() const {
     glFlush();
 }
 
+// the window keeps its samples, only the rasterization goes single sample
+void OpenGL::SetAntialiasing(bool enabled) {
+    m_antialiasing = enabled;
+    m_state.SetCapability(GL_MULTISAMPLE, enabled);
+}
+
+bool OpenGL::IsAntialiasing() const {
+    return m_antialiasing;
+}
+
 void OpenGL::Processing() {
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 }
@@ -17,6 +17,14 @@ void Vulkan::Flush() const {
     /* DUMMY */
 }
 
+void Vulkan::SetAntialiasing(bool) {
+    /* DUMMY */
+}
+
+bool Vulkan::IsAntialiasing() const {
+    return false;
+}
+
 void Vulkan::Processing() {
     /* DUMMY */
 }
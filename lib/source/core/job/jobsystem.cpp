@@ -0,0 +1,333 @@
+#include "job/jobsystem.h"
+
+#include <algorithm>
+#include <chrono>
+
+
+namespace {
+
+static const std::chrono::milliseconds IDLE_TIMEOUT { 1 };
+static constexpr size_t RANGES_PER_THREAD { 4 };
+
+thread_local uint32_t s_victimSeed { 2463534242u };
+
+size_t NextVictim(size_t count) {
+    // xorshift32
+    s_victimSeed ^= s_victimSeed << 13;
+    s_victimSeed ^= s_victimSeed >> 17;
+    s_victimSeed ^= s_victimSeed << 5;
+
+    return s_victimSeed % count;
+}
+
+} // namespace
+
+
+JobCounter::JobCounter() :
+    m_pending { 0 },
+    m_mutex {},
+    m_continuations {},
+    m_exception {} {}
+
+bool JobCounter::IsDone() const {
+    return m_pending.load(std::memory_order_acquire) == 0;
+}
+
+
+thread_local size_t JobSystem::s_workerIndex { JobSystem::NO_WORKER };
+
+JobSystem::JobSystem(size_t workerCount) :
+    m_deques {},
+    m_threads {},
+    m_injectedMutex {},
+    m_injectedJobs {},
+    m_mainThreadMutex {},
+    m_mainThreadJobs {},
+    m_wakeMutex {},
+    m_wake {},
+    m_queuedJobs { 0 },
+    m_stopping { false } {
+    if (!workerCount) {
+        const size_t hardwareThreads = std::thread::hardware_concurrency();
+        workerCount = hardwareThreads > 1 ? hardwareThreads - 1 : 1;
+    }
+
+    for (size_t i = 0; i < workerCount; ++i) {
+        m_deques.push_back(std::make_unique<WorkStealingDeque>(DEQUE_CAPACITY));
+    }
+
+    s_workerIndex = 0;
+
+    for (size_t i = 1; i <= workerCount; ++i) {
+        m_threads.emplace_back(&JobSystem::WorkerLoop, this, i);
+    }
+}
+
+JobSystem::~JobSystem() {
+    m_stopping.store(true, std::memory_order_release);
+
+    {
+        std::lock_guard<std::mutex> lock { m_wakeMutex };
+        m_wake.notify_all();
+    }
+
+    for (auto& thread : m_threads) {
+        thread.join();
+    }
+
+    // jobs nobody waited for
+    for (auto& deque : m_deques) {
+        while (Job* job = deque->Steal()) delete job;
+    }
+
+    for (Job* job : m_injectedJobs) delete job;
+    for (Job* job : m_mainThreadJobs) delete job;
+
+    s_workerIndex = NO_WORKER;
+}
+
+WorkStealingDeque* JobSystem::GetOwnDeque() const {
+    // workers are numbered from 1, the main thread is 0
+    if (s_workerIndex == NO_WORKER || IsMainThread()) return nullptr;
+
+    return m_deques[s_workerIndex - 1].get();
+}
+
+void JobSystem::WorkerLoop(size_t index) {
+    s_workerIndex = index;
+    s_victimSeed ^= static_cast<uint32_t>(index * 0x9E3779B9u);
+
+    while (!m_stopping.load(std::memory_order_acquire)) {
+        if (Job* job = FindJob()) {
+            Execute(job);
+            continue;
+        }
+
+        // the timeout covers a wake up racing the check
+        std::unique_lock<std::mutex> lock { m_wakeMutex };
+        m_wake.wait_for(lock, ::IDLE_TIMEOUT, [this]() {
+            return m_queuedJobs.load(std::memory_order_acquire) > 0 ||
+                   m_stopping.load(std::memory_order_acquire);
+        });
+    }
+}
+
+Job* JobSystem::FindJob() {
+    Job* job { nullptr };
+    WorkStealingDeque* ownDeque = GetOwnDeque();
+
+    if (ownDeque) {
+        job = ownDeque->Pop();
+    }
+
+    if (!job) {
+        std::lock_guard<std::mutex> lock { m_injectedMutex };
+
+        if (!m_injectedJobs.empty()) {
+            job = m_injectedJobs.front();
+            m_injectedJobs.pop_front();
+        }
+    }
+
+    if (!job) {
+        const size_t count = m_deques.size();
+        const size_t first = ::NextVictim(count);
+
+        for (size_t i = 0; i < count && !job; ++i) {
+            const size_t victim = (first + i) % count;
+            if (m_deques[victim].get() == ownDeque) continue;
+
+            job = m_deques[victim]->Steal();
+        }
+    }
+
+    if (job) {
+        m_queuedJobs.fetch_sub(1, std::memory_order_acq_rel);
+    }
+
+    return job;
+}
+
+Job* JobSystem::PopMainThreadJob() {
+    std::lock_guard<std::mutex> lock { m_mainThreadMutex };
+
+    if (m_mainThreadJobs.empty()) return nullptr;
+
+    Job* job = m_mainThreadJobs.front();
+    m_mainThreadJobs.pop_front();
+
+    return job;
+}
+
+Job* JobSystem::PopInjectedJob(const JobCounter& counter) {
+    std::lock_guard<std::mutex> lock { m_injectedMutex };
+
+    auto found = std::find_if(m_injectedJobs.begin(), m_injectedJobs.end(), [&counter](const Job* job) {
+        return job->counter == &counter && job->affinity == JobAffinity::ANY;
+    });
+
+    if (found == m_injectedJobs.end()) return nullptr;
+
+    Job* job = *found;
+    m_injectedJobs.erase(found);
+    m_queuedJobs.fetch_sub(1, std::memory_order_acq_rel);
+
+    return job;
+}
+
+void JobSystem::Schedule(Job* job) {
+    if (job->affinity == JobAffinity::MAIN_THREAD) {
+        std::lock_guard<std::mutex> lock { m_mainThreadMutex };
+        m_mainThreadJobs.push_back(job);
+        return;
+    }
+
+    m_queuedJobs.fetch_add(1, std::memory_order_acq_rel);
+
+    WorkStealingDeque* ownDeque = GetOwnDeque();
+
+    // the main thread and full deques inject, so nothing runs inline on the submitter
+    if (!ownDeque || !ownDeque->Push(job)) {
+        std::lock_guard<std::mutex> lock { m_injectedMutex };
+        m_injectedJobs.push_back(job);
+    }
+
+    m_wake.notify_one();
+}
+
+void JobSystem::Execute(Job* job) {
+    try {
+        job->task();
+    } catch (...) {
+        std::lock_guard<std::mutex> lock { job->counter->m_mutex };
+
+        if (!job->counter->m_exception) {
+            job->counter->m_exception = std::current_exception();
+        }
+    }
+
+    JobCounter& counter = *job->counter;
+    delete job;
+
+    Finish(counter);
+}
+
+void JobSystem::Finish(JobCounter& counter) {
+    std::vector<Job*> continuations {};
+
+    {
+        // under the lock, so RunAfter cannot miss the drop to zero
+        std::lock_guard<std::mutex> lock { counter.m_mutex };
+
+        if (counter.m_pending.fetch_sub(1, std::memory_order_acq_rel) != 1) return;
+
+        continuations.swap(counter.m_continuations);
+    }
+
+    for (Job* job : continuations) {
+        Schedule(job);
+    }
+}
+
+void JobSystem::Run(std::function<void()> task, JobCounter& counter, JobAffinity affinity) {
+    counter.m_pending.fetch_add(1, std::memory_order_acq_rel);
+    Schedule(new Job { std::move(task), &counter, affinity });
+}
+
+void JobSystem::RunAfter(JobCounter& dependency, std::function<void()> task,
+                         JobCounter& counter, JobAffinity affinity) {
+    counter.m_pending.fetch_add(1, std::memory_order_acq_rel);
+    Job* job = new Job { std::move(task), &counter, affinity };
+
+    {
+        std::lock_guard<std::mutex> lock { dependency.m_mutex };
+
+        if (!dependency.IsDone()) {
+            dependency.m_continuations.push_back(job);
+            return;
+        }
+    }
+
+    Schedule(job);
+}
+
+void JobSystem::Wait(JobCounter& counter) {
+    const bool isMainThread = IsMainThread();
+
+    while (!counter.IsDone()) {
+        Job* job { nullptr };
+
+        if (isMainThread) {
+            // anything else could be a whole model import in the middle of the frame
+            job = PopMainThreadJob();
+
+            if (!job) {
+                job = PopInjectedJob(counter);
+            }
+        } else {
+            job = FindJob();
+        }
+
+        if (job) {
+            Execute(job);
+        } else {
+            std::this_thread::yield();
+        }
+    }
+
+    std::exception_ptr exception {};
+
+    {
+        std::lock_guard<std::mutex> lock { counter.m_mutex };
+        std::swap(exception, counter.m_exception);
+    }
+
+    if (exception) {
+        std::rethrow_exception(exception);
+    }
+}
+
+void JobSystem::ParallelFor(size_t count, const std::function<void(size_t, size_t)>& body,
+                            size_t minGrain) {
+    if (!count) return;
+
+    const size_t grain = std::max({ minGrain, size_t { 1 },
+                                    count / (GetThreadCount() * ::RANGES_PER_THREAD) });
+
+    if (count <= grain) {
+        body(0, count);
+        return;
+    }
+
+    JobCounter counter {};
+
+    // lives until Wait returns, every split refers to it
+    std::function<void(size_t, size_t)> split {};
+    split = [&](size_t begin, size_t end) {
+        while (end - begin > grain) {
+            const size_t middle = begin + (end - begin) / 2;
+
+            Run([&split, middle, end]() { split(middle, end); }, counter);
+            end = middle;
+        }
+
+        body(begin, end);
+    };
+
+    Run([&split, count]() { split(0, count); }, counter);
+    Wait(counter);
+}
+
+void JobSystem::ProcessMainThreadJobs() {
+    while (Job* job = PopMainThreadJob()) {
+        Execute(job);
+    }
+}
+
+size_t JobSystem::GetThreadCount() const {
+    return m_deques.size() + 1;
+}
+
+bool JobSystem::IsMainThread() const {
+    return s_workerIndex == 0;
+}
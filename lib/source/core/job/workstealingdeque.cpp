@@ -0,0 +1,74 @@
+#include "job/workstealingdeque.h"
+
+
+WorkStealingDeque::WorkStealingDeque(size_t capacity) :
+    m_ring {},
+    m_mask {},
+    m_top { 0 },
+    m_bottom { 0 } {
+    size_t size { 1 };
+    while (size < capacity) size <<= 1;
+
+    m_ring = std::vector<std::atomic<Job*>>(size);
+    m_mask = static_cast<int64_t>(size - 1);
+}
+
+bool WorkStealingDeque::Push(Job* job) {
+    const int64_t bottom = m_bottom.load(std::memory_order_relaxed);
+    const int64_t top = m_top.load(std::memory_order_acquire);
+
+    if (bottom - top > m_mask) return false;
+
+    m_ring[bottom & m_mask].store(job, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    m_bottom.store(bottom + 1, std::memory_order_relaxed);
+
+    return true;
+}
+
+Job* WorkStealingDeque::Pop() {
+    const int64_t bottom = m_bottom.load(std::memory_order_relaxed) - 1;
+    m_bottom.store(bottom, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t top = m_top.load(std::memory_order_relaxed);
+
+    if (top > bottom) {
+        m_bottom.store(bottom + 1, std::memory_order_relaxed);
+        return nullptr;
+    }
+
+    Job* job = m_ring[bottom & m_mask].load(std::memory_order_relaxed);
+
+    // the last job, race the thieves for it
+    if (top == bottom) {
+        if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst,
+                                           std::memory_order_relaxed)) {
+            job = nullptr;
+        }
+
+        m_bottom.store(bottom + 1, std::memory_order_relaxed);
+    }
+
+    return job;
+}
+
+Job* WorkStealingDeque::Steal() {
+    int64_t top = m_top.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    const int64_t bottom = m_bottom.load(std::memory_order_acquire);
+
+    if (top >= bottom) return nullptr;
+
+    Job* job = m_ring[top & m_mask].load(std::memory_order_relaxed);
+
+    if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst,
+                                       std::memory_order_relaxed)) {
+        return nullptr;
+    }
+
+    return job;
+}
+
+bool WorkStealingDeque::IsEmpty() const {
+    return m_top.load(std::memory_order_acquire) >= m_bottom.load(std::memory_order_acquire);
+}
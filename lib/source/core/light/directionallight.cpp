@@ -158,10 +158,12 @@ DirectionalLight::DirectionalLight(const Color& color, float ambient,
     m_childMesh.reset(::CreateSphere(m_color));
 
     Everywhere::Instance().Get<LightStorage>().GetDirectionalLights().Add(this);
+    MarkDirty();
 }
 
 DirectionalLight::~DirectionalLight() {
     Everywhere::Instance().Get<LightStorage>().GetDirectionalLights().Delete(this);
+    MarkDirty();
 }
 
 float DirectionalLight::GetAmbient() const {
@@ -190,12 +192,15 @@ Color DirectionalLight::GetSpecularColor() const {
 
 void DirectionalLight::SetAmbient(float ambient) {
     m_ambient = ambient;
+    MarkDirty();
 }
 
 void DirectionalLight::SetDiffuse(float diffuse) {
     m_diffuse = diffuse;
+    MarkDirty();
 }
 
 void DirectionalLight::SetSpecular(float specular) {
     m_specular = specular;
+    MarkDirty();
 }
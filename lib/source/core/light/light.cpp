@@ -10,12 +10,20 @@ Light::Light() :
 Light::Light(const Color& color) :
     Object {},
     m_color { color },
-    m_childMesh {} {}
+    m_childMesh {},
+    m_lastGlobalMatrix { 0.0f } {}
 
 
 void Light::Processing() {
     Object::Processing();
 
+    // lights are repacked into the shared uniform block only when they move
+    const glm::mat4 globalMatrix = GetGlobalMatrix();
+    if (globalMatrix != m_lastGlobalMatrix) {
+        m_lastGlobalMatrix = globalMatrix;
+        MarkDirty();
+    }
+
     if (m_childMesh) {
         m_childMesh->SetParentTransform(GetGlobalTransform());
         m_childMesh->Processing();
@@ -28,6 +36,7 @@ Color Light::GetColor() const {
 
 void Light::SetColor(const Color& color) {
     m_color = color;
+    MarkDirty();
 
     if (m_childMesh) {
         const size_t ID = m_childMesh->GetMaterialId();
@@ -40,3 +49,7 @@ void Light::SetColor(const Color& color) {
         }
     }
 }
+
+void Light::MarkDirty() const {
+    Everywhere::Instance().Get<LightStorage>().MarkDirty();
+}
@@ -182,10 +182,12 @@ PointLight::PointLight(const Color& color, float radius,
     m_childMesh.reset(::CreateSphere(m_color));
 
     Everywhere::Instance().Get<LightStorage>().GetPointLights().Add(this);
+    MarkDirty();
 }
 
 PointLight::~PointLight() {
     Everywhere::Instance().Get<LightStorage>().GetPointLights().Delete(this);
+    MarkDirty();
 }
 
 float PointLight::GetRadius() const {
@@ -248,26 +250,32 @@ void PointLight::SetRadius(float radius) {
 
 void PointLight::SetAmbient(float ambient) {
     m_ambient = ambient;
+    MarkDirty();
 }
 
 void PointLight::SetDiffuse(float diffuse) {
     m_diffuse = diffuse;
+    MarkDirty();
 }
 
 void PointLight::SetSpecular(float specular) {
     m_specular = specular;
+    MarkDirty();
 }
 
 void PointLight::SetConstant(float constant) {
     m_constant = constant;
+    MarkDirty();
 }
 
 void PointLight::SetLinear(float linear) {
     m_linear = linear;
+    MarkDirty();
 }
 
 void PointLight::SetQuadratic(float quadratic) {
     m_quadratic = quadratic;
+    MarkDirty();
 }
 
 void PointLight::SetLinearInfluence(float linearInfluence) {
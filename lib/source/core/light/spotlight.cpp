@@ -191,10 +191,12 @@ SpotLight::SpotLight(const Color& color, float radius, float cutoffAsDegrees,
     m_childMesh.reset(::CreateSphere(m_color));
 
     Everywhere::Instance().Get<LightStorage>().GetSpotLights().Add(this);
+    MarkDirty();
 }
 
 SpotLight::~SpotLight() {
     Everywhere::Instance().Get<LightStorage>().GetSpotLights().Delete(this);
+    MarkDirty();
 }
 
 float SpotLight::GetRadius() const {
@@ -275,35 +277,43 @@ void SpotLight::SetRadius(float radius) {
 void SpotLight::SetCutoffDegrees(float cutoffAsDegrees) {
     m_cutoffAsRadians = glm::radians(cutoffAsDegrees);
     UpdateOuterCutoff();
+    MarkDirty();
 }
 
 void SpotLight::SetCutoffRadians(float cutoffAsRadians) {
     m_cutoffAsRadians = cutoffAsRadians;
     UpdateOuterCutoff();
+    MarkDirty();
 }
 
 void SpotLight::SetAmbient(float ambient) {
     m_ambient = ambient;
+    MarkDirty();
 }
 
 void SpotLight::SetDiffuse(float diffuse) {
     m_diffuse = diffuse;
+    MarkDirty();
 }
 
 void SpotLight::SetSpecular(float specular) {
     m_specular = specular;
+    MarkDirty();
 }
 
 void SpotLight::SetConstant(float constant) {
     m_constant = constant;
+    MarkDirty();
 }
 
 void SpotLight::SetLinear(float linear) {
     m_linear = linear;
+    MarkDirty();
 }
 
 void SpotLight::SetQuadratic(float quadratic) {
     m_quadratic = quadratic;
+    MarkDirty();
 }
 
 void SpotLight::SetLinearInfluence(float linearInfluence) {
@@ -0,0 +1,118 @@
+#include "material/indexedtexturematerial.h"
+
+#include "everywhere.h"
+
+#include <filesystem>
+#include <string>
+#include <utility>
+#include <vector>
+
+
+namespace {
+
+static const std::filesystem::path TEXTURE_VERTEX_PATH {
+    R"vert(./resources/shaders/texture-shader.vert)vert"
+};
+
+static const std::filesystem::path TEXTURE_FRAGMENT_PATH {
+    R"frag(./resources/shaders/texture-shader.frag)frag"
+};
+
+static const ShaderDefines INDEXED_TEXTURE_DEFINES {
+    { "INDEXED_TEXTURES", "1" },
+    { "MAX_TEXTURE_ARRAYS", std::to_string(TextureStorage::MAX_TEXTURE_ARRAYS) },
+};
+
+static constexpr float DEFAULT_SHININESS { 32.0f };
+
+} // namespace
+
+
+MaterialRecord IndexedTextureMaterial::MakeRecord() const {
+    TextureStorage& textureStorage = Everywhere::Instance().Get<TextureStorage>();
+
+    MaterialRecord record {};
+    record.diffuse = textureStorage.GetSlot(m_diffuse.GetPath());
+    record.specular = textureStorage.GetSlot(m_specular.GetPath());
+    record.emission = textureStorage.GetSlot(m_emission.GetPath());
+    record.shininess = m_shininess;
+
+    return record;
+}
+
+void IndexedTextureMaterial::DoInitShader() {
+    std::vector<std::pair<UniformHandle, GLint>> textureArrays {};
+
+    for (size_t i = 0; i < TextureStorage::MAX_TEXTURE_ARRAYS; ++i) {
+        const UniformHandle handle { m_shader->GetUniform("textureArrays[" + std::to_string(i) + "]") };
+        const GLint unit = static_cast<GLint>(TextureStorage::FIRST_ARRAY_UNIT - GL_TEXTURE0 + i);
+
+        textureArrays.emplace_back(handle, unit);
+    }
+
+    auto UniformTextureArraysFunc = [=](Shader* shader) {
+        for (const auto& [handle, unit] : textureArrays) {
+            shader->SetInt(handle, unit);
+        }
+    };
+
+    const UniformHandle cameraPositionUniform { m_shader->GetUniform("cameraPosition") };
+
+    auto UniformCameraFunc = [=](Shader* shader) {
+        glm::vec3 cameraPosition =
+            Everywhere::Instance().Get<Camera>().GetTransform().GetPosition();
+
+        shader->SetVec3(cameraPositionUniform, cameraPosition);
+    };
+
+    m_uniformProcessingFunctions.push_back(UniformTextureArraysFunc);
+    m_uniformProcessingFunctions.push_back(UniformCameraFunc);
+}
+
+
+IndexedTextureMaterial::IndexedTextureMaterial(const TextureParams& diffuse,
+                                               const TextureParams& specular,
+                                               const TextureParams& emission) :
+    IndexedTextureMaterial { diffuse, specular, emission, ::DEFAULT_SHININESS } {}
+
+IndexedTextureMaterial::IndexedTextureMaterial(const TextureParams& diffuse,
+                                               const TextureParams& specular,
+                                               const TextureParams& emission,
+                                               float shininess) :
+    TextureMaterial {
+        Everywhere::Instance().Get<ShaderStorage>().Get(
+            ::TEXTURE_VERTEX_PATH, ::TEXTURE_FRAGMENT_PATH, ::INDEXED_TEXTURE_DEFINES),
+        diffuse, specular, emission, shininess
+    },
+    m_tableIndex {},
+    m_record { MakeRecord() } {
+    m_tableIndex = Everywhere::Instance().Get<MaterialTable>().Add(m_record);
+}
+
+const void* IndexedTextureMaterial::GetBatchKey() const {
+    return m_shader.get();
+}
+
+uint32_t IndexedTextureMaterial::GetTableIndex() const {
+    return m_tableIndex;
+}
+
+void IndexedTextureMaterial::RequestTextureResidency(float screenSize) const {
+    TextureStorage& textureStorage = Everywhere::Instance().Get<TextureStorage>();
+
+    textureStorage.RequestSlot(m_record.diffuse, screenSize);
+    textureStorage.RequestSlot(m_record.specular, screenSize);
+    textureStorage.RequestSlot(m_record.emission, screenSize);
+}
+
+void IndexedTextureMaterial::OnParamsChanged() {
+    m_record = MakeRecord();
+    Everywhere::Instance().Get<MaterialTable>().Set(m_tableIndex, m_record);
+}
+
+void IndexedTextureMaterial::Processing() {
+    Material::Processing();
+
+    Everywhere::Instance().Get<TextureStorage>().BindArrays();
+    Everywhere::Instance().Get<MaterialTable>().Bind();
+}
@@ -1,5 +1,7 @@
 #include "material/lightmaterial.h"
 
+#include "everywhere.h"
+
 
 namespace {
 
@@ -15,13 +17,15 @@ static const std::filesystem::path LIGHT_FRAGMENT_PATH {
 
 
 void LightMaterial::DoInitShader() {
-    auto UniformCameraFunc = [this](Shader* shader) {
+    const UniformHandle colorUniform { m_shader->GetUniform("color") };
+
+    auto UniformCameraFunc = [=](Shader* shader) {
         if (this == nullptr) return;
 
-        shader->SetVec4("color", static_cast<glm::vec4>(GetColor()));
+        shader->SetVec4(colorUniform, static_cast<glm::vec4>(GetColor()));
     };
 
-    m_shader->UniformProcessingFunctions().push_back(UniformCameraFunc);
+    m_uniformProcessingFunctions.push_back(UniformCameraFunc);
 }
 
 LightMaterial::LightMaterial() :
@@ -29,8 +33,8 @@ LightMaterial::LightMaterial() :
 
 
 LightMaterial::LightMaterial(const Color& color) :
-    Material { std::shared_ptr<Shader> {
-            new Shader { LIGHT_VERTEX_PATH, LIGHT_FRAGMENT_PATH } } },
+    Material { Everywhere::Instance().Get<ShaderStorage>().Get(
+        ::LIGHT_VERTEX_PATH, ::LIGHT_FRAGMENT_PATH) },
     m_color { color } {}
 
 Color LightMaterial::GetColor() const {
@@ -1,13 +1,15 @@
 #include "material/material.h"
 
+#include "everywhere.h"
+
 
 Material::Material() :
-    Material { std::shared_ptr<Shader> { new Shader {} } } {}
+    Material { Everywhere::Instance().Get<ShaderStorage>().GetDefaultShader() } {}
 
 
 Material::Material(const std::shared_ptr<Shader>& shader) :
-    ParentTransformation {},
-    m_shader { shader } {}
+    m_shader { shader },
+    m_uniformProcessingFunctions {} {}
 
 std::shared_ptr<Shader> Material::GetShader() {
     return m_shader;
@@ -19,13 +21,39 @@ const std::shared_ptr<Shader> Material::GetShader() const {
 
 void Material::SetShader(const std::shared_ptr<Shader>& shader) {
     m_shader = shader;
+
+    // handles were resolved against the previous program
+    m_uniformProcessingFunctions.clear();
+}
+
+Material::UniformProcessingVector& Material::UniformProcessingFunctions() {
+    return m_uniformProcessingFunctions;
+}
+
+const Material::UniformProcessingVector& Material::UniformProcessingFunctions() const {
+    return m_uniformProcessingFunctions;
+}
+
+const void* Material::GetBatchKey() const {
+    return this;
+}
+
+uint32_t Material::GetTableIndex() const {
+    return 0;
+}
+
+void Material::RequestTextureResidency(float) const {
+    /* DUMMY */
 }
 
 void Material::Processing() {
-    if (m_shader->UniformProcessingFunctions().empty()) {
+    if (m_uniformProcessingFunctions.empty()) {
         DoInitShader();
     }
 
-    m_shader->SetParentTransform(this->GetParentTransform());
     m_shader->Processing();
+
+    for (auto& uniformProcessingFunction : m_uniformProcessingFunctions) {
+        uniformProcessingFunction(m_shader.get());
+    }
 }
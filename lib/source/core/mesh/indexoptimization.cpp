@@ -0,0 +1,242 @@
+#include "mesh/indexoptimization.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+
+namespace {
+
+static constexpr size_t FORSYTH_CACHE_SIZE { 32 };
+static constexpr float CACHE_DECAY_POWER { 1.5f };
+static constexpr float LAST_TRIANGLE_SCORE { 0.75f };
+static constexpr float VALENCE_BOOST_SCALE { 2.0f };
+static constexpr float VALENCE_BOOST_POWER { 0.5f };
+
+static constexpr uint32_t NO_VERTEX { std::numeric_limits<uint32_t>::max() };
+static constexpr size_t NO_TRIANGLE { std::numeric_limits<size_t>::max() };
+
+float VertexScore(int32_t cachePosition, uint32_t liveTriangles) {
+    // nothing left to draw with it
+    if (!liveTriangles) return -1.0f;
+
+    float score { 0.0f };
+
+    if (cachePosition >= 0) {
+        if (cachePosition < 3) {
+            // used by the last triangle, a fixed score keeps strips from winning
+            score = ::LAST_TRIANGLE_SCORE;
+        } else {
+            const float scale = 1.0f / static_cast<float>(::FORSYTH_CACHE_SIZE - 3);
+            score = std::pow(1.0f - static_cast<float>(cachePosition - 3) * scale,
+                             ::CACHE_DECAY_POWER);
+        }
+    }
+
+    // few triangles left: finish the vertex before it leaves the cache
+    return score + ::VALENCE_BOOST_SCALE *
+                   std::pow(static_cast<float>(liveTriangles), -::VALENCE_BOOST_POWER);
+}
+
+} // namespace
+
+
+namespace indexoptimization {
+
+float VertexCacheStats::GetAcmr() const {
+    return triangles ? static_cast<float>(transforms) / static_cast<float>(triangles) : 0.0f;
+}
+
+float VertexCacheStats::GetAtvr() const {
+    return vertices ? static_cast<float>(transforms) / static_cast<float>(vertices) : 0.0f;
+}
+
+VertexCacheStats& VertexCacheStats::operator+=(const VertexCacheStats& other) {
+    triangles += other.triangles;
+    vertices += other.vertices;
+    transforms += other.transforms;
+
+    return *this;
+}
+
+OptimizationStats& OptimizationStats::operator+=(const OptimizationStats& other) {
+    before += other.before;
+    after += other.after;
+
+    return *this;
+}
+
+VertexCacheStats AnalyzeVertexCache(const std::vector<GLuint>& indices, size_t vertexCount,
+                                    size_t cacheSize) {
+    VertexCacheStats stats {};
+    stats.triangles = indices.size() / 3;
+
+    // time a vertex entered the FIFO, it is cached while fewer misses followed
+    std::vector<size_t> enteredAt(vertexCount, 0);
+    std::vector<uint8_t> isReferenced(vertexCount, 0);
+
+    for (GLuint index : indices) {
+        if (!isReferenced[index]) {
+            isReferenced[index] = 1;
+            ++stats.vertices;
+        }
+
+        if (!enteredAt[index] || stats.transforms - enteredAt[index] + 1 > cacheSize) {
+            ++stats.transforms;
+            enteredAt[index] = stats.transforms;
+        }
+    }
+
+    return stats;
+}
+
+void OptimizeVertexCache(std::vector<GLuint>& indices, size_t vertexCount) {
+    const size_t triangleCount = indices.size() / 3;
+    if (!triangleCount) return;
+
+    // live triangles of every vertex, emitted ones are swapped out of the range
+    std::vector<uint32_t> liveTriangles(vertexCount, 0);
+    for (GLuint index : indices) {
+        ++liveTriangles[index];
+    }
+
+    std::vector<size_t> adjacencyBegin(vertexCount + 1, 0);
+    for (size_t vertex = 0; vertex < vertexCount; ++vertex) {
+        adjacencyBegin[vertex + 1] = adjacencyBegin[vertex] + liveTriangles[vertex];
+    }
+
+    std::vector<size_t> adjacency(indices.size());
+    {
+        std::vector<size_t> filled(adjacencyBegin.begin(), adjacencyBegin.end() - 1);
+
+        for (size_t triangle = 0; triangle < triangleCount; ++triangle) {
+            for (size_t corner = 0; corner < 3; ++corner) {
+                adjacency[filled[indices[triangle * 3 + corner]]++] = triangle;
+            }
+        }
+    }
+
+    std::vector<int32_t> cachePosition(vertexCount, -1);
+    std::vector<float> vertexScore(vertexCount);
+    for (size_t vertex = 0; vertex < vertexCount; ++vertex) {
+        vertexScore[vertex] = ::VertexScore(-1, liveTriangles[vertex]);
+    }
+
+    auto triangleScore = [&](size_t triangle) {
+        return vertexScore[indices[triangle * 3]] +
+               vertexScore[indices[triangle * 3 + 1]] +
+               vertexScore[indices[triangle * 3 + 2]];
+    };
+
+    std::vector<uint8_t> isEmitted(triangleCount, 0);
+    std::vector<GLuint> result {};
+    result.reserve(indices.size());
+
+    std::vector<uint32_t> cache {};
+    std::vector<uint32_t> nextCache {};
+    cache.reserve(::FORSYTH_CACHE_SIZE + 3);
+    nextCache.reserve(::FORSYTH_CACHE_SIZE + 3);
+
+    size_t bestTriangle { 0 };
+    for (size_t triangle = 1; triangle < triangleCount; ++triangle) {
+        if (triangleScore(triangle) > triangleScore(bestTriangle)) bestTriangle = triangle;
+    }
+
+    size_t firstUnemitted { 0 };
+
+    while (result.size() < indices.size()) {
+        if (bestTriangle == ::NO_TRIANGLE) {
+            // the cache ran dry, continue with the next triangle in the input
+            while (isEmitted[firstUnemitted]) ++firstUnemitted;
+            bestTriangle = firstUnemitted;
+        }
+
+        isEmitted[bestTriangle] = 1;
+        nextCache.clear();
+
+        for (size_t corner = 0; corner < 3; ++corner) {
+            const uint32_t vertex = indices[bestTriangle * 3 + corner];
+            result.push_back(vertex);
+            nextCache.push_back(vertex);
+
+            const size_t begin = adjacencyBegin[vertex];
+            const size_t end = begin + liveTriangles[vertex];
+            std::swap(*std::find(adjacency.begin() + static_cast<std::ptrdiff_t>(begin),
+                                 adjacency.begin() + static_cast<std::ptrdiff_t>(end), bestTriangle),
+                      adjacency[end - 1]);
+            --liveTriangles[vertex];
+        }
+
+        for (uint32_t vertex : cache) {
+            if (vertex != nextCache[0] && vertex != nextCache[1] && vertex != nextCache[2]) {
+                nextCache.push_back(vertex);
+            }
+        }
+
+        // the ones pushed out lose their cache score
+        for (size_t i = ::FORSYTH_CACHE_SIZE; i < nextCache.size(); ++i) {
+            cachePosition[nextCache[i]] = -1;
+            vertexScore[nextCache[i]] = ::VertexScore(-1, liveTriangles[nextCache[i]]);
+        }
+
+        nextCache.resize(std::min(nextCache.size(), ::FORSYTH_CACHE_SIZE));
+
+        for (size_t i = 0; i < nextCache.size(); ++i) {
+            cachePosition[nextCache[i]] = static_cast<int32_t>(i);
+            vertexScore[nextCache[i]] = ::VertexScore(static_cast<int32_t>(i),
+                                                      liveTriangles[nextCache[i]]);
+        }
+
+        // only triangles around the cache changed, the best one is among them
+        bestTriangle = ::NO_TRIANGLE;
+        float bestScore { -std::numeric_limits<float>::max() };
+
+        for (uint32_t vertex : nextCache) {
+            const size_t begin = adjacencyBegin[vertex];
+
+            for (size_t j = begin; j < begin + liveTriangles[vertex]; ++j) {
+                const size_t triangle = adjacency[j];
+                const float score = triangleScore(triangle);
+
+                if (score > bestScore) {
+                    bestScore = score;
+                    bestTriangle = triangle;
+                }
+            }
+        }
+
+        cache.swap(nextCache);
+    }
+
+    indices.swap(result);
+}
+
+void OptimizeVertexFetch(std::vector<Vertex>& vertices, std::vector<GLuint>& indices) {
+    std::vector<uint32_t> remap(vertices.size(), ::NO_VERTEX);
+    std::vector<Vertex> result {};
+    result.reserve(vertices.size());
+
+    for (GLuint& index : indices) {
+        if (remap[index] == ::NO_VERTEX) {
+            remap[index] = static_cast<uint32_t>(result.size());
+            result.push_back(vertices[index]);
+        }
+
+        index = remap[index];
+    }
+
+    vertices.swap(result);
+}
+
+OptimizationStats Optimize(std::vector<Vertex>& vertices, std::vector<GLuint>& indices) {
+    OptimizationStats stats {};
+    stats.before = AnalyzeVertexCache(indices, vertices.size());
+
+    OptimizeVertexCache(indices, vertices.size());
+    OptimizeVertexFetch(vertices, indices);
+
+    stats.after = AnalyzeVertexCache(indices, vertices.size());
+    return stats;
+}
+
+} // namespace indexoptimization
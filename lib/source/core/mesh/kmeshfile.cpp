@@ -0,0 +1,327 @@
+#include "mesh/kmeshfile.h"
+
+#include "app_exceptions.h"
+#include "render/geometrypool.h"
+#include "misc/fs.h"
+#include "misc/sourcestamp.h"
+
+#include <cstring>
+#include <fstream>
+#include <string>
+
+
+namespace {
+
+namespace fs = std::filesystem;
+
+static const std::string EXTENSION { ".kmesh" };
+static const char MAGIC[4] { 'K', 'M', 'S', 'H' };
+static constexpr uint64_t BLOB_ALIGNMENT { 16 };
+
+static_assert(sizeof(Vertex) == 8 * sizeof(float), "full format blobs are copied as is");
+
+
+// everything is stored in the byte order of the compiling machine
+struct FileHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t vertexSize;
+    uint32_t meshCount;
+    float error; // generated LODs only
+
+    SourceStamp source;
+
+    uint64_t stringsOffset;
+    uint64_t stringsSize;
+};
+
+struct StringRef {
+    uint32_t offset; // inside the string table
+    uint32_t length;
+};
+
+// the header is followed by one record per mesh, the string table
+// and the vertex and index blobs
+struct MeshRecord {
+    uint64_t vertexOffset;
+    uint64_t vertexCount;
+    uint32_t vertexFormat; // VertexFormat key
+    uint32_t vertexStride;
+    uint64_t indexOffset;
+    uint64_t indexCount;
+    uint32_t indexType; // GL_UNSIGNED_SHORT or GL_UNSIGNED_INT
+    uint32_t indexSize;
+
+    float min[3];
+    float max[3];
+
+    uint32_t textured;
+    StringRef diffuse;
+    StringRef specular;
+    StringRef emission;
+};
+
+
+uint64_t Align(uint64_t offset) {
+    return (offset + BLOB_ALIGNMENT - 1) & ~(BLOB_ALIGNMENT - 1);
+}
+
+bool IsSupportedHeader(const FileHeader& header) {
+    return !std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) &&
+           header.version == KMeshFile::VERSION &&
+           header.vertexSize == sizeof(Vertex);
+}
+
+// texture paths are kept relative to the source, so the tree may move
+std::string ToStoredPath(const fs::path& path, const fs::path& directory) {
+    if (path.empty()) return {};
+
+    const fs::path relative = path.lexically_relative(directory);
+    return (relative.empty() ? path : relative).generic_string();
+}
+
+fs::path FromStoredPath(const std::string& stored, const fs::path& directory) {
+    if (stored.empty()) return {};
+
+    const fs::path path { stored };
+    return path.is_absolute() ? path : (directory / path).lexically_normal();
+}
+
+StringRef AddString(std::string& strings, const std::string& value) {
+    StringRef result { static_cast<uint32_t>(strings.size()),
+                       static_cast<uint32_t>(value.size()) };
+    strings += value;
+
+    return result;
+}
+
+bool IsInside(uint64_t offset, uint64_t size, uint64_t fileSize) {
+    return offset <= fileSize && size <= fileSize - offset;
+}
+
+} // namespace
+
+
+KMeshFile::KMeshFile(const std::filesystem::path& sourcePath, size_t lod) :
+    m_file { GetPath(sourcePath, lod) },
+    m_meshes {},
+    m_error {} {
+    const uint8_t* data = m_file.GetData();
+    const uint64_t fileSize = m_file.GetSize();
+    const fs::path directory = fs::canonical(sourcePath).parent_path();
+
+    FileHeader header {};
+
+    if (fileSize < sizeof(header)) {
+        throw ModelDataException { "File \"" + GetPath(sourcePath, lod).string() + "\" is truncated." };
+    }
+
+    std::memcpy(&header, data, sizeof(header));
+
+    if (!::IsSupportedHeader(header) ||
+        !::IsInside(sizeof(header), uint64_t { header.meshCount } * sizeof(::MeshRecord), fileSize) ||
+        !::IsInside(header.stringsOffset, header.stringsSize, fileSize)) {
+        throw ModelDataException { "File \"" + GetPath(sourcePath, lod).string() + "\" is damaged." };
+    }
+
+    m_error = header.error;
+
+    const char* strings = reinterpret_cast<const char*>(data + header.stringsOffset);
+
+    auto readString = [&](const ::StringRef& ref) {
+        if (!::IsInside(ref.offset, ref.length, header.stringsSize)) {
+            throw ModelDataException { "File \"" + GetPath(sourcePath, lod).string() + "\" is damaged." };
+        }
+
+        return ::FromStoredPath(std::string { strings + ref.offset, ref.length }, directory);
+    };
+
+    m_meshes.reserve(header.meshCount);
+
+    for (size_t i = 0; i < header.meshCount; ++i) {
+        ::MeshRecord record {};
+        std::memcpy(&record, data + sizeof(header) + i * sizeof(record), sizeof(record));
+
+        VertexFormat format {};
+
+        if (!VertexFormat::FromKey(record.vertexFormat, format) ||
+            record.vertexStride != static_cast<uint32_t>(format.GetStride()) ||
+            (record.indexType != GL_UNSIGNED_SHORT && record.indexType != GL_UNSIGNED_INT) ||
+            record.indexSize != GeometryPool::GetIndexSize(record.indexType) ||
+            !::IsInside(record.vertexOffset, record.vertexCount * record.vertexStride, fileSize) ||
+            !::IsInside(record.indexOffset, record.indexCount * record.indexSize, fileSize)) {
+            throw ModelDataException { "File \"" + GetPath(sourcePath, lod).string() + "\" is damaged." };
+        }
+
+        MeshView mesh {
+            data + record.vertexOffset,
+            static_cast<size_t>(record.vertexCount),
+            format,
+            data + record.indexOffset,
+            static_cast<GLenum>(record.indexType),
+            static_cast<size_t>(record.indexCount),
+            Bounds { glm::vec3 { record.min[0], record.min[1], record.min[2] },
+                     glm::vec3 { record.max[0], record.max[1], record.max[2] } },
+            ImportedMaterial { record.textured != 0,
+                               readString(record.diffuse),
+                               readString(record.specular),
+                               readString(record.emission),
+                               nullptr, nullptr, nullptr }
+        };
+
+        m_meshes.push_back(std::move(mesh));
+    }
+}
+
+std::filesystem::path KMeshFile::GetPath(const std::filesystem::path& sourcePath, size_t lod) {
+    fs::path path { sourcePath };
+
+    if (lod) {
+        path += ".lod" + std::to_string(lod);
+    }
+
+    path += ::EXTENSION;
+
+    return path;
+}
+
+bool KMeshFile::IsUpToDate(const std::filesystem::path& sourcePath, size_t lod) {
+    const fs::path path = GetPath(sourcePath, lod);
+
+    FileHeader header {};
+
+    {
+        std::ifstream file { path, std::ios::in | std::ios::binary };
+        if (!file.read(reinterpret_cast<char*>(&header), sizeof(header))) return false;
+    }
+
+    if (!::IsSupportedHeader(header)) return false;
+
+    const int64_t storedTime = header.source.time;
+    if (!header.source.Matches(sourcePath)) return false;
+
+    if (header.source.time != storedTime) {
+        std::fstream file { path, std::ios::in | std::ios::out | std::ios::binary };
+        file.seekp(offsetof(FileHeader, source));
+        file.write(reinterpret_cast<const char*>(&header.source), sizeof(header.source));
+    }
+
+    return true;
+}
+
+bool KMeshFile::Write(const std::filesystem::path& sourcePath,
+                      const std::vector<ImportedMesh>& meshes,
+                      size_t lod, float error) {
+    const fs::path directory = fs::canonical(sourcePath).parent_path();
+
+    FileHeader header {};
+    std::memcpy(header.magic, ::MAGIC, sizeof(::MAGIC));
+    header.version = VERSION;
+    header.vertexSize = sizeof(Vertex);
+    header.meshCount = static_cast<uint32_t>(meshes.size());
+    header.error = error;
+    header.source = SourceStamp::Of(sourcePath);
+
+    std::vector<::MeshRecord> records(meshes.size());
+    std::vector<std::vector<uint8_t>> vertices(meshes.size());
+    std::vector<std::vector<GLushort>> shortIndices(meshes.size());
+    std::string strings {};
+
+    for (size_t i = 0; i < meshes.size(); ++i) {
+        const ImportedMesh& mesh = meshes[i];
+        ::MeshRecord& record = records[i];
+
+        const Bounds bounds = Bounds::FromVertices(mesh.vertices);
+        for (int axis = 0; axis < 3; ++axis) {
+            record.min[axis] = bounds.min[axis];
+            record.max[axis] = bounds.max[axis];
+        }
+
+        record.vertexCount = mesh.vertices.size();
+        record.vertexFormat = mesh.format.GetKey();
+        record.vertexStride = static_cast<uint32_t>(mesh.format.GetStride());
+        record.indexCount = mesh.indices.size();
+        record.indexType = GeometryPool::ChooseIndexType(mesh.vertices.size());
+        record.indexSize = static_cast<uint32_t>(GeometryPool::GetIndexSize(record.indexType));
+
+        if (record.indexType == GL_UNSIGNED_SHORT) {
+            shortIndices[i].assign(mesh.indices.begin(), mesh.indices.end());
+        }
+
+        vertices[i].resize(record.vertexCount * record.vertexStride);
+        mesh.format.Encode(mesh.vertices.data(), mesh.vertices.size(), bounds, vertices[i].data());
+
+        record.textured = mesh.material.textured;
+        record.diffuse = ::AddString(strings, ::ToStoredPath(mesh.material.diffuse, directory));
+        record.specular = ::AddString(strings, ::ToStoredPath(mesh.material.specular, directory));
+        record.emission = ::AddString(strings, ::ToStoredPath(mesh.material.emission, directory));
+    }
+
+    header.stringsOffset = sizeof(header) + records.size() * sizeof(::MeshRecord);
+    header.stringsSize = strings.size();
+
+    uint64_t offset = header.stringsOffset + header.stringsSize;
+
+    for (::MeshRecord& record : records) {
+        record.vertexOffset = ::Align(offset);
+        record.indexOffset = ::Align(record.vertexOffset + record.vertexCount * record.vertexStride);
+        offset = record.indexOffset + record.indexCount * record.indexSize;
+    }
+
+    return filesystem::ReplaceContentFile(GetPath(sourcePath, lod), [&](std::ostream& file) {
+        const char padding[::BLOB_ALIGNMENT] {};
+        uint64_t written { 0 };
+
+        auto write = [&](uint64_t at, const void* bytes, uint64_t size) {
+            file.write(padding, static_cast<std::streamsize>(at - written));
+            file.write(static_cast<const char*>(bytes), static_cast<std::streamsize>(size));
+            written = at + size;
+        };
+
+        write(0, &header, sizeof(header));
+        write(written, records.data(), records.size() * sizeof(::MeshRecord));
+        write(written, strings.data(), strings.size());
+
+        for (size_t i = 0; i < meshes.size(); ++i) {
+            write(records[i].vertexOffset, vertices[i].data(), vertices[i].size());
+            const void* indices = records[i].indexType == GL_UNSIGNED_SHORT
+                ? static_cast<const void*>(shortIndices[i].data())
+                : static_cast<const void*>(meshes[i].indices.data());
+
+            write(records[i].indexOffset, indices, records[i].indexCount * records[i].indexSize);
+        }
+    });
+}
+
+bool KMeshFile::Compile(const std::filesystem::path& sourcePath,
+                        const std::filesystem::path& textureDirectory,
+                        indexoptimization::OptimizationStats* stats) {
+    std::vector<ImportedMesh> meshes {};
+
+    ModelDataImporter importer { sourcePath, textureDirectory, meshes };
+    importer.Import();
+
+    if (stats) {
+        for (const ImportedMesh& mesh : meshes) {
+            *stats += mesh.optimization;
+        }
+    }
+
+    return Write(sourcePath, meshes);
+}
+
+size_t KMeshFile::GetMeshCount() const {
+    return m_meshes.size();
+}
+
+KMeshFile::MeshView& KMeshFile::GetMesh(size_t meshId) {
+    return m_meshes[meshId];
+}
+
+const KMeshFile::MeshView& KMeshFile::GetMesh(size_t meshId) const {
+    return m_meshes[meshId];
+}
+
+float KMeshFile::GetError() const {
+    return m_error;
+}
@@ -2,26 +2,22 @@
 
 #include "everywhere.h"
 
+#include <cstdint>
 #include <utility>
 
 
-namespace {
-
-static const GLsizei BUFFER_SIZE { 1 };
-
-} // namespace
-
 void swap(Mesh& lhs, Mesh& rhs) {
     if (&lhs == &rhs) return;
 
     using std::swap;
 
     swap(static_cast<Object>(lhs), static_cast<Object>(rhs));
-    swap(lhs.vao, rhs.vao);
-    swap(lhs.vbo, rhs.vbo);
-    swap(lhs.ebo, rhs.ebo);
+    swap(lhs.m_geometry, rhs.m_geometry);
     swap(lhs.m_verices, rhs.m_verices);
     swap(lhs.m_indices, rhs.m_indices);
+    swap(lhs.m_bounds, rhs.m_bounds);
+    swap(lhs.m_format, rhs.m_format);
+    swap(lhs.m_dequantization, rhs.m_dequantization);
     swap(lhs.m_materialId, rhs.m_materialId);
     swap(lhs.m_drawingMode, rhs.m_drawingMode);
 }
@@ -33,24 +29,50 @@ Mesh::~Mesh() {
 
 Mesh::Mesh(const std::vector<Vertex>& verices, const std::vector<GLuint>& indices) :
     Object {},
-    vao {}, vbo {}, ebo {},
+    m_geometry {},
     m_verices { verices },
     m_indices { indices },
+    m_bounds { Bounds::FromVertices(m_verices) },
+    m_format { VertexFormat::Choose(m_verices.data(), m_verices.size(), false) },
+    m_dequantization { 1.0f },
     m_materialId {},
     m_drawingMode { MeshDrawingMode::TRIANGLES } {
     Init();
 }
 
 Mesh::Mesh(std::vector<Vertex>&& verices, std::vector<GLuint>&& indices) noexcept :
+    Mesh { std::move(verices), std::move(indices),
+           VertexFormat::Choose(verices.data(), verices.size(), false) } {}
+
+Mesh::Mesh(std::vector<Vertex>&& verices, std::vector<GLuint>&& indices,
+           const VertexFormat& format) noexcept :
     Object {},
-    vao {}, vbo {}, ebo {},
+    m_geometry {},
     m_verices { std::move(verices) },
     m_indices { std::move(indices) },
+    m_bounds { Bounds::FromVertices(m_verices) },
+    m_format { format },
+    m_dequantization { 1.0f },
     m_materialId {},
     m_drawingMode { MeshDrawingMode::TRIANGLES } {
     Init();
 }
 
+Mesh::Mesh(const void* verices, size_t vertexCount, const VertexFormat& format,
+           const void* indices, GLenum indexType, size_t indexCount, const Bounds& bounds) :
+    Object {},
+    m_geometry {},
+    m_verices {},
+    m_indices {},
+    m_bounds { bounds },
+    m_format { format },
+    m_dequantization { format.GetDequantization(bounds) },
+    m_materialId {},
+    m_drawingMode { MeshDrawingMode::TRIANGLES } {
+    m_geometry = Everywhere::Instance().Get<GeometryPool>().Allocate(verices, vertexCount, m_format,
+                                                                      indices, indexType, indexCount);
+}
+
 size_t Mesh::GetMaterialId() const {
     return m_materialId;
 }
@@ -72,65 +94,54 @@ void Mesh::SetDrawingMode(GLenum drawingMode) {
 }
 
 void Mesh::Init() {
-    glGenVertexArrays(::BUFFER_SIZE, &vao);
-    glGenBuffers(::BUFFER_SIZE, &vbo);
-    glGenBuffers(::BUFFER_SIZE, &ebo);
+    m_dequantization = m_format.GetDequantization(m_bounds);
 
-    glBindVertexArray(vao);
+    std::vector<uint8_t> encoded(m_verices.size() * static_cast<size_t>(m_format.GetStride()));
+    m_format.Encode(m_verices.data(), m_verices.size(), m_bounds, encoded.data());
 
-    glBindBuffer(GL_ARRAY_BUFFER, vbo);
-    glBufferData(GL_ARRAY_BUFFER,
-                 m_verices.size() * sizeof(Vertex),
-                 &m_verices[0], GL_STATIC_DRAW);
-
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER,
-                 m_indices.size() * sizeof(GLuint),
-                 &m_indices[0], GL_STATIC_DRAW);
+    m_geometry = Everywhere::Instance().Get<GeometryPool>().Allocate(
+        encoded.data(), m_verices.size(), m_format, m_indices.data(), m_indices.size());
+}
 
-    glVertexAttribPointer(static_cast<GLuint>(AttribIndex::POSITION),
-                          3, GL_FLOAT, GL_FALSE, sizeof(Vertex),
-                          reinterpret_cast<void*>(0));
+void Mesh::Free() {
+    Everywhere::Instance().Get<GeometryPool>().Release(m_geometry);
 
-    glVertexAttribPointer(static_cast<GLuint>(AttribIndex::NORMAL),
-                          3, GL_FLOAT, GL_FALSE, sizeof(Vertex),
-                          reinterpret_cast<void*>(offsetof(Vertex, normal)));
+    m_verices.clear();
+    m_indices.clear();
+}
 
-    glVertexAttribPointer(static_cast<GLuint>(AttribIndex::TEXTURE),
-                          2, GL_FLOAT, GL_FALSE, sizeof(Vertex),
-                          reinterpret_cast<void*>(offsetof(Vertex, texture)));
+const GeometryRange& Mesh::GetGeometry() const {
+    return m_geometry;
+}
 
-    glBindVertexArray(0);
+const Bounds& Mesh::GetBounds() const {
+    return m_bounds;
 }
 
-void Mesh::Free() {
-    glDeleteVertexArrays(::BUFFER_SIZE, &vao);
-    glDeleteBuffers(::BUFFER_SIZE, &vbo);
-    glDeleteBuffers(::BUFFER_SIZE, &ebo);
+const VertexFormat& Mesh::GetVertexFormat() const {
+    return m_format;
+}
 
-    m_verices.clear();
-    m_indices.clear();
+const glm::mat4& Mesh::GetDequantization() const {
+    return m_dequantization;
 }
 
-void Mesh::Processing() {
-    auto material =
-        Everywhere::Instance().Get<MaterialStorage>().GetMaterials().At(m_materialId);
-    material->SetParentTransform(GetGlobalTransform());
-    material->Processing();
+GLsizei Mesh::GetIndexCount() const {
+    return m_geometry.indexCount;
+}
 
-    glBindVertexArray(vao);
+Bounds Mesh::GetLocalBounds() const {
+    if (m_children.IsEmpty()) return m_bounds;
 
-    glEnableVertexAttribArray(static_cast<GLuint>(AttribIndex::POSITION));
-    glEnableVertexAttribArray(static_cast<GLuint>(AttribIndex::NORMAL));
-    glEnableVertexAttribArray(static_cast<GLuint>(AttribIndex::TEXTURE));
+    Bounds bounds = Object::GetLocalBounds();
+    if (bounds.IsEmpty()) return bounds;
 
-    glDrawElements(static_cast<GLenum>(m_drawingMode),
-                   static_cast<GLsizei>(m_indices.size()),
-                   GL_UNSIGNED_INT, reinterpret_cast<void*>(0));
+    bounds.Merge(m_bounds);
+    return bounds;
+}
 
-    glDisableVertexAttribArray(static_cast<GLuint>(AttribIndex::TEXTURE));
-    glDisableVertexAttribArray(static_cast<GLuint>(AttribIndex::NORMAL));
-    glDisableVertexAttribArray(static_cast<GLuint>(AttribIndex::POSITION));
+void Mesh::Processing() {
+    Everywhere::Instance().Get<RenderQueue>().Add(*this, GetGlobalMatrix());
 
     Object::Processing(); // update children
 }
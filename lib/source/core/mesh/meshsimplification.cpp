@@ -0,0 +1,291 @@
+#include "mesh/meshsimplification.h"
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <numeric>
+#include <tuple>
+
+
+namespace {
+
+// sum of squared distances to the planes of the triangles around a vertex,
+// weighted by their area
+struct Quadric {
+    double a00 {}, a11 {}, a22 {}, a01 {}, a02 {}, a12 {};
+    double b0 {}, b1 {}, b2 {};
+    double c {};
+    double weight {};
+
+    Quadric& operator+=(const Quadric& other) {
+        a00 += other.a00; a11 += other.a11; a22 += other.a22;
+        a01 += other.a01; a02 += other.a02; a12 += other.a12;
+        b0 += other.b0; b1 += other.b1; b2 += other.b2;
+        c += other.c;
+        weight += other.weight;
+
+        return *this;
+    }
+};
+
+struct Collapse {
+    GLuint from;
+    GLuint to;
+    double error;
+};
+
+
+Quadric PlaneQuadric(const glm::vec3& normal, float distance, float weight) {
+    const double x { normal.x }, y { normal.y }, z { normal.z }, d { distance }, w { weight };
+
+    Quadric quadric {};
+    quadric.a00 = w * x * x; quadric.a11 = w * y * y; quadric.a22 = w * z * z;
+    quadric.a01 = w * x * y; quadric.a02 = w * x * z; quadric.a12 = w * y * z;
+    quadric.b0 = w * x * d; quadric.b1 = w * y * d; quadric.b2 = w * z * d;
+    quadric.c = w * d * d;
+    quadric.weight = w;
+
+    return quadric;
+}
+
+// mean squared distance of the point to the planes
+double Error(const Quadric& quadric, const glm::vec3& point) {
+    if (quadric.weight <= 0.0) return 0.0;
+
+    const double x { point.x }, y { point.y }, z { point.z };
+
+    const double error = quadric.a00 * x * x + quadric.a11 * y * y + quadric.a22 * z * z +
+                         2.0 * (quadric.a01 * x * y + quadric.a02 * x * z + quadric.a12 * y * z) +
+                         2.0 * (quadric.b0 * x + quadric.b1 * y + quadric.b2 * z) +
+                         quadric.c;
+
+    return std::max(error / quadric.weight, 0.0);
+}
+
+// the first vertex with the same position, for every vertex
+std::vector<GLuint> WeldPositions(const std::vector<Vertex>& vertices) {
+    std::vector<GLuint> order(vertices.size());
+    std::iota(order.begin(), order.end(), GLuint { 0 });
+
+    auto key = [&](GLuint vertex) {
+        const glm::vec3& position = vertices[vertex].position;
+        return std::make_tuple(position.x, position.y, position.z, vertex);
+    };
+
+    std::sort(order.begin(), order.end(), [&](GLuint a, GLuint b) {
+        return key(a) < key(b);
+    });
+
+    std::vector<GLuint> welded(vertices.size());
+
+    for (size_t i = 0; i < order.size(); ++i) {
+        const bool isSame = i && vertices[order[i]].position == vertices[order[i - 1]].position;
+        welded[order[i]] = isSame ? welded[order[i - 1]] : order[i];
+    }
+
+    return welded;
+}
+
+// seams and edges used by other than two triangles pin their vertices
+std::vector<uint8_t> FindLockedVertices(const std::vector<GLuint>& indices,
+                                        const std::vector<GLuint>& welded) {
+    std::vector<uint8_t> isLocked(welded.size(), 0);
+
+    for (size_t vertex = 0; vertex < welded.size(); ++vertex) {
+        if (welded[vertex] != vertex) {
+            isLocked[vertex] = 1;
+            isLocked[welded[vertex]] = 1;
+        }
+    }
+
+    std::vector<uint64_t> edges {};
+    edges.reserve(indices.size());
+
+    for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+        for (size_t corner = 0; corner < 3; ++corner) {
+            const uint64_t a = welded[indices[i + corner]];
+            const uint64_t b = welded[indices[i + (corner + 1) % 3]];
+            edges.push_back(std::min(a, b) << 32 | std::max(a, b));
+        }
+    }
+
+    std::sort(edges.begin(), edges.end());
+
+    for (size_t begin = 0; begin < edges.size();) {
+        size_t end = begin;
+        while (end < edges.size() && edges[end] == edges[begin]) ++end;
+
+        if (end - begin != 2) {
+            isLocked[static_cast<GLuint>(edges[begin] >> 32)] = 1;
+            isLocked[static_cast<GLuint>(edges[begin] & 0xffffffffu)] = 1;
+        }
+
+        begin = end;
+    }
+
+    // locks are made on the welded vertex, every vertex of the position follows
+    for (size_t vertex = 0; vertex < welded.size(); ++vertex) {
+        isLocked[vertex] = isLocked[welded[vertex]];
+    }
+
+    return isLocked;
+}
+
+std::vector<Quadric> ComputeQuadrics(const std::vector<Vertex>& vertices,
+                                     const std::vector<GLuint>& indices) {
+    std::vector<Quadric> quadrics(vertices.size());
+
+    for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+        const glm::vec3& p0 = vertices[indices[i]].position;
+        const glm::vec3& p1 = vertices[indices[i + 1]].position;
+        const glm::vec3& p2 = vertices[indices[i + 2]].position;
+
+        glm::vec3 normal = glm::cross(p1 - p0, p2 - p0);
+        const float doubleArea = glm::length(normal);
+        if (doubleArea <= 0.0f) continue;
+
+        normal /= doubleArea;
+
+        const Quadric quadric = ::PlaneQuadric(normal, -glm::dot(normal, p0), doubleArea * 0.5f);
+
+        for (size_t corner = 0; corner < 3; ++corner) {
+            quadrics[indices[i + corner]] += quadric;
+        }
+    }
+
+    return quadrics;
+}
+
+bool IsDegenerate(const GLuint* triangle) {
+    return triangle[0] == triangle[1] || triangle[1] == triangle[2] || triangle[0] == triangle[2];
+}
+
+} // namespace
+
+
+namespace meshsimplification {
+
+float Simplify(const std::vector<Vertex>& vertices, std::vector<GLuint>& indices,
+               size_t targetIndexCount, float targetError) {
+    if (indices.size() % 3 || indices.size() <= targetIndexCount) return 0.0f;
+
+    const std::vector<GLuint> welded = ::WeldPositions(vertices);
+    const std::vector<uint8_t> isLocked = ::FindLockedVertices(indices, welded);
+    std::vector<Quadric> quadrics = ::ComputeQuadrics(vertices, indices);
+
+    const double errorLimit = static_cast<double>(targetError) * targetError;
+    double reachedError { 0.0 };
+
+    std::vector<size_t> adjacencyBegin(vertices.size() + 1);
+    std::vector<size_t> adjacency {};
+    std::vector<Collapse> collapses {};
+    std::vector<uint8_t> isTouched(vertices.size());
+
+    // the triangles around a vertex keep facing the same way with it moved
+    auto keepsOrientation = [&](GLuint from, GLuint to) {
+        const glm::vec3& target = vertices[to].position;
+
+        for (size_t j = adjacencyBegin[from]; j < adjacencyBegin[from + 1]; ++j) {
+            const GLuint* triangle = &indices[adjacency[j] * 3];
+            if (triangle[0] == to || triangle[1] == to || triangle[2] == to) continue;
+
+            const size_t corner = triangle[0] == from ? 0 : (triangle[1] == from ? 1 : 2);
+            const glm::vec3& p1 = vertices[triangle[(corner + 1) % 3]].position;
+            const glm::vec3& p2 = vertices[triangle[(corner + 2) % 3]].position;
+            const glm::vec3& p0 = vertices[from].position;
+
+            const glm::vec3 before = glm::cross(p1 - p0, p2 - p0);
+            const glm::vec3 after = glm::cross(p1 - target, p2 - target);
+
+            if (glm::dot(before, after) <= 0.0f) return false;
+        }
+
+        return true;
+    };
+
+    while (indices.size() > targetIndexCount) {
+        const size_t triangleCount = indices.size() / 3;
+
+        std::fill(adjacencyBegin.begin(), adjacencyBegin.end(), 0);
+        for (GLuint index : indices) {
+            ++adjacencyBegin[index + 1];
+        }
+
+        std::partial_sum(adjacencyBegin.begin(), adjacencyBegin.end(), adjacencyBegin.begin());
+
+        adjacency.resize(indices.size());
+        {
+            std::vector<size_t> filled(adjacencyBegin.begin(), adjacencyBegin.end() - 1);
+
+            for (size_t triangle = 0; triangle < triangleCount; ++triangle) {
+                for (size_t corner = 0; corner < 3; ++corner) {
+                    adjacency[filled[indices[triangle * 3 + corner]]++] = triangle;
+                }
+            }
+        }
+
+        collapses.clear();
+
+        for (size_t i = 0; i < indices.size(); i += 3) {
+            for (size_t corner = 0; corner < 3; ++corner) {
+                const GLuint a = indices[i + corner];
+                const GLuint b = indices[i + (corner + 1) % 3];
+
+                if (!isLocked[a]) collapses.push_back({ a, b, ::Error(quadrics[a], vertices[b].position) });
+                if (!isLocked[b]) collapses.push_back({ b, a, ::Error(quadrics[b], vertices[a].position) });
+            }
+        }
+
+        std::sort(collapses.begin(), collapses.end(), [](const Collapse& a, const Collapse& b) {
+            return a.error < b.error;
+        });
+
+        // an interior collapse takes two triangles along
+        const size_t wantedTriangles = (indices.size() - targetIndexCount + 2) / 3;
+        size_t removedTriangles { 0 };
+        std::fill(isTouched.begin(), isTouched.end(), 0);
+
+        for (const Collapse& collapse : collapses) {
+            if (collapse.error > errorLimit || removedTriangles >= wantedTriangles) break;
+
+            // adjacency of both ends is stale after a collapse, the rest stays valid
+            if (isTouched[collapse.from] || isTouched[collapse.to]) continue;
+            if (!keepsOrientation(collapse.from, collapse.to)) continue;
+
+            for (size_t j = adjacencyBegin[collapse.from]; j < adjacencyBegin[collapse.from + 1]; ++j) {
+                GLuint* triangle = &indices[adjacency[j] * 3];
+                if (::IsDegenerate(triangle)) continue;
+
+                for (size_t corner = 0; corner < 3; ++corner) {
+                    if (triangle[corner] == collapse.from) triangle[corner] = collapse.to;
+                }
+
+                if (::IsDegenerate(triangle)) ++removedTriangles;
+            }
+
+            quadrics[collapse.to] += quadrics[collapse.from];
+            isTouched[collapse.from] = 1;
+            isTouched[collapse.to] = 1;
+            reachedError = std::max(reachedError, collapse.error);
+        }
+
+        if (!removedTriangles) break;
+
+        size_t kept { 0 };
+        for (size_t i = 0; i < indices.size(); i += 3) {
+            if (::IsDegenerate(&indices[i])) continue;
+
+            std::copy_n(indices.begin() + static_cast<std::ptrdiff_t>(i), 3,
+                        indices.begin() + static_cast<std::ptrdiff_t>(kept));
+            kept += 3;
+        }
+
+        indices.resize(kept);
+    }
+
+    return static_cast<float>(std::sqrt(reachedError));
+}
+
+} // namespace meshsimplification
@@ -0,0 +1,111 @@
+#include "misc/bounds.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+
+namespace {
+
+static constexpr float INF { std::numeric_limits<float>::infinity() };
+
+float MaxScale(const glm::mat4& transform) {
+    return std::sqrt(std::max({ glm::dot(glm::vec3 { transform[0] }, glm::vec3 { transform[0] }),
+                                glm::dot(glm::vec3 { transform[1] }, glm::vec3 { transform[1] }),
+                                glm::dot(glm::vec3 { transform[2] }, glm::vec3 { transform[2] }) }));
+}
+
+} // namespace
+
+
+Bounds::Bounds() :
+    min { ::INF },
+    max { -::INF },
+    center {},
+    radius {} {}
+
+Bounds::Bounds(const glm::vec3& min, const glm::vec3& max) :
+    min { min },
+    max { max },
+    center { (min + max) * 0.5f },
+    radius { glm::length(max - min) * 0.5f } {}
+
+Bounds Bounds::FromVertices(const std::vector<Vertex>& vertices) {
+    Bounds bounds {};
+
+    for (const auto& vertex : vertices) {
+        bounds.min = glm::min(bounds.min, vertex.position);
+        bounds.max = glm::max(bounds.max, vertex.position);
+    }
+
+    if (bounds.IsEmpty()) return bounds;
+
+    // tighter than half of the box diagonal
+    bounds.center = (bounds.min + bounds.max) * 0.5f;
+
+    float radiusSquared { 0.0f };
+    for (const auto& vertex : vertices) {
+        const glm::vec3 offset = vertex.position - bounds.center;
+        radiusSquared = std::max(radiusSquared, glm::dot(offset, offset));
+    }
+
+    bounds.radius = std::sqrt(radiusSquared);
+
+    return bounds;
+}
+
+bool Bounds::IsEmpty() const {
+    return min.x > max.x;
+}
+
+Bounds Bounds::Transformed(const glm::mat4& transform) const {
+    if (IsEmpty()) return *this;
+
+    // extents of a rotated box (Arvo)
+    const glm::vec3 boxCenter = glm::vec3 { transform * glm::vec4 { (min + max) * 0.5f, 1.0f } };
+    const glm::vec3 halfSize = (max - min) * 0.5f;
+
+    glm::vec3 extent {};
+    for (int axis = 0; axis < 3; ++axis) {
+        extent += glm::abs(glm::vec3 { transform[axis] }) * halfSize[axis];
+    }
+
+    Bounds result { boxCenter - extent, boxCenter + extent };
+    result.center = glm::vec3 { transform * glm::vec4 { center, 1.0f } };
+    result.radius = radius * ::MaxScale(transform);
+
+    return result;
+}
+
+void Bounds::Merge(const Bounds& other) {
+    if (other.IsEmpty()) return;
+
+    if (IsEmpty()) {
+        *this = other;
+        return;
+    }
+
+    min = glm::min(min, other.min);
+    max = glm::max(max, other.max);
+
+    // smallest sphere around both spheres
+    const glm::vec3 offset = other.center - center;
+    const float distance = glm::length(offset);
+
+    if (distance + other.radius <= radius) return;
+
+    if (distance + radius <= other.radius) {
+        center = other.center;
+        radius = other.radius;
+        return;
+    }
+
+    const float mergedRadius = (distance + radius + other.radius) * 0.5f;
+    center += offset * ((mergedRadius - radius) / distance);
+    radius = mergedRadius;
+}
+
+glm::vec4 Bounds::ToSphere(const glm::mat4& transform) const {
+    return glm::vec4 { glm::vec3 { transform * glm::vec4 { center, 1.0f } },
+                       radius * ::MaxScale(transform) };
+}
@@ -4,6 +4,9 @@
 
 #include <sstream>
 #include <fstream>
+#include <string>
+#include <system_error>
+#include <thread>
 
 
 namespace filesystem {
@@ -34,4 +37,35 @@ std::string GetContentFile(const std::filesystem::path& path) {
     return result.str();
 }
 
+bool ReplaceContentFile(const std::filesystem::path& path,
+                        const std::function<void(std::ostream&)>& write) {
+    // one name per thread, concurrent writers of the same file don't collide
+    fs::path temporaryPath { path };
+    temporaryPath += "." + std::to_string(std::hash<std::thread::id> {}(std::this_thread::get_id()));
+
+    std::error_code error {};
+
+    {
+        std::ofstream file { temporaryPath, std::ios::out | std::ios::binary | std::ios::trunc };
+        if (!file) return false;
+
+        write(file);
+
+        if (!file) {
+            file.close();
+            fs::remove(temporaryPath, error);
+            return false;
+        }
+    }
+
+    fs::rename(temporaryPath, path, error);
+
+    if (error) {
+        fs::remove(temporaryPath, error);
+        return false;
+    }
+
+    return true;
+}
+
 } // namespace filesystem
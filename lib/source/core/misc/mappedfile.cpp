@@ -0,0 +1,81 @@
+#include "misc/mappedfile.h"
+
+#include "app_exceptions.h"
+
+#include <fstream>
+#include <string>
+
+#ifdef __unix__
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+
+MappedFile::MappedFile(const std::filesystem::path& path) :
+    m_data { nullptr },
+    m_size { 0 },
+    m_mapped { false },
+    m_buffer {} {
+#ifdef __unix__
+    const int descriptor = open(path.c_str(), O_RDONLY);
+    if (descriptor < 0) {
+        throw FilesystemException { "Cannot open file " + path.string() };
+    }
+
+    struct stat status {};
+    if (fstat(descriptor, &status) != 0) {
+        close(descriptor);
+        throw FilesystemException { "Cannot stat file " + path.string() };
+    }
+
+    m_size = static_cast<size_t>(status.st_size);
+
+    if (m_size) {
+        void* data = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+
+        if (data != MAP_FAILED) {
+            m_data = static_cast<const uint8_t*>(data);
+            m_mapped = true;
+        }
+    }
+
+    // the mapping stays valid without the descriptor
+    close(descriptor);
+
+    if (m_mapped || !m_size) return;
+#endif
+
+    std::ifstream file { path, std::ios::in | std::ios::binary | std::ios::ate };
+    if (!file) {
+        throw FilesystemException { "Cannot open file " + path.string() };
+    }
+
+    m_buffer.resize(static_cast<size_t>(file.tellg()));
+    file.seekg(0);
+
+    if (!file.read(reinterpret_cast<char*>(m_buffer.data()),
+                   static_cast<std::streamsize>(m_buffer.size()))) {
+        throw FilesystemException { "Cannot read file " + path.string() };
+    }
+
+    m_data = m_buffer.data();
+    m_size = m_buffer.size();
+}
+
+MappedFile::~MappedFile() {
+#ifdef __unix__
+    if (m_mapped) {
+        munmap(const_cast<uint8_t*>(m_data), m_size);
+    }
+#endif
+}
+
+const uint8_t* MappedFile::GetData() const {
+    return m_data;
+}
+
+size_t MappedFile::GetSize() const {
+    return m_size;
+}
@@ -0,0 +1,53 @@
+#include "misc/sourcestamp.h"
+
+#include "misc/mappedfile.h"
+
+#include <system_error>
+
+
+namespace {
+
+namespace fs = std::filesystem;
+
+static constexpr uint64_t FNV_OFFSET_BASIS { 14695981039346656037ull };
+static constexpr uint64_t FNV_PRIME { 1099511628211ull };
+
+uint64_t HashFile(const fs::path& path) {
+    MappedFile file { path };
+
+    const uint8_t* data = file.GetData();
+    uint64_t hash { FNV_OFFSET_BASIS };
+
+    for (size_t i = 0; i < file.GetSize(); ++i) {
+        hash ^= data[i];
+        hash *= FNV_PRIME;
+    }
+
+    return hash;
+}
+
+int64_t GetTime(const fs::path& path) {
+    return static_cast<int64_t>(fs::last_write_time(path).time_since_epoch().count());
+}
+
+} // namespace
+
+
+SourceStamp SourceStamp::Of(const std::filesystem::path& sourcePath) {
+    return SourceStamp { fs::file_size(sourcePath), ::GetTime(sourcePath), ::HashFile(sourcePath) };
+}
+
+bool SourceStamp::Matches(const std::filesystem::path& sourcePath) {
+    std::error_code error {};
+
+    const uint64_t sourceSize = fs::file_size(sourcePath, error);
+    if (error || sourceSize != size) return false;
+
+    const int64_t sourceTime = ::GetTime(sourcePath);
+    if (sourceTime == time) return true;
+
+    if (::HashFile(sourcePath) != hash) return false;
+
+    time = sourceTime;
+    return true;
+}
@@ -0,0 +1,224 @@
+#include "misc/vertexformat.h"
+
+#include "mesh/mesh.h"
+
+#include <glm/gtc/packing.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+
+namespace {
+
+static constexpr float EMPTY_EPSILON { 1e-12f };
+// half floats keep about 1/1024 up to here, enough for a 1k texture
+static constexpr float HALF_TEXTURE_LIMIT { 2.0f };
+
+static constexpr GLuint POSITION_SIZES[] { 12, 8 };
+static constexpr GLuint NORMAL_SIZES[] { 0, 12, 4 };
+static constexpr GLuint TEXTURE_SIZES[] { 0, 8, 4 };
+
+template<typename Encoding>
+size_t ToIndex(Encoding encoding) {
+    return static_cast<size_t>(encoding);
+}
+
+// degenerate axes keep a unit scale, so the dequantization stays invertible
+glm::vec3 Extent(const Bounds& bounds) {
+    glm::vec3 extent = bounds.max - bounds.min;
+
+    for (int axis = 0; axis < 3; ++axis) {
+        if (!(extent[axis] > 0.0f)) extent[axis] = 1.0f;
+    }
+
+    return extent;
+}
+
+void Write(uint8_t*& result, const void* data, size_t size) {
+    std::memcpy(result, data, size);
+    result += size;
+}
+
+} // namespace
+
+
+VertexFormat::VertexFormat() :
+    VertexFormat { PositionEncoding::FLOAT3, NormalEncoding::FLOAT3, TextureEncoding::FLOAT2 } {}
+
+VertexFormat::VertexFormat(PositionEncoding position, NormalEncoding normal,
+                           TextureEncoding texture) :
+    position { position },
+    normal { normal },
+    texture { texture } {}
+
+VertexFormat VertexFormat::Full() {
+    return VertexFormat {};
+}
+
+VertexFormat VertexFormat::Choose(const Vertex* vertices, size_t count, bool quantize) {
+    bool hasNormals { false };
+    bool hasTexture { false };
+    bool isTextureSmall { true };
+
+    for (size_t i = 0; i < count; ++i) {
+        const Vertex& vertex = vertices[i];
+
+        hasNormals |= glm::dot(vertex.normal, vertex.normal) > ::EMPTY_EPSILON;
+        hasTexture |= glm::dot(vertex.texture, vertex.texture) > ::EMPTY_EPSILON;
+        isTextureSmall &= std::abs(vertex.texture.x) <= ::HALF_TEXTURE_LIMIT &&
+                          std::abs(vertex.texture.y) <= ::HALF_TEXTURE_LIMIT;
+    }
+
+    VertexFormat format {};
+    format.position = quantize ? PositionEncoding::UNORM16 : PositionEncoding::FLOAT3;
+
+    if (!hasNormals) {
+        format.normal = NormalEncoding::NONE;
+    } else if (quantize) {
+        format.normal = NormalEncoding::SNORM_2_10_10_10;
+    }
+
+    if (!hasTexture) {
+        format.texture = TextureEncoding::NONE;
+    } else if (quantize && isTextureSmall) {
+        format.texture = TextureEncoding::HALF2;
+    }
+
+    return format;
+}
+
+bool VertexFormat::FromKey(uint32_t key, VertexFormat& format) {
+    const uint32_t position = key & 0xFF;
+    const uint32_t normal = (key >> 8) & 0xFF;
+    const uint32_t texture = (key >> 16) & 0xFF;
+
+    if (position > ::ToIndex(PositionEncoding::UNORM16) ||
+        normal > ::ToIndex(NormalEncoding::SNORM_2_10_10_10) ||
+        texture > ::ToIndex(TextureEncoding::HALF2) || (key >> 24)) {
+        return false;
+    }
+
+    format = VertexFormat { static_cast<PositionEncoding>(position),
+                            static_cast<NormalEncoding>(normal),
+                            static_cast<TextureEncoding>(texture) };
+    return true;
+}
+
+bool VertexFormat::operator==(const VertexFormat& other) const {
+    return GetKey() == other.GetKey();
+}
+
+bool VertexFormat::operator!=(const VertexFormat& other) const {
+    return !(*this == other);
+}
+
+uint32_t VertexFormat::GetKey() const {
+    return static_cast<uint32_t>(::ToIndex(position)) |
+           static_cast<uint32_t>(::ToIndex(normal)) << 8 |
+           static_cast<uint32_t>(::ToIndex(texture)) << 16;
+}
+
+GLsizei VertexFormat::GetStride() const {
+    return static_cast<GLsizei>(::POSITION_SIZES[::ToIndex(position)] +
+                                ::NORMAL_SIZES[::ToIndex(normal)] +
+                                ::TEXTURE_SIZES[::ToIndex(texture)]);
+}
+
+bool VertexFormat::IsQuantized() const {
+    return position == PositionEncoding::UNORM16;
+}
+
+glm::mat4 VertexFormat::GetDequantization(const Bounds& bounds) const {
+    if (!IsQuantized()) return glm::mat4 { 1.0f };
+
+    return glm::scale(glm::translate(glm::mat4 { 1.0f }, bounds.min), ::Extent(bounds));
+}
+
+void VertexFormat::Encode(const Vertex* vertices, size_t count, const Bounds& bounds,
+                          uint8_t* result) const {
+    if (*this == Full()) {
+        std::memcpy(result, vertices, count * sizeof(Vertex));
+        return;
+    }
+
+    const glm::vec3 extent = ::Extent(bounds);
+
+    for (size_t i = 0; i < count; ++i) {
+        const Vertex& vertex = vertices[i];
+
+        if (IsQuantized()) {
+            const glm::vec3 unit = glm::clamp((vertex.position - bounds.min) / extent, 0.0f, 1.0f);
+            const uint64_t packed = glm::packUnorm4x16(glm::vec4 { unit, 0.0f });
+            ::Write(result, &packed, sizeof(packed));
+        } else {
+            ::Write(result, &vertex.position, sizeof(vertex.position));
+        }
+
+        // the inverse transpose of the dequantization undoes this scale
+        glm::vec3 normal = vertex.normal;
+        if (IsQuantized() && glm::dot(normal, normal) > ::EMPTY_EPSILON) {
+            normal = glm::normalize(normal * extent);
+        }
+
+        if (this->normal == NormalEncoding::FLOAT3) {
+            ::Write(result, &normal, sizeof(normal));
+        } else if (this->normal == NormalEncoding::SNORM_2_10_10_10) {
+            const uint32_t packed = glm::packSnorm3x10_1x2(glm::vec4 { normal, 0.0f });
+            ::Write(result, &packed, sizeof(packed));
+        }
+
+        if (texture == TextureEncoding::FLOAT2) {
+            ::Write(result, &vertex.texture, sizeof(vertex.texture));
+        } else if (texture == TextureEncoding::HALF2) {
+            const uint32_t packed = glm::packHalf2x16(vertex.texture);
+            ::Write(result, &packed, sizeof(packed));
+        }
+    }
+}
+
+void VertexFormat::SetAttribFormats(GLuint vertexArray, GLuint binding) const {
+    const GLuint positionLocation = static_cast<GLuint>(AttribIndex::POSITION);
+    const GLuint normalLocation = static_cast<GLuint>(AttribIndex::NORMAL);
+    const GLuint textureLocation = static_cast<GLuint>(AttribIndex::TEXTURE);
+
+    GLuint offset { 0 };
+
+    if (IsQuantized()) {
+        glVertexArrayAttribFormat(vertexArray, positionLocation, 3, GL_UNSIGNED_SHORT, GL_TRUE, offset);
+    } else {
+        glVertexArrayAttribFormat(vertexArray, positionLocation, 3, GL_FLOAT, GL_FALSE, offset);
+    }
+
+    glVertexArrayAttribBinding(vertexArray, positionLocation, binding);
+    glEnableVertexArrayAttrib(vertexArray, positionLocation);
+    offset += ::POSITION_SIZES[::ToIndex(position)];
+
+    if (normal == NormalEncoding::NONE) {
+        glDisableVertexArrayAttrib(vertexArray, normalLocation);
+    } else {
+        if (normal == NormalEncoding::FLOAT3) {
+            glVertexArrayAttribFormat(vertexArray, normalLocation, 3, GL_FLOAT, GL_FALSE, offset);
+        } else {
+            glVertexArrayAttribFormat(vertexArray, normalLocation, 4, GL_INT_2_10_10_10_REV, GL_TRUE, offset);
+        }
+
+        glVertexArrayAttribBinding(vertexArray, normalLocation, binding);
+        glEnableVertexArrayAttrib(vertexArray, normalLocation);
+        offset += ::NORMAL_SIZES[::ToIndex(normal)];
+    }
+
+    if (texture == TextureEncoding::NONE) {
+        glDisableVertexArrayAttrib(vertexArray, textureLocation);
+    } else {
+        if (texture == TextureEncoding::FLOAT2) {
+            glVertexArrayAttribFormat(vertexArray, textureLocation, 2, GL_FLOAT, GL_FALSE, offset);
+        } else {
+            glVertexArrayAttribFormat(vertexArray, textureLocation, 2, GL_HALF_FLOAT, GL_FALSE, offset);
+        }
+
+        glVertexArrayAttribBinding(vertexArray, textureLocation, binding);
+        glEnableVertexArrayAttrib(vertexArray, textureLocation);
+    }
+}
@@ -68,25 +68,33 @@ void swap(Model& lhs, Model& rhs) {
 
     swap(static_cast<Object>(lhs), static_cast<Object>(rhs));
     swap(lhs.m_lods, rhs.m_lods);
-    swap(lhs.m_distanceStep, rhs.m_distanceStep);
+    swap(lhs.m_lodErrors, rhs.m_lodErrors);
+    swap(lhs.m_lodId, rhs.m_lodId);
+    swap(lhs.m_isImpostor, rhs.m_isImpostor);
 }
 
 
 Model::Model(const Model& other) :
     Object { other },
     m_lods { other.m_lods },
-    m_distanceStep { other.m_distanceStep } {}
+    m_lodErrors { other.m_lodErrors },
+    m_lodId { other.m_lodId },
+    m_isImpostor { other.m_isImpostor } {}
 
 Model::Model(Model&& other) noexcept :
     Object { std::move(other) },
     m_lods { std::move(other.m_lods) },
-    m_distanceStep { std::move(other.m_distanceStep) } {}
+    m_lodErrors { std::move(other.m_lodErrors) },
+    m_lodId { std::move(other.m_lodId) },
+    m_isImpostor { std::move(other.m_isImpostor) } {}
 
 Model& Model::operator=(const Model& other) {
     if (this != &other) {
         Object::operator=(other);
         m_lods = other.m_lods;
-        m_distanceStep = other.m_distanceStep;
+        m_lodErrors = other.m_lodErrors;
+        m_lodId = other.m_lodId;
+        m_isImpostor = other.m_isImpostor;
     }
 
     return *this;
@@ -96,7 +104,9 @@ Model& Model::operator=(Model&& other) noexcept {
     if (this != &other) {
         Object::operator=(std::move(other));
         m_lods = std::move(other.m_lods);
-        m_distanceStep = std::move(other.m_distanceStep);
+        m_lodErrors = std::move(other.m_lodErrors);
+        m_lodId = std::move(other.m_lodId);
+        m_isImpostor = std::move(other.m_isImpostor);
     }
 
     return *this;
@@ -109,7 +119,9 @@ Model::Model(const std::filesystem::path& path) :
 Model::Model(std::filesystem::path path,
              std::filesystem::path textureDirectory) :
     m_lods {},
-    m_distanceStep {} {
+    m_lodErrors {},
+    m_lodId {},
+    m_isImpostor { false } {
 
     path = std::filesystem::canonical(path);
     textureDirectory = std::filesystem::canonical(textureDirectory);
@@ -120,11 +132,15 @@ Model::Model(std::filesystem::path path,
 
     UpdateLODs(path);
 
-    for (auto& lodPath : m_lods) {
-        if (!Everywhere::Instance().Get<ModelStorage>().HasModel(lodPath)) {
-            Everywhere::Instance().Get<ModelStorage>().CreateModelData(
-                lodPath, std::filesystem::canonical(textureDirectory));
+    ModelStorage& modelStorage = Everywhere::Instance().Get<ModelStorage>();
+
+    for (auto& lod : m_lods) {
+        if (!modelStorage.HasModel(lod.path, lod.level)) {
+            modelStorage.CreateModelData(lod.path, textureDirectory, lod.level);
         }
+
+        // no storage lookups per frame
+        lod.data = modelStorage.GetLod(lod.path, lod.level);
     }
 }
 
@@ -132,52 +148,119 @@ Model::~Model() {
     m_lods.clear();
 }
 
-std::vector<std::filesystem::path>& Model::GetLODs() {
+std::vector<ModelLod>& Model::GetLODs() {
     return m_lods;
 }
 
-const std::vector<std::filesystem::path>& Model::GetLODs() const {
+const std::vector<ModelLod>& Model::GetLODs() const {
     return m_lods;
 }
 
-void Model::UpdateDistanceStep() {
-    m_distanceStep =
-        Everywhere::Instance().Get<Projection>().GetDepthFar() / m_lods.size();
+void Model::UpdateLODs(const std::filesystem::path& path) {
+    std::vector<fs::path> lodPaths {};
+    FindLODFiles(path, lodPaths);
+
+    if (lodPaths.size() > 1) {
+        SortLodsByPostfixNumber(lodPaths);
+    }
+
+    m_lods.push_back({ path, 0, nullptr });
+
+    for (auto& lodPath : lodPaths) {
+        m_lods.push_back({ lodPath, 0, nullptr });
+    }
+
+    // simplified on import and cached next to the source
+    if (lodPaths.empty()) {
+        for (size_t level = 1; level <= ModelData::GENERATED_LOD_COUNT; ++level) {
+            m_lods.push_back({ path, level, nullptr });
+        }
+    }
+
+    // the source is exact, LOD files never tell
+    m_lodErrors.assign(m_lods.size(), LodSelector::UNKNOWN_ERROR);
+    m_lodErrors.front() = 0.0f;
+}
+
+const std::shared_ptr<ModelData>& Model::GetLodData(size_t lodId) const {
+    return m_lods[lodId].data;
 }
 
-void Model::UpdateLODs(const std::filesystem::path& path) {
-    FindLODFiles(path, m_lods);
+void Model::UpdateLodErrors() {
+    for (size_t i = 1; i < m_lods.size(); ++i) {
+        if (!m_lods[i].level || m_lodErrors[i] != LodSelector::UNKNOWN_ERROR) continue;
 
-    if (m_lods.size() > 1) {
-        SortLodsByPostfixNumber(m_lods);
+        const ModelData& modelData = *GetLodData(i);
+        if (modelData.IsReady()) {
+            m_lodErrors[i] = modelData.GetError();
+        }
     }
+}
+
+size_t Model::SelectLod(const Bounds& bounds, const glm::mat4& transform) {
+    UpdateLodErrors();
 
-    m_lods.insert(m_lods.begin(), path);
+    const glm::vec4 sphere = bounds.ToSphere(transform);
+    const float modelScale = bounds.radius > 0.0f ? sphere.w / bounds.radius : 1.0f;
+
+    m_lodId = Everywhere::Instance().Get<LodSelector>().Select(m_lodErrors, sphere, modelScale, m_lodId);
+    return m_lodId;
+}
 
-    UpdateDistanceStep();
+bool Model::SelectImpostor(const Bounds& bounds, const glm::mat4& transform) {
+    m_isImpostor = Everywhere::Instance().Get<LodSelector>().WantsImpostor(bounds.ToSphere(transform), m_isImpostor);
+    return m_isImpostor;
 }
 
-float Model::GetDistanceToCamera() const {
-    return glm::distance(
-        Everywhere::Instance().Get<Camera>().GetTransform().GetPosition(),
-        GetGlobalTransform().GetPosition());
+Bounds Model::GetLocalBounds() const {
+    if (m_lods.empty()) return Bounds {};
+
+    const auto& modelData = GetLodData(0);
+    if (!modelData || !modelData->IsReady()) return Bounds {};
+
+    Bounds bounds = modelData->GetBounds();
+
+    if (!m_children.IsEmpty()) {
+        const Bounds childrenBounds = Object::GetLocalBounds();
+        if (childrenBounds.IsEmpty()) return childrenBounds;
+
+        bounds.Merge(childrenBounds);
+    }
+
+    return bounds;
 }
 
-size_t Model::GetCurrentLodId() const {
-    return static_cast<size_t>(GetDistanceToCamera() / m_distanceStep);
+std::shared_ptr<ModelData> Model::GetReadyLod(size_t lodId) const {
+    // coarser LODs first, they are cheaper and usually ready earlier
+    for (size_t i = lodId; i < m_lods.size(); ++i) {
+        if (GetLodData(i)->IsReady()) return GetLodData(i);
+    }
+
+    for (size_t i = lodId; i-- > 0;) {
+        if (GetLodData(i)->IsReady()) return GetLodData(i);
+    }
+
+    return nullptr;
 }
 
 void Model::Processing() {
-    size_t lodId = GetCurrentLodId();
+    const glm::mat4& transform = GetGlobalMatrix();
+
+    // any ready LOD is close enough to measure the model with
+    auto modelData = GetReadyLod(m_lodId);
+
+    if (modelData) {
+        const Bounds bounds = modelData->GetBounds();
+        modelData = GetReadyLod(SelectLod(bounds, transform));
 
-    if (lodId < m_lods.size()) {
-        auto modelData =
-            Everywhere::Instance().Get<ModelStorage>().Get(m_lods.at(lodId));
+        if (Everywhere::Instance().Get<RenderQueue>().IsVisible(modelData->GetBounds(), transform)) {
+            // baked from the source, the selected LOD is drawn until the bake is done
+            const bool isImpostor = SelectImpostor(bounds, transform) &&
+                Everywhere::Instance().Get<ImpostorStorage>().Add(GetLodData(0), transform);
 
-        if (modelData) {
-            modelData->SetParentTransform(GetParentTransform());
-            modelData->SetTransform(GetTransform());
-            modelData->Processing();
+            if (!isImpostor) {
+                modelData->AddToRenderQueue(transform);
+            }
         }
     }
 
@@ -3,10 +3,14 @@
 #include "app_exceptions.h"
 #include "everywhere.h"
 #include "misc/vertex.h"
+#include "texture/compressedimage.h"
 #include "texture/textureparams.h"
 #include "material/phongmaterial.h"
 #include "material/texturematerial.h"
+#include "material/indexedtexturematerial.h"
 #include "mesh/mesh.h"
+#include "mesh/kmeshfile.h"
+#include "mesh/meshsimplification.h"
 
 #include <assimp/Importer.hpp>
 #include <assimp/postprocess.h>
@@ -14,6 +18,8 @@
 #include <cstddef>
 #include <string>
 #include <regex>
+#include <system_error>
+#include <unordered_map>
 #include <algorithm>
 #include <iterator>
 
@@ -23,6 +29,19 @@ namespace {
 namespace fs = std::filesystem;
 namespace rx_const = std::regex_constants;
 
+// imported meshes go to the GPU with 16-bit positions, packed normals and half UVs
+static constexpr bool QUANTIZE_VERTICES { true };
+
+// share of the source triangles and largest error, relative to the model radius,
+// of every generated LOD; a level ends at whichever is reached first
+static constexpr float LOD_TRIANGLE_RATIOS[ModelData::GENERATED_LOD_COUNT] { 0.5f, 0.25f, 0.125f };
+static constexpr float LOD_RELATIVE_ERRORS[ModelData::GENERATED_LOD_COUNT] { 0.01f, 0.03f, 0.08f };
+
+// as the texture storage loads them
+static constexpr bool FLIP_TEXTURES { true };
+
+using DecodedImages = std::unordered_map<std::string, std::shared_ptr<const DecodedImage>>;
+
 
 glm::vec2 ToVec2(const aiVector3D& vec3d) {
     return { vec3d.x, vec3d.y };
@@ -49,6 +68,8 @@ void InitVertices(aiMesh* mesh, std::vector<Vertex>& result) {
 }
 
 void InitIndices(aiMesh* mesh, std::vector<GLuint>& result) {
+    result.reserve(static_cast<size_t>(mesh->mNumFaces) * 3);
+
     for (size_t i = 0; i < mesh->mNumFaces; ++i) {
         aiFace face = mesh->mFaces[i];
 
@@ -58,23 +79,114 @@ void InitIndices(aiMesh* mesh, std::vector<GLuint>& result) {
     }
 }
 
+// the meshes of the source turned into the given LOD, returns its error
+float SimplifyMeshes(std::vector<ImportedMesh>& meshes, size_t lod) {
+    const size_t level = std::min(lod, ModelData::GENERATED_LOD_COUNT) - 1;
+
+    Bounds bounds {};
+    for (const ImportedMesh& mesh : meshes) {
+        bounds.Merge(Bounds::FromVertices(mesh.vertices));
+    }
+
+    const float targetError = ::LOD_RELATIVE_ERRORS[level] * bounds.radius;
+    float error { 0.0f };
+
+    for (ImportedMesh& mesh : meshes) {
+        // only triangle lists have been optimized
+        if (!mesh.optimization.before.triangles) continue;
+
+        const float keptIndices = static_cast<float>(mesh.indices.size()) * ::LOD_TRIANGLE_RATIOS[level];
+        const size_t targetIndexCount = static_cast<size_t>(keptIndices) / 3 * 3;
+
+        error = std::max(error, meshsimplification::Simplify(mesh.vertices, mesh.indices,
+                                                             targetIndexCount, targetError));
+
+        // drops the collapsed vertices too
+        mesh.optimization = indexoptimization::Optimize(mesh.vertices, mesh.indices);
+        mesh.format = VertexFormat::Choose(mesh.vertices.data(), mesh.vertices.size(),
+                                           ::QUANTIZE_VERTICES);
+    }
+
+    return error;
+}
+
+// null for compiled images, which stream from their .dds, and for unreadable ones,
+// which the texture storage then fails on as before
+std::shared_ptr<const DecodedImage> DecodeTexture(const fs::path& path, DecodedImages& decoded) {
+    if (path.empty()) return nullptr;
+
+    std::error_code error {};
+    const fs::path canonicalPath = fs::canonical(path, error);
+
+    if (error || CompressedImage::IsUpToDate(canonicalPath)) return nullptr;
+
+    auto found = decoded.find(canonicalPath.string());
+    if (found != decoded.end()) return found->second;
+
+    std::shared_ptr<const DecodedImage> image {};
+
+    try {
+        image = std::make_shared<const DecodedImage>(canonicalPath, ::FLIP_TEXTURES);
+    } catch (const TextureException&) {
+        // reported on upload
+    }
+
+    decoded.insert({ canonicalPath.string(), image });
+    return image;
+}
+
+size_t PendingImageBytes(const std::shared_ptr<const DecodedImage>& image, bool isIndexed) {
+    if (!image) return 0;
+
+    const TextureStorage& textureStorage = Everywhere::Instance().Get<TextureStorage>();
+    const bool isStored = isIndexed ? textureStorage.HasSlot(image->GetPath())
+                                    : textureStorage.HasTexture(image->GetPath());
+
+    return isStored ? 0 : image->GetBytes();
+}
+
+void UploadImage(const std::shared_ptr<const DecodedImage>& image, GLenum textureUnit, bool isIndexed) {
+    if (!image) return;
+
+    TextureStorage& textureStorage = Everywhere::Instance().Get<TextureStorage>();
+
+    if (isIndexed) {
+        textureStorage.GetSlot(*image);
+    } else {
+        textureStorage.Get(*image, textureUnit);
+    }
+}
+
 bool HasNoOneTextures(aiMaterial* material) {
     return !(material->GetTextureCount(aiTextureType_DIFFUSE) ||
              material->GetTextureCount(aiTextureType_SPECULAR) ||
              material->GetTextureCount(aiTextureType_EMISSIVE));
 }
 
-fs::path GetTexturePath(aiMaterial* material, aiTextureType type, size_t idx = 0) {
-    fs::path texturePath =
-        Everywhere::Instance().Get<TextureStorage>().GetDefaultTexturePath();
+fs::path GetTexturePath(aiMaterial* material, aiTextureType type,
+                        const fs::path& directory, size_t idx = 0) {
+    if (!material->GetTextureCount(type)) return {};
 
-    if (material->GetTextureCount(type)) {
-        aiString stringPath {};
-        material->GetTexture(type, idx, &stringPath);
-        texturePath = stringPath.C_Str();
-    }
+    aiString stringPath {};
+    material->GetTexture(type, idx, &stringPath);
+
+    return directory / stringPath.C_Str();
+}
+
+fs::path TexturePathOrDefault(const fs::path& path) {
+    if (!path.empty()) return path;
+
+    return Everywhere::Instance().Get<TextureStorage>().GetDefaultTexturePath();
+}
+
+ImportedMaterial DefaultDummyMaterial() {
+    return ImportedMaterial { false, {}, {}, {}, nullptr, nullptr, nullptr };
+}
 
-    return texturePath;
+ImportedMaterial TextureMaterialOf(const fs::path& deffusePath,
+                                   const fs::path& specularPath,
+                                   const fs::path& emissionPath) {
+    return ImportedMaterial { true, deffusePath, specularPath, emissionPath, nullptr, nullptr, nullptr };
 }
 
 void CreateDefaultDummyMaterial() {
@@ -82,25 +194,47 @@ void CreateDefaultDummyMaterial() {
         std::make_shared<PhongMaterial>());
 }
 
-void CreateTextureMaterial(const fs::path& deffusePath,
-                           const fs::path& specularPath,
-                           const fs::path& emissionPath) {
-    TextureParams diffuseTextureData { deffusePath, GL_TEXTURE0 };
+void CreateTextureMaterial(const ImportedMaterial& material) {
+    TextureParams diffuseTextureData { TexturePathOrDefault(material.diffuse), GL_TEXTURE0 };
 
-    TextureParams specularTextureData { specularPath,
+    TextureParams specularTextureData { TexturePathOrDefault(material.specular),
                                         diffuseTextureData.GetUnit() + 1 };
 
-    TextureParams emissionTextureData { emissionPath,
+    TextureParams emissionTextureData { TexturePathOrDefault(material.emission),
                                         diffuseTextureData.GetUnit() + 2 };
 
-    auto textureMaterial =
-        std::make_shared<TextureMaterial>(diffuseTextureData,
-                                          specularTextureData,
-                                          emissionTextureData);
+    const bool isIndexed = Everywhere::Instance().Get<MaterialTable>().IsEnabled();
+
+    // stored under their paths, so the material finds them instead of reading the files
+    UploadImage(material.diffuseImage, diffuseTextureData.GetUnit(), isIndexed);
+    UploadImage(material.specularImage, specularTextureData.GetUnit(), isIndexed);
+    UploadImage(material.emissionImage, emissionTextureData.GetUnit(), isIndexed);
+
+    std::shared_ptr<Material> textureMaterial {};
+
+    if (isIndexed) {
+        textureMaterial = std::make_shared<IndexedTextureMaterial>(diffuseTextureData,
+                                                                   specularTextureData,
+                                                                   emissionTextureData);
+    } else {
+        textureMaterial = std::make_shared<TextureMaterial>(diffuseTextureData,
+                                                            specularTextureData,
+                                                            emissionTextureData);
+    }
 
     Everywhere::Instance().Get<MaterialStorage>().GetMaterials().Add(textureMaterial);
 }
 
+size_t CreateMaterial(const ImportedMaterial& material) {
+    if (material.textured) {
+        CreateTextureMaterial(material);
+    } else {
+        CreateDefaultDummyMaterial();
+    }
+
+    return Everywhere::Instance().Get<MaterialStorage>().GetLastMaterialID();
+}
+
 bool IsSomeTextureFilename(const fs::path& stem, const fs::path& modelFilename, const std::string& postfix) {
     std::regex pattern { "^t_+" + modelFilename.string() + "_+" + postfix + "$",
                          rx_const::icase };
@@ -125,10 +259,11 @@ bool IsEmissionTextureFilename(const fs::path& stem, const fs::path& modelFilena
 /* ModelDataImporter */
 
 
-bool ModelDataImporter::CreateTextureMaterialByFilename(const std::filesystem::path& textureDirectory) const {
-    fs::path deffusePath { Everywhere::Instance().Get<TextureStorage>().GetDefaultTexturePath() };
-    fs::path specularPath { Everywhere::Instance().Get<TextureStorage>().GetDefaultTexturePath() };
-    fs::path emissionPath { Everywhere::Instance().Get<TextureStorage>().GetDefaultTexturePath() };
+bool ModelDataImporter::FindTextureMaterialByFilename(const std::filesystem::path& textureDirectory,
+                                                      ImportedMaterial& result) const {
+    fs::path deffusePath {};
+    fs::path specularPath {};
+    fs::path emissionPath {};
     fs::path modelFilename { m_filepath.stem() };
 
     if (fs::exists(textureDirectory) && fs::is_directory(textureDirectory)) {
@@ -151,7 +286,7 @@ bool ModelDataImporter::CreateTextureMaterialByFilename(const std::filesystem::p
         }
 
         if (wasFound) {
-            CreateTextureMaterial(deffusePath, specularPath, emissionPath);
+            result = TextureMaterialOf(deffusePath, specularPath, emissionPath);
             return true;
         }
     }
@@ -159,14 +294,14 @@ bool ModelDataImporter::CreateTextureMaterialByFilename(const std::filesystem::p
     return false;
 }
 
-bool ModelDataImporter::CreateTextureMaterialByDefaultFilenames() const {
-    if (CreateTextureMaterialByFilename(m_textureDirectory)) {
+bool ModelDataImporter::FindTextureMaterialByDefaultFilenames(ImportedMaterial& result) const {
+    if (FindTextureMaterialByFilename(m_textureDirectory, result)) {
         return true;
     }
 
     fs::path currentDirectory = m_filepath.parent_path();
     if (currentDirectory != m_textureDirectory) {
-        if (CreateTextureMaterialByFilename(currentDirectory)) {
+        if (FindTextureMaterialByFilename(currentDirectory, result)) {
             return true;
         }
     }
@@ -176,7 +311,7 @@ bool ModelDataImporter::CreateTextureMaterialByDefaultFilenames() const {
         if (!entry.is_directory()) continue;
 
         if (std::regex_match(entry.path().stem().string(), pattern)) {
-            if (CreateTextureMaterialByFilename(entry.path())) {
+            if (FindTextureMaterialByFilename(entry.path(), result)) {
                 return true;
             }
         }
@@ -185,41 +320,26 @@ bool ModelDataImporter::CreateTextureMaterialByDefaultFilenames() const {
     return false;
 }
 
-size_t ModelDataImporter::GetMaterialId(aiMesh* mesh, const aiScene* scene) const {
-    if (!mesh || !scene) return 0;
+ImportedMaterial ModelDataImporter::GetMaterial(aiMesh* mesh, const aiScene* scene) const {
+    ImportedMaterial result { DefaultDummyMaterial() };
 
-    aiMaterial* material = scene->mMaterials[mesh->mMaterialIndex];
+    if (!mesh || !scene) return result;
 
-    if (!material) {
-        if (!CreateTextureMaterialByDefaultFilenames()) {
-            CreateDefaultDummyMaterial();
-        }
-    } else {
-        if (HasNoOneTextures(material)) {
-            if (!CreateTextureMaterialByDefaultFilenames()) {
-                CreateDefaultDummyMaterial();
-            }
-        } else {
-            size_t size = Everywhere::Instance().Get<MaterialStorage>().GetMaterials().Size();
-
-            CreateTextureMaterialByAssimpMaterial(material);
+    aiMaterial* material = scene->mMaterials[mesh->mMaterialIndex];
 
-            if (size == Everywhere::Instance().Get<MaterialStorage>().GetMaterials().Size()) {
-                if (!CreateTextureMaterialByDefaultFilenames()) {
-                    CreateDefaultDummyMaterial();
-                }
-            }
-        }
+    if (material && !HasNoOneTextures(material)) {
+        return GetTextureMaterialByAssimpMaterial(material);
     }
 
-    return Everywhere::Instance().Get<MaterialStorage>().GetLastMaterialID();
+    FindTextureMaterialByDefaultFilenames(result);
+    return result;
 }
 
-void ModelDataImporter::CreateTextureMaterialByAssimpMaterial(aiMaterial* material) const {
-    CreateTextureMaterial(
-        m_filepath.parent_path() / GetTexturePath(material, aiTextureType_DIFFUSE),
-        m_filepath.parent_path() / GetTexturePath(material, aiTextureType_SPECULAR),
-        m_filepath.parent_path() / GetTexturePath(material, aiTextureType_EMISSIVE));
+ImportedMaterial ModelDataImporter::GetTextureMaterialByAssimpMaterial(aiMaterial* material) const {
+    return TextureMaterialOf(
+        GetTexturePath(material, aiTextureType_DIFFUSE, m_filepath.parent_path()),
+        GetTexturePath(material, aiTextureType_SPECULAR, m_filepath.parent_path()),
+        GetTexturePath(material, aiTextureType_EMISSIVE, m_filepath.parent_path()));
 }
 
 void ModelDataImporter::CheckCorrectModelPath() const {
@@ -243,18 +363,20 @@ void ModelDataImporter::CheckCorrectModelPath() const {
 void ModelDataImporter::ProcessSceneMesh(aiMesh* mesh, const aiScene* scene) {
     if (!mesh) return;
 
-    std::vector<Vertex> vertices {};
-    std::vector<GLuint> indices {};
-
-    InitVertices(mesh, vertices);
-    InitIndices(mesh, indices);
+    ImportedMesh imported {};
 
-    auto meshOfModel = std::make_shared<Mesh>(std::move(vertices), std::move(indices));
-    meshOfModel->SetMaterialId(GetMaterialId(mesh, scene));
+    InitVertices(mesh, imported.vertices);
+    InitIndices(mesh, imported.indices);
 
-    if (m_modelData) {
-        m_modelData->Children().Add(meshOfModel);
+    if (mesh->mPrimitiveTypes == aiPrimitiveType_TRIANGLE) {
+        imported.optimization = indexoptimization::Optimize(imported.vertices, imported.indices);
     }
+
+    imported.format = VertexFormat::Choose(imported.vertices.data(), imported.vertices.size(),
+                                           ::QUANTIZE_VERTICES);
+    imported.material = GetMaterial(mesh, scene);
+
+    m_meshes.push_back(std::move(imported));
 }
 
 void ModelDataImporter::ProcessSceneNode(aiNode* node, const aiScene* scene) {
@@ -296,10 +418,10 @@ void ModelDataImporter::Import() {
 
 ModelDataImporter::ModelDataImporter(std::filesystem::path filepath,
                                      std::filesystem::path textureDirectory,
-                                     ModelData* modelData) :
+                                     std::vector<ImportedMesh>& meshes) :
     m_filepath { fs::canonical(filepath) },
     m_textureDirectory { fs::canonical(textureDirectory) },
-    m_modelData { modelData } {}
+    m_meshes { meshes } {}
 
 /* ModelData */
 
@@ -310,15 +432,230 @@ void swap(ModelData& lhs, ModelData& rhs) {
     using std::swap;
 
     swap(static_cast<Object>(lhs), static_cast<Object>(rhs));
+    swap(lhs.m_bounds, rhs.m_bounds);
 }
 
 ModelData::ModelData(const fs::path& path) :
     ModelData { path, path.parent_path() } {}
 
 ModelData::ModelData(const fs::path& path,
-                     const fs::path& textureDirectory) :
-    Object {} {
+                     const fs::path& textureDirectory,
+                     size_t lod) :
+    Object {},
+    m_bounds {},
+    m_path { path },
+    m_textureDirectory { textureDirectory },
+    m_lod { lod },
+    m_error {},
+    m_state { ModelDataState::IMPORTING },
+    m_importedMeshes {},
+    m_compiled {},
+    m_sourceMeshes {},
+    m_uploadedMeshes {},
+    m_importError {} {}
+
+ModelData::~ModelData() = default;
+
+void ModelData::ShareSourceMeshes(std::shared_ptr<std::vector<ImportedMesh>> meshes) {
+    m_sourceMeshes = std::move(meshes);
+}
 
-    ModelDataImporter importer { path, textureDirectory, this };
-    importer.Import();
+void ModelData::Import() {
+    try {
+        if (KMeshFile::IsUpToDate(m_path, m_lod)) {
+            try {
+                m_compiled = std::make_unique<KMeshFile>(m_path, m_lod);
+                m_error = m_compiled->GetError();
+            } catch (const ApplicationException&) {
+                // damaged, imported and written again below
+            }
+        }
+
+        if (!m_compiled) {
+            if (m_lod && m_sourceMeshes && !m_sourceMeshes->empty()) {
+                // already imported and optimized by the source
+                m_importedMeshes = *m_sourceMeshes;
+            } else {
+                ModelDataImporter importer { m_path, m_textureDirectory, m_importedMeshes };
+                importer.Import();
+
+                if (!m_lod && m_sourceMeshes) {
+                    *m_sourceMeshes = m_importedMeshes;
+                }
+            }
+
+            if (m_lod) {
+                m_error = ::SimplifyMeshes(m_importedMeshes, m_lod);
+            }
+
+            // a read-only resource tree just stays uncompiled
+            KMeshFile::Write(m_path, m_importedMeshes, m_lod, m_error);
+        }
+
+        m_sourceMeshes.reset();
+        DecodeTextures();
+
+        m_state.store(ModelDataState::UPLOADING, std::memory_order_release);
+    } catch (...) {
+        m_sourceMeshes.reset();
+        m_importError = std::current_exception();
+        m_state.store(ModelDataState::FAILED, std::memory_order_release);
+    }
+}
+
+size_t ModelData::Upload(size_t budget) {
+    const ModelDataState state = GetState();
+
+    if (state == ModelDataState::FAILED) {
+        std::rethrow_exception(m_importError);
+    }
+
+    if (state != ModelDataState::UPLOADING) return 0;
+
+    size_t usedBytes { 0 };
+
+    while (m_uploadedMeshes < GetMeshCount()) {
+        const size_t bytes = GetMeshBytes(m_uploadedMeshes);
+
+        // always at least one mesh, so oversized ones still get through
+        if (usedBytes && usedBytes + bytes > budget) break;
+
+        UploadMesh(m_uploadedMeshes);
+
+        usedBytes += bytes;
+        ++m_uploadedMeshes;
+    }
+
+    if (m_uploadedMeshes == GetMeshCount()) {
+        m_importedMeshes.clear();
+        m_importedMeshes.shrink_to_fit();
+        m_compiled.reset();
+
+        UpdateBounds();
+        m_state.store(ModelDataState::READY, std::memory_order_release);
+    }
+
+    return usedBytes;
+}
+
+size_t ModelData::GetMeshCount() const {
+    return m_compiled ? m_compiled->GetMeshCount() : m_importedMeshes.size();
+}
+
+ImportedMaterial& ModelData::GetMeshMaterial(size_t meshId) {
+    return m_compiled ? m_compiled->GetMesh(meshId).material : m_importedMeshes[meshId].material;
+}
+
+const ImportedMaterial& ModelData::GetMeshMaterial(size_t meshId) const {
+    return m_compiled ? m_compiled->GetMesh(meshId).material : m_importedMeshes[meshId].material;
+}
+
+void ModelData::DecodeTextures() {
+    DecodedImages decoded {};
+
+    for (size_t meshId = 0; meshId < GetMeshCount(); ++meshId) {
+        ImportedMaterial& material = GetMeshMaterial(meshId);
+        if (!material.textured) continue;
+
+        material.diffuseImage = ::DecodeTexture(material.diffuse, decoded);
+        material.specularImage = ::DecodeTexture(material.specular, decoded);
+        material.emissionImage = ::DecodeTexture(material.emission, decoded);
+    }
+}
+
+size_t ModelData::GetMeshBytes(size_t meshId) const {
+    size_t bytes { 0 };
+
+    if (m_compiled) {
+        const KMeshFile::MeshView& compiled = m_compiled->GetMesh(meshId);
+        bytes = compiled.vertexCount * static_cast<size_t>(compiled.format.GetStride()) +
+                compiled.indexCount * GeometryPool::GetIndexSize(compiled.indexType);
+    } else {
+        const ImportedMesh& imported = m_importedMeshes[meshId];
+        const GLenum indexType = GeometryPool::ChooseIndexType(imported.vertices.size());
+
+        bytes = imported.vertices.size() * static_cast<size_t>(imported.format.GetStride()) +
+                imported.indices.size() * GeometryPool::GetIndexSize(indexType);
+    }
+
+    const ImportedMaterial& material = GetMeshMaterial(meshId);
+
+    if (material.textured) {
+        const bool isIndexed = Everywhere::Instance().Get<MaterialTable>().IsEnabled();
+
+        // an image shared with an earlier mesh is stored by now and costs nothing
+        bytes += ::PendingImageBytes(material.diffuseImage, isIndexed) +
+                 ::PendingImageBytes(material.specularImage, isIndexed) +
+                 ::PendingImageBytes(material.emissionImage, isIndexed);
+    }
+
+    return bytes;
+}
+
+void ModelData::UploadMesh(size_t meshId) {
+    std::shared_ptr<Mesh> mesh {};
+    size_t materialId {};
+
+    if (m_compiled) {
+        const KMeshFile::MeshView& compiled = m_compiled->GetMesh(meshId);
+
+        mesh = std::make_shared<Mesh>(compiled.vertices, compiled.vertexCount, compiled.format,
+                                      compiled.indices, compiled.indexType, compiled.indexCount,
+                                      compiled.bounds);
+        materialId = CreateMaterial(compiled.material);
+    } else {
+        ImportedMesh& imported = m_importedMeshes[meshId];
+
+        mesh = std::make_shared<Mesh>(std::move(imported.vertices),
+                                      std::move(imported.indices),
+                                      imported.format);
+        materialId = CreateMaterial(imported.material);
+    }
+
+    mesh->SetMaterialId(materialId);
+    Children().Add(mesh);
+}
+
+ModelDataState ModelData::GetState() const {
+    return m_state.load(std::memory_order_acquire);
+}
+
+bool ModelData::IsReady() const {
+    return GetState() == ModelDataState::READY;
+}
+
+size_t ModelData::GetLod() const {
+    return m_lod;
+}
+
+float ModelData::GetError() const {
+    return m_error;
+}
+
+const Bounds& ModelData::GetBounds() const {
+    return m_bounds;
+}
+
+void ModelData::UpdateBounds() {
+    m_bounds = Bounds {};
+
+    for (auto& child : m_children) {
+        Mesh* mesh = dynamic_cast<Mesh*>(child.get());
+        if (!mesh) continue;
+
+        m_bounds.Merge(mesh->GetBounds().Transformed(mesh->GetTransform().ToMatrix()));
+    }
+}
+
+void ModelData::AddToRenderQueue(const glm::mat4& transform) {
+    if (!IsReady()) return;
+
+    RenderQueue& renderQueue = Everywhere::Instance().Get<RenderQueue>();
+
+    for (auto& child : m_children) {
+        Mesh* mesh = dynamic_cast<Mesh*>(child.get());
+        if (!mesh) continue;
+
+        renderQueue.Add(*mesh, transform * mesh->GetTransform().ToMatrix());
+    }
 }
@@ -53,6 +53,28 @@ const CollectionOf<Object>& Object::Children() const {
     return m_children;
 }
 
+Bounds Object::GetLocalBounds() const {
+    Bounds bounds {};
+
+    for (const auto& child : m_children.Get()) {
+        if (!child) continue;
+
+        const Bounds childBounds = child->GetLocalBounds();
+        if (childBounds.IsEmpty()) return Bounds {};
+
+        bounds.Merge(childBounds.Transformed(child->GetTransform().ToMatrix()));
+    }
+
+    return bounds;
+}
+
+Bounds Object::GetWorldBounds() const {
+    const Bounds bounds = GetLocalBounds();
+    if (bounds.IsEmpty()) return bounds;
+
+    return bounds.Transformed(GetGlobalMatrix());
+}
+
 void Object::Processing() {
     for (auto& child : m_children.Get()) {
         if (child) {
@@ -0,0 +1,167 @@
+#include "render/frameringbuffer.h"
+
+#include "app_exceptions.h"
+#include "graphics/opengl.h"
+
+#include <algorithm>
+#include <cstring>
+
+
+namespace {
+
+static const GLbitfield MAP_FLAGS { GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT };
+static const GLuint64 WAIT_TIMEOUT_NS { 1'000'000 };
+
+size_t AlignUp(size_t value, size_t alignment) {
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+size_t GetAlignment(GLenum name) {
+    GLint alignment {};
+    glGetIntegerv(name, &alignment);
+
+    return std::max<size_t>(static_cast<size_t>(alignment), FrameRingBuffer::DEFAULT_ALIGNMENT);
+}
+
+} // namespace
+
+
+FrameRingBuffer::Storage FrameRingBuffer::CreateStorage(size_t regionSize) {
+    Storage storage {};
+    storage.regionSize = regionSize;
+
+    const GLsizeiptr size = static_cast<GLsizeiptr>(regionSize * FRAMES_IN_FLIGHT);
+
+    glCreateBuffers(1, &storage.buffer);
+    glNamedBufferStorage(storage.buffer, size, nullptr, ::MAP_FLAGS);
+    storage.mapping = static_cast<uint8_t*>(glMapNamedBufferRange(storage.buffer, 0, size, ::MAP_FLAGS));
+
+    if (!storage.mapping) {
+        glDeleteBuffers(1, &storage.buffer);
+        throw OpenGLException { "Cannot map the frame ring buffer" };
+    }
+
+    return storage;
+}
+
+void FrameRingBuffer::DeleteStorage(Storage& storage) {
+    if (!storage.buffer) return;
+
+    glUnmapNamedBuffer(storage.buffer);
+    glDeleteBuffers(1, &storage.buffer);
+
+    if (OpenGL::HasState()) {
+        OpenGL::State().ForgetBuffer(storage.buffer);
+    }
+
+    storage = Storage {};
+}
+
+void FrameRingBuffer::Grow(size_t minRegionSize) {
+    m_regions[m_region].retired.push_back(m_storage);
+
+    m_storage = CreateStorage(std::max(m_storage.regionSize * 2, minRegionSize));
+    m_offset = 0;
+}
+
+void FrameRingBuffer::WaitForRegion(Region& region) {
+    if (region.fence) {
+        GLenum status { GL_TIMEOUT_EXPIRED };
+
+        while (status == GL_TIMEOUT_EXPIRED) {
+            status = glClientWaitSync(region.fence, GL_SYNC_FLUSH_COMMANDS_BIT, ::WAIT_TIMEOUT_NS);
+        }
+
+        glDeleteSync(region.fence);
+        region.fence = nullptr;
+
+        if (status == GL_WAIT_FAILED) {
+            throw OpenGLException { "Waiting for a frame ring buffer region failed" };
+        }
+    }
+
+    for (auto& storage : region.retired) {
+        DeleteStorage(storage);
+    }
+
+    region.retired.clear();
+}
+
+FrameRingBuffer::FrameRingBuffer() :
+    FrameRingBuffer { DEFAULT_REGION_SIZE } {}
+
+FrameRingBuffer::FrameRingBuffer(size_t regionSize) :
+    m_storage {},
+    m_regions {},
+    m_region {},
+    m_offset {},
+    m_uniformAlignment { ::GetAlignment(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT) },
+    m_storageAlignment { ::GetAlignment(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT) } {
+    m_storage = CreateStorage(::AlignUp(std::max(regionSize, DEFAULT_ALIGNMENT), m_uniformAlignment));
+}
+
+FrameRingBuffer::~FrameRingBuffer() {
+    // the GPU may still read every region
+    for (auto& region : m_regions) {
+        try {
+            WaitForRegion(region);
+        } catch (...) {
+            /* DUMMY */
+        }
+    }
+
+    DeleteStorage(m_storage);
+}
+
+FrameAllocation FrameRingBuffer::Allocate(size_t size, size_t alignment) {
+    size_t offset = ::AlignUp(m_offset, alignment);
+
+    if (offset + size > m_storage.regionSize) {
+        Grow(::AlignUp(size, m_uniformAlignment));
+        offset = 0;
+    }
+
+    m_offset = offset + size;
+
+    const size_t bufferOffset = m_region * m_storage.regionSize + offset;
+
+    FrameAllocation allocation {};
+    allocation.data = m_storage.mapping + bufferOffset;
+    allocation.buffer = m_storage.buffer;
+    allocation.offset = static_cast<GLintptr>(bufferOffset);
+    allocation.size = static_cast<GLsizeiptr>(size);
+
+    return allocation;
+}
+
+FrameAllocation FrameRingBuffer::Allocate(const void* data, size_t size, size_t alignment) {
+    FrameAllocation allocation = Allocate(size, alignment);
+    std::memcpy(allocation.data, data, size);
+
+    return allocation;
+}
+
+size_t FrameRingBuffer::GetUniformAlignment() const {
+    return m_uniformAlignment;
+}
+
+size_t FrameRingBuffer::GetStorageAlignment() const {
+    return m_storageAlignment;
+}
+
+size_t FrameRingBuffer::GetRegionSize() const {
+    return m_storage.regionSize;
+}
+
+size_t FrameRingBuffer::GetUsedSize() const {
+    return m_offset;
+}
+
+void FrameRingBuffer::Processing() {
+    m_regions[m_region].fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+    m_region = (m_region + 1) % FRAMES_IN_FLIGHT;
+    WaitForRegion(m_regions[m_region]);
+
+    m_offset = 0;
+}
@@ -0,0 +1,92 @@
+#include "render/frustum.h"
+
+#if defined(__SSE__) || defined(_M_X64)
+    #include <xmmintrin.h>
+    #define KOFE_FRUSTUM_SSE
+#endif
+
+
+Frustum::Frustum() :
+    m_planes {} {}
+
+Frustum::Frustum(const glm::mat4& viewProjection) :
+    m_planes {} {
+    const glm::mat4 rows = glm::transpose(viewProjection);
+
+    m_planes[0] = rows[3] + rows[0]; // left
+    m_planes[1] = rows[3] - rows[0]; // right
+    m_planes[2] = rows[3] + rows[1]; // bottom
+    m_planes[3] = rows[3] - rows[1]; // top
+    m_planes[4] = rows[3] + rows[2]; // near
+    m_planes[5] = rows[3] - rows[2]; // far
+
+    for (auto& plane : m_planes) {
+        plane = plane / glm::length(glm::vec3 { plane });
+    }
+}
+
+const std::array<glm::vec4, Frustum::PLANE_COUNT>& Frustum::GetPlanes() const {
+    return m_planes;
+}
+
+bool Frustum::TestSphere(const glm::vec4& sphere) const {
+    for (const auto& plane : m_planes) {
+        if (glm::dot(glm::vec3 { plane }, glm::vec3 { sphere }) + plane.w < -sphere.w) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool Frustum::TestAabb(const glm::vec3& min, const glm::vec3& max) const {
+    for (const auto& plane : m_planes) {
+        // the corner farthest along the plane normal
+        const glm::vec3 positive {
+            plane.x >= 0.0f ? max.x : min.x,
+            plane.y >= 0.0f ? max.y : min.y,
+            plane.z >= 0.0f ? max.z : min.z
+        };
+
+        if (glm::dot(glm::vec3 { plane }, positive) + plane.w < 0.0f) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void Frustum::TestSpheres(const float* x, const float* y, const float* z, const float* radius,
+                          size_t count, uint8_t* visible) const {
+    size_t i = 0;
+
+#ifdef KOFE_FRUSTUM_SSE
+    for (; i + 4 <= count; i += 4) {
+        const __m128 sphereX = _mm_loadu_ps(x + i);
+        const __m128 sphereY = _mm_loadu_ps(y + i);
+        const __m128 sphereZ = _mm_loadu_ps(z + i);
+        const __m128 negativeRadius = _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(radius + i));
+
+        __m128 inside = _mm_cmpeq_ps(negativeRadius, negativeRadius); // all bits set
+
+        for (const auto& plane : m_planes) {
+            __m128 distance = _mm_mul_ps(sphereX, _mm_set1_ps(plane.x));
+            distance = _mm_add_ps(distance, _mm_mul_ps(sphereY, _mm_set1_ps(plane.y)));
+            distance = _mm_add_ps(distance, _mm_mul_ps(sphereZ, _mm_set1_ps(plane.z)));
+            distance = _mm_add_ps(distance, _mm_set1_ps(plane.w));
+
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, negativeRadius));
+        }
+
+        const int mask = _mm_movemask_ps(inside);
+        visible[i + 0] = static_cast<uint8_t>(mask & 1);
+        visible[i + 1] = static_cast<uint8_t>((mask >> 1) & 1);
+        visible[i + 2] = static_cast<uint8_t>((mask >> 2) & 1);
+        visible[i + 3] = static_cast<uint8_t>((mask >> 3) & 1);
+    }
+#endif
+
+    for (; i < count; ++i) {
+        visible[i] = static_cast<uint8_t>(TestSphere(glm::vec4 { x[i], y[i], z[i], radius[i] }));
+    }
+}
@@ -0,0 +1,310 @@
+#include "render/geometrypool.h"
+
+#include "everywhere.h"
+#include "graphics/opengl.h"
+#include "mesh/mesh.h"
+
+#include <algorithm>
+#include <iterator>
+
+
+namespace {
+
+static const GLuint VERTEX_BINDING { 0 };
+static const GLuint INSTANCE_BINDING { 1 };
+static const GLuint MATERIAL_BINDING { 2 };
+static const GLuint INSTANCE_DIVISOR { 1 };
+static const size_t SHORT_INDEX_VERTICES { size_t { 1 } << 16 };
+
+} // namespace
+
+
+bool GeometryRange::IsValid() const {
+    return page != NO_PAGE;
+}
+
+
+GeometryPool::RangeAllocator::RangeAllocator(size_t capacity) :
+    m_freeRanges {} {
+    m_freeRanges.emplace(0, capacity);
+}
+
+size_t GeometryPool::RangeAllocator::Allocate(size_t size) {
+    for (auto it = m_freeRanges.begin(); it != m_freeRanges.end(); ++it) {
+        if (it->second < size) continue;
+
+        const size_t offset = it->first;
+        const size_t rest = it->second - size;
+
+        m_freeRanges.erase(it);
+        if (rest) {
+            m_freeRanges.emplace(offset + size, rest);
+        }
+
+        return offset;
+    }
+
+    return NO_SPACE;
+}
+
+void GeometryPool::RangeAllocator::Release(size_t offset, size_t size) {
+    auto next = m_freeRanges.lower_bound(offset);
+
+    if (next != m_freeRanges.end() && offset + size == next->first) {
+        size += next->second;
+        next = m_freeRanges.erase(next);
+    }
+
+    if (next != m_freeRanges.begin()) {
+        auto previous = std::prev(next);
+
+        if (previous->first + previous->second == offset) {
+            previous->second += size;
+            return;
+        }
+    }
+
+    m_freeRanges.emplace(offset, size);
+}
+
+
+size_t GeometryPool::GetVertexArray(const VertexFormat& format) {
+    for (size_t i = 0; i < m_vertexArrays.size(); ++i) {
+        if (m_vertexArrays[i].format == format) return i;
+    }
+
+    GLuint vao {};
+    glCreateVertexArrays(1, &vao);
+
+    format.SetAttribFormats(vao, ::VERTEX_BINDING);
+
+    // per-instance model matrix, one column per location
+    for (GLuint column = 0; column < 4; ++column) {
+        const GLuint location = static_cast<GLuint>(AttribIndex::INSTANCE_TRANSFORM) + column;
+
+        glVertexArrayAttribFormat(vao, location, 4, GL_FLOAT, GL_FALSE,
+                                  column * sizeof(glm::vec4));
+        glVertexArrayAttribBinding(vao, location, ::INSTANCE_BINDING);
+        glEnableVertexArrayAttrib(vao, location);
+    }
+
+    glVertexArrayBindingDivisor(vao, ::INSTANCE_BINDING, ::INSTANCE_DIVISOR);
+
+    // per-instance MaterialTable index, integer attribute
+    const GLuint materialLocation = static_cast<GLuint>(AttribIndex::INSTANCE_MATERIAL);
+
+    glVertexArrayAttribIFormat(vao, materialLocation, 1, GL_UNSIGNED_INT, 0);
+    glVertexArrayAttribBinding(vao, materialLocation, ::MATERIAL_BINDING);
+    glEnableVertexArrayAttrib(vao, materialLocation);
+
+    glVertexArrayBindingDivisor(vao, ::MATERIAL_BINDING, ::INSTANCE_DIVISOR);
+
+    m_vertexArrays.push_back(VertexArray { format, vao });
+    return m_vertexArrays.size() - 1;
+}
+
+size_t GeometryPool::AddPage(const VertexFormat& format, GLenum indexType,
+                             size_t vertexCount, size_t indexCount) {
+    // oversized meshes get a page of their own
+    vertexCount = std::max(vertexCount, PAGE_VERTICES);
+    indexCount = std::max(indexCount, PAGE_INDICES);
+
+    Page page { 0, 0, RangeAllocator { vertexCount }, RangeAllocator { indexCount },
+                GetVertexArray(format), indexType };
+
+    glCreateBuffers(1, &page.vertexBuffer);
+    glNamedBufferStorage(page.vertexBuffer, vertexCount * format.GetStride(),
+                         nullptr, GL_DYNAMIC_STORAGE_BIT);
+
+    glCreateBuffers(1, &page.indexBuffer);
+    glNamedBufferStorage(page.indexBuffer, indexCount * GetIndexSize(indexType),
+                         nullptr, GL_DYNAMIC_STORAGE_BIT);
+
+    m_pages.push_back(std::move(page));
+    return m_pages.size() - 1;
+}
+
+GeometryPool::GeometryPool() :
+    m_vertexArrays {},
+    m_pages {},
+    m_boundPage { GeometryRange::NO_PAGE },
+    m_nextRangeId {},
+    m_indirectBuffer {},
+    m_indirectOffset {} {}
+
+GeometryPool::~GeometryPool() {
+    const bool hasState = OpenGL::HasState();
+
+    for (auto& page : m_pages) {
+        glDeleteBuffers(1, &page.vertexBuffer);
+        glDeleteBuffers(1, &page.indexBuffer);
+
+        if (hasState) {
+            OpenGL::State().ForgetBuffer(page.indexBuffer);
+        }
+    }
+
+    for (auto& vertexArray : m_vertexArrays) {
+        glDeleteVertexArrays(1, &vertexArray.vao);
+
+        if (hasState) {
+            OpenGL::State().ForgetVertexArray(vertexArray.vao);
+        }
+    }
+
+    m_vertexArrays.clear();
+
+    m_pages.clear();
+}
+
+GLenum GeometryPool::ChooseIndexType(size_t vertexCount) {
+    return vertexCount <= ::SHORT_INDEX_VERTICES ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+}
+
+size_t GeometryPool::GetIndexSize(GLenum indexType) {
+    return indexType == GL_UNSIGNED_SHORT ? sizeof(GLushort) : sizeof(GLuint);
+}
+
+GeometryRange GeometryPool::Allocate(const std::vector<Vertex>& vertices,
+                                     const std::vector<GLuint>& indices) {
+    return Allocate(vertices.data(), vertices.size(), indices.data(), indices.size());
+}
+
+GeometryRange GeometryPool::Allocate(const Vertex* vertices, size_t vertexCount,
+                                     const GLuint* indices, size_t indexCount) {
+    return Allocate(vertices, vertexCount, VertexFormat::Full(), indices, indexCount);
+}
+
+GeometryRange GeometryPool::Allocate(const void* vertices, size_t vertexCount,
+                                     const VertexFormat& format,
+                                     const GLuint* indices, size_t indexCount) {
+    if (ChooseIndexType(vertexCount) == GL_UNSIGNED_INT) {
+        return Allocate(vertices, vertexCount, format, indices, GL_UNSIGNED_INT, indexCount);
+    }
+
+    const std::vector<GLushort> shortIndices(indices, indices + indexCount);
+    return Allocate(vertices, vertexCount, format, shortIndices.data(), GL_UNSIGNED_SHORT, indexCount);
+}
+
+GeometryRange GeometryPool::Allocate(const void* vertices, size_t vertexCount,
+                                     const VertexFormat& format,
+                                     const void* indices, GLenum indexType, size_t indexCount) {
+    GeometryRange range {};
+
+    if (!vertexCount || !indexCount) return range;
+
+    size_t vertexOffset { RangeAllocator::NO_SPACE };
+    size_t indexOffset { RangeAllocator::NO_SPACE };
+
+    for (size_t i = 0; i < m_pages.size(); ++i) {
+        if (m_vertexArrays[m_pages[i].vertexArray].format != format ||
+            m_pages[i].indexType != indexType) {
+            continue;
+        }
+
+        vertexOffset = m_pages[i].vertices.Allocate(vertexCount);
+        if (vertexOffset == RangeAllocator::NO_SPACE) continue;
+
+        indexOffset = m_pages[i].indices.Allocate(indexCount);
+        if (indexOffset == RangeAllocator::NO_SPACE) {
+            m_pages[i].vertices.Release(vertexOffset, vertexCount);
+            continue;
+        }
+
+        range.page = i;
+        break;
+    }
+
+    if (!range.IsValid()) {
+        range.page = AddPage(format, indexType, vertexCount, indexCount);
+        vertexOffset = m_pages[range.page].vertices.Allocate(vertexCount);
+        indexOffset = m_pages[range.page].indices.Allocate(indexCount);
+    }
+
+    const Page& page = m_pages[range.page];
+    const size_t stride = static_cast<size_t>(format.GetStride());
+
+    glNamedBufferSubData(page.vertexBuffer,
+                         static_cast<GLintptr>(vertexOffset * stride),
+                         static_cast<GLsizeiptr>(vertexCount * stride),
+                         vertices);
+    glNamedBufferSubData(page.indexBuffer,
+                         static_cast<GLintptr>(indexOffset * GetIndexSize(indexType)),
+                         static_cast<GLsizeiptr>(indexCount * GetIndexSize(indexType)),
+                         indices);
+
+    range.id = m_nextRangeId++;
+    range.baseVertex = static_cast<GLint>(vertexOffset);
+    range.vertexCount = static_cast<GLsizei>(vertexCount);
+    range.firstIndex = static_cast<GLuint>(indexOffset);
+    range.indexCount = static_cast<GLsizei>(indexCount);
+
+    return range;
+}
+
+void GeometryPool::Release(GeometryRange& range) {
+    if (!range.IsValid()) return;
+
+    Page& page = m_pages[range.page];
+    page.vertices.Release(static_cast<size_t>(range.baseVertex),
+                          static_cast<size_t>(range.vertexCount));
+    page.indices.Release(range.firstIndex, static_cast<size_t>(range.indexCount));
+
+    range = GeometryRange {};
+}
+
+size_t GeometryPool::GetPageCount() const {
+    return m_pages.size();
+}
+
+void GeometryPool::UploadInstances(const std::vector<glm::mat4>& transforms,
+                                   const std::vector<uint32_t>& materialIndices) {
+    if (transforms.empty()) return;
+
+    FrameRingBuffer& ring = Everywhere::Instance().Get<FrameRingBuffer>();
+
+    const FrameAllocation instances = ring.Allocate(
+        transforms.data(), transforms.size() * sizeof(glm::mat4), alignof(glm::mat4));
+    const FrameAllocation materials = ring.Allocate(
+        materialIndices.data(), materialIndices.size() * sizeof(uint32_t), alignof(uint32_t));
+
+    for (const auto& vertexArray : m_vertexArrays) {
+        glVertexArrayVertexBuffer(vertexArray.vao, ::INSTANCE_BINDING, instances.buffer,
+                                  instances.offset, sizeof(glm::mat4));
+        glVertexArrayVertexBuffer(vertexArray.vao, ::MATERIAL_BINDING, materials.buffer,
+                                  materials.offset, sizeof(uint32_t));
+    }
+}
+
+void GeometryPool::UploadCommands(const std::vector<DrawElementsIndirectCommand>& commands) {
+    if (commands.empty()) return;
+
+    const FrameAllocation allocation = Everywhere::Instance().Get<FrameRingBuffer>().Allocate(
+        commands.data(), commands.size() * sizeof(DrawElementsIndirectCommand),
+        alignof(DrawElementsIndirectCommand));
+
+    m_indirectBuffer = allocation.buffer;
+    m_indirectOffset = allocation.offset;
+}
+
+void GeometryPool::MultiDraw(size_t page, GLenum mode, size_t firstCommand, size_t commandCount) {
+    GLStateCache& state = OpenGL::State();
+    const VertexArray& vertexArray = m_vertexArrays[m_pages[page].vertexArray];
+
+    state.BindVertexArray(vertexArray.vao);
+    state.BindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_pages[page].indexBuffer);
+
+    if (m_boundPage != page) {
+        m_boundPage = page;
+        glVertexArrayVertexBuffer(vertexArray.vao, ::VERTEX_BINDING, m_pages[page].vertexBuffer,
+                                  0, vertexArray.format.GetStride());
+    }
+
+    state.BindBuffer(GL_DRAW_INDIRECT_BUFFER, m_indirectBuffer);
+
+    glMultiDrawElementsIndirect(
+        mode, m_pages[page].indexType,
+        reinterpret_cast<const void*>(
+            m_indirectOffset + firstCommand * sizeof(DrawElementsIndirectCommand)),
+        static_cast<GLsizei>(commandCount), 0);
+}
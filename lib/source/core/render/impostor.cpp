@@ -0,0 +1,253 @@
+#include "render/impostor.h"
+
+#include "everywhere.h"
+#include "mesh/mesh.h"
+#include "material/material.h"
+#include "object/modeldata.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <limits>
+#include <string>
+#include <vector>
+
+
+namespace {
+
+static const std::filesystem::path BAKE_VERTEX_PATH {
+    R"vert(./resources/shaders/impostor-bake.vert)vert"
+};
+
+static const std::filesystem::path BAKE_FRAGMENT_PATH {
+    R"frag(./resources/shaders/impostor-bake.frag)frag"
+};
+
+static const ShaderDefines INDEXED_TEXTURE_DEFINES {
+    { "INDEXED_TEXTURES", "1" },
+    { "MAX_TEXTURE_ARRAYS", std::to_string(TextureStorage::MAX_TEXTURE_ARRAYS) },
+};
+
+static constexpr GLenum ATLAS_FORMAT { GL_RGBA8 };
+static constexpr size_t ATLAS_TEXEL_BYTES { 4 };
+static constexpr size_t ATLAS_COUNT { 2 };
+static constexpr GLenum DEPTH_FORMAT { GL_DEPTH_COMPONENT24 };
+static constexpr GLenum DRAW_BUFFERS[] { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1 };
+static constexpr GLfloat CLEAR_COLOR[] { 0.0f, 0.0f, 0.0f, 0.0f };
+static constexpr GLfloat CLEAR_DEPTH { 1.0f };
+
+// past this the up of the frame camera turns from y to z
+static constexpr float POLE_COSINE { 0.999f };
+
+
+float SignNotZero(float value) {
+    return value < 0.0f ? -1.0f : 1.0f;
+}
+
+} // namespace
+
+
+Impostor::Impostor(const ModelData& modelData) :
+    m_albedo { CreateAtlas() },
+    m_normalDepth { CreateAtlas() },
+    m_sphere { modelData.GetBounds().center, modelData.GetBounds().radius } {
+    Bake(modelData);
+}
+
+Impostor::~Impostor() {
+    if (OpenGL::HasState()) {
+        OpenGL::State().ForgetTexture(m_albedo);
+        OpenGL::State().ForgetTexture(m_normalDepth);
+    }
+
+    glDeleteTextures(1, &m_albedo);
+    glDeleteTextures(1, &m_normalDepth);
+}
+
+GLuint Impostor::CreateAtlas() {
+    GLuint atlas {};
+
+    glCreateTextures(GL_TEXTURE_2D, 1, &atlas);
+    glTextureStorage2D(atlas, ATLAS_LEVELS, ::ATLAS_FORMAT, ATLAS_SIZE, ATLAS_SIZE);
+    glTextureParameteri(atlas, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTextureParameteri(atlas, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTextureParameteri(atlas, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTextureParameteri(atlas, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+    return atlas;
+}
+
+void Impostor::Bake(const ModelData& modelData) {
+    GeometryPool& pool = Everywhere::Instance().Get<GeometryPool>();
+    const MaterialStorage& materialStorage = Everywhere::Instance().Get<MaterialStorage>();
+    const bool isIndexed = Everywhere::Instance().Get<MaterialTable>().IsEnabled();
+
+    std::vector<const Mesh*> meshes {};
+
+    for (const auto& child : modelData.Children()) {
+        const Mesh* mesh = dynamic_cast<const Mesh*>(child.get());
+        if (!mesh || !mesh->GetGeometry().IsValid()) continue;
+        if (mesh->GetDrawingMode() != MeshDrawingMode::TRIANGLES) continue;
+
+        meshes.push_back(mesh);
+    }
+
+    if (meshes.empty()) return;
+
+    // one multi draw per page and frame
+    std::stable_sort(meshes.begin(), meshes.end(), [](const Mesh* a, const Mesh* b) {
+        return a->GetGeometry().page < b->GetGeometry().page;
+    });
+
+    std::vector<glm::mat4> transforms {};
+    std::vector<uint32_t> materialIndices {};
+    std::vector<DrawElementsIndirectCommand> commands {};
+
+    for (const Mesh* mesh : meshes) {
+        const GeometryRange& geometry = mesh->GetGeometry();
+        const glm::mat4 transform = mesh->GetTransform().ToMatrix();
+        auto material = materialStorage.GetMaterials()[mesh->GetMaterialId()];
+
+        transforms.push_back(mesh->GetVertexFormat().IsQuantized()
+                                 ? transform * mesh->GetDequantization()
+                                 : transform);
+        materialIndices.push_back(material ? material->GetTableIndex() : 0);
+
+        commands.push_back(DrawElementsIndirectCommand {
+            static_cast<GLuint>(geometry.indexCount),
+            1,
+            geometry.firstIndex,
+            geometry.baseVertex,
+            static_cast<GLuint>(commands.size()),
+        });
+    }
+
+    pool.UploadInstances(transforms, materialIndices);
+    pool.UploadCommands(commands);
+
+    GLuint framebuffer {};
+    GLuint depth {};
+
+    glCreateFramebuffers(1, &framebuffer);
+    glCreateRenderbuffers(1, &depth);
+    glNamedRenderbufferStorage(depth, ::DEPTH_FORMAT, ATLAS_SIZE, ATLAS_SIZE);
+
+    glNamedFramebufferTexture(framebuffer, GL_COLOR_ATTACHMENT0, m_albedo, 0);
+    glNamedFramebufferTexture(framebuffer, GL_COLOR_ATTACHMENT1, m_normalDepth, 0);
+    glNamedFramebufferRenderbuffer(framebuffer, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depth);
+    glNamedFramebufferDrawBuffers(framebuffer, 2, ::DRAW_BUFFERS);
+
+    if (glCheckNamedFramebufferStatus(framebuffer, GL_DRAW_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        glDeleteFramebuffers(1, &framebuffer);
+        glDeleteRenderbuffers(1, &depth);
+
+        throw OpenGLException { "Impostor framebuffer is incomplete" };
+    }
+
+    glClearNamedFramebufferfv(framebuffer, GL_COLOR, 0, ::CLEAR_COLOR);
+    glClearNamedFramebufferfv(framebuffer, GL_COLOR, 1, ::CLEAR_COLOR);
+    glClearNamedFramebufferfv(framebuffer, GL_DEPTH, 0, &::CLEAR_DEPTH);
+
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, framebuffer);
+
+    GLStateCache& state = OpenGL::State();
+    state.SetCapability(GL_DEPTH_TEST, true);
+    state.DepthMask(true);
+
+    auto shader = Everywhere::Instance().Get<ShaderStorage>().Get(
+        ::BAKE_VERTEX_PATH, ::BAKE_FRAGMENT_PATH, isIndexed ? ::INDEXED_TEXTURE_DEFINES : ShaderDefines {});
+
+    shader->Use();
+    shader->SetMat4("mvp.model", glm::mat4 { 1.0f });
+
+    if (isIndexed) {
+        for (size_t i = 0; i < TextureStorage::MAX_TEXTURE_ARRAYS; ++i) {
+            shader->SetInt("textureArrays[" + std::to_string(i) + "]",
+                           static_cast<GLint>(TextureStorage::FIRST_ARRAY_UNIT - GL_TEXTURE0 + i));
+        }
+
+        Everywhere::Instance().Get<TextureStorage>().BindArrays();
+        Everywhere::Instance().Get<MaterialTable>().Bind();
+    }
+
+    const glm::vec3 center { m_sphere };
+    const float radius = std::max(m_sphere.w, std::numeric_limits<float>::epsilon());
+
+    // the depth range spans the sphere, so the stored depth is its share of the diameter
+    shader->SetMat4("mvp.projection", glm::ortho(-radius, radius, -radius, radius, 0.0f, 2.0f * radius));
+
+    for (GLsizei y = 0; y < FRAMES; ++y) {
+        for (GLsizei x = 0; x < FRAMES; ++x) {
+            const glm::vec3 direction = GetFrameDirection(x, y);
+
+            glViewport(x * FRAME_SIZE, y * FRAME_SIZE, FRAME_SIZE, FRAME_SIZE);
+            shader->SetMat4("mvp.view", glm::lookAt(center + direction * radius, center, GetFrameUp(direction)));
+
+            for (size_t first = 0; first < meshes.size();) {
+                const size_t page = meshes[first]->GetGeometry().page;
+                size_t last = first;
+
+                while (last < meshes.size() && meshes[last]->GetGeometry().page == page) ++last;
+
+                pool.MultiDraw(page, GL_TRIANGLES, first, last - first);
+                first = last;
+            }
+        }
+    }
+
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+    glDeleteFramebuffers(1, &framebuffer);
+    glDeleteRenderbuffers(1, &depth);
+
+    glGenerateTextureMipmap(m_albedo);
+    glGenerateTextureMipmap(m_normalDepth);
+
+    Everywhere::Instance().Get<Graphics>().UpdateViewportSize();
+}
+
+glm::vec3 Impostor::GetFrameDirection(GLsizei x, GLsizei y) {
+    // the outer frames sit on the octahedron border, so the poles and the horizon are baked exactly
+    const glm::vec2 octahedron = glm::vec2 { x, y } / static_cast<float>(FRAMES - 1) * 2.0f - 1.0f;
+
+    glm::vec3 direction {
+        octahedron.x, 1.0f - std::abs(octahedron.x) - std::abs(octahedron.y), octahedron.y
+    };
+
+    // the lower half is folded out over the corners
+    if (direction.y < 0.0f) {
+        direction.x = (1.0f - std::abs(octahedron.y)) * ::SignNotZero(octahedron.x);
+        direction.z = (1.0f - std::abs(octahedron.x)) * ::SignNotZero(octahedron.y);
+    }
+
+    return glm::normalize(direction);
+}
+
+glm::vec3 Impostor::GetFrameUp(const glm::vec3& direction) {
+    return std::abs(direction.y) > ::POLE_COSINE ? glm::vec3 { 0.0f, 0.0f, -1.0f }
+                                                 : glm::vec3 { 0.0f, 1.0f, 0.0f };
+}
+
+size_t Impostor::GetAtlasBytes() {
+    size_t bytes { 0 };
+
+    for (GLsizei level = 0; level < ATLAS_LEVELS; ++level) {
+        const size_t size = static_cast<size_t>(std::max(1, ATLAS_SIZE >> level));
+        bytes += size * size * ::ATLAS_TEXEL_BYTES;
+    }
+
+    return bytes * ::ATLAS_COUNT;
+}
+
+GLuint Impostor::GetAlbedo() const {
+    return m_albedo;
+}
+
+GLuint Impostor::GetNormalDepth() const {
+    return m_normalDepth;
+}
+
+const glm::vec4& Impostor::GetSphere() const {
+    return m_sphere;
+}
@@ -0,0 +1,113 @@
+#include "render/lodselector.h"
+
+#include "everywhere.h"
+
+#include <algorithm>
+#include <cmath>
+
+
+LodSelector::LodSelector() :
+    m_cameraPosition {},
+    m_pixelScale {},
+    m_isPerspective { true },
+    m_depthNear {},
+    m_maxScreenError { DEFAULT_MAX_SCREEN_ERROR },
+    m_hysteresis { DEFAULT_HYSTERESIS },
+    m_bias {},
+    m_impostorScreenSize { DEFAULT_IMPOSTOR_SCREEN_SIZE } {}
+
+size_t LodSelector::Select(const std::vector<float>& lodErrors, const glm::vec4& sphere,
+                           float modelScale, size_t currentLod) const {
+    if (lodErrors.size() < 2) return 0;
+
+    const float pixelsPerUnit = GetPixelsPerUnit(glm::vec3 { sphere });
+    const float screenSize = 2.0f * sphere.w * pixelsPerUnit;
+
+    auto screenError = [&](size_t lodId) {
+        if (lodErrors[lodId] >= 0.0f) return lodErrors[lodId] * modelScale * pixelsPerUnit;
+
+        // taken below the size of its step, at the default threshold
+        return DEFAULT_MAX_SCREEN_ERROR * screenSize / FULL_DETAIL_SCREEN_SIZE *
+               std::exp2(static_cast<float>(lodId) - 1.0f);
+    };
+
+    auto coarsest = [&](float errorLimit) {
+        for (size_t lodId = lodErrors.size() - 1; lodId > 0; --lodId) {
+            if (screenError(lodId) <= errorLimit) return lodId;
+        }
+
+        return size_t { 0 };
+    };
+
+    const float errorLimit = m_maxScreenError * std::exp2(m_bias);
+    // a coarser LOD is entered below the lower limit, the current one is left above the upper
+    const size_t entered = coarsest(errorLimit * (1.0f - m_hysteresis));
+    const size_t kept = coarsest(errorLimit * (1.0f + m_hysteresis));
+
+    currentLod = std::min(currentLod, lodErrors.size() - 1);
+
+    if (currentLod < entered) return entered;
+    if (currentLod > kept) return kept;
+
+    return currentLod;
+}
+
+float LodSelector::GetPixelsPerUnit(const glm::vec3& position) const {
+    if (!m_isPerspective) return m_pixelScale;
+
+    return m_pixelScale / std::max(glm::distance(m_cameraPosition, position), m_depthNear);
+}
+
+bool LodSelector::WantsImpostor(const glm::vec4& sphere, bool isImpostor) const {
+    if (m_impostorScreenSize <= 0.0f) return false;
+
+    const float screenSize = 2.0f * sphere.w * GetPixelsPerUnit(glm::vec3 { sphere });
+    // a coarser bias keeps the impostor up to larger sizes
+    const float sizeLimit = m_impostorScreenSize * std::exp2(m_bias);
+
+    return screenSize < sizeLimit * (isImpostor ? 1.0f + m_hysteresis : 1.0f - m_hysteresis);
+}
+
+float LodSelector::GetBias() const {
+    return m_bias;
+}
+
+void LodSelector::SetBias(float bias) {
+    m_bias = bias;
+}
+
+float LodSelector::GetMaxScreenError() const {
+    return m_maxScreenError;
+}
+
+void LodSelector::SetMaxScreenError(float pixels) {
+    m_maxScreenError = std::max(pixels, 0.0f);
+}
+
+float LodSelector::GetHysteresis() const {
+    return m_hysteresis;
+}
+
+void LodSelector::SetHysteresis(float hysteresis) {
+    m_hysteresis = std::clamp(hysteresis, 0.0f, 0.9f);
+}
+
+float LodSelector::GetImpostorScreenSize() const {
+    return m_impostorScreenSize;
+}
+
+void LodSelector::SetImpostorScreenSize(float pixels) {
+    m_impostorScreenSize = std::max(pixels, 0.0f);
+}
+
+void LodSelector::Processing() {
+    const Projection& projection = Everywhere::Instance().Get<Projection>();
+    const float screenHeight = static_cast<float>(Everywhere::Instance().Get<Window>().GetScreen().GetHeight());
+    const glm::mat4 matrix = projection.ToMatrix();
+
+    m_cameraPosition = Everywhere::Instance().Get<Camera>().GetTransform().GetPosition();
+    // the FoV and the viewport height, or the height of an orthographic volume
+    m_pixelScale = matrix[1][1] * screenHeight * 0.5f;
+    m_isPerspective = matrix[3][3] == 0.0f;
+    m_depthNear = projection.GetDepthNear();
+}
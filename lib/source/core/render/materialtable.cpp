@@ -0,0 +1,81 @@
+#include "render/materialtable.h"
+
+#include "graphics/opengl.h"
+
+
+static_assert(sizeof(MaterialRecord) == 32, "MaterialRecord must match its std430 layout");
+
+
+MaterialTable::MaterialTable() :
+    MaterialTable { true } {}
+
+MaterialTable::MaterialTable(bool isEnabled) :
+    m_isEnabled { isEnabled },
+    m_records {},
+    m_freeIndices {},
+    m_ssbo {},
+    m_capacity {},
+    m_isDirty { false } {
+    glCreateBuffers(1, &m_ssbo);
+}
+
+MaterialTable::~MaterialTable() {
+    glDeleteBuffers(1, &m_ssbo);
+
+    if (OpenGL::HasState()) {
+        OpenGL::State().ForgetBuffer(m_ssbo);
+    }
+
+    m_records.clear();
+    m_freeIndices.clear();
+}
+
+bool MaterialTable::IsEnabled() const {
+    return m_isEnabled;
+}
+
+uint32_t MaterialTable::Add(const MaterialRecord& record) {
+    m_isDirty = true;
+
+    if (!m_freeIndices.empty()) {
+        const uint32_t index = m_freeIndices.back();
+        m_freeIndices.pop_back();
+
+        m_records[index] = record;
+        return index;
+    }
+
+    m_records.push_back(record);
+    return static_cast<uint32_t>(m_records.size() - 1);
+}
+
+void MaterialTable::Set(uint32_t index, const MaterialRecord& record) {
+    m_records.at(index) = record;
+    m_isDirty = true;
+}
+
+void MaterialTable::Release(uint32_t index) {
+    m_freeIndices.push_back(index);
+}
+
+size_t MaterialTable::Size() const {
+    return m_records.size();
+}
+
+void MaterialTable::Bind() {
+    if (m_isDirty && !m_records.empty()) {
+        const size_t size = m_records.size() * sizeof(MaterialRecord);
+
+        if (size > m_capacity) {
+            m_capacity = size;
+            glNamedBufferData(m_ssbo, static_cast<GLsizeiptr>(m_capacity),
+                              m_records.data(), GL_DYNAMIC_DRAW);
+        } else {
+            glNamedBufferSubData(m_ssbo, 0, static_cast<GLsizeiptr>(size), m_records.data());
+        }
+
+        m_isDirty = false;
+    }
+
+    OpenGL::State().BindBufferBase(GL_SHADER_STORAGE_BUFFER, MATERIALS_BINDING_POINT, m_ssbo);
+}
@@ -0,0 +1,244 @@
+#include "render/qualitygovernor.h"
+
+#include "everywhere.h"
+
+#include <algorithm>
+#include <iostream>
+
+
+namespace {
+
+static constexpr float MILLISECONDS { 1000.0f };
+static constexpr float NANOSECONDS { 1.0e-9f };
+
+static const QualitySettings HIGHEST_SETTINGS {
+    0.0f, 0, LightStorage::MAX_POINT_LIGHTS + LightStorage::MAX_SPOT_LIGHTS, true
+};
+
+static const QualitySettings LOWEST_SETTINGS { 2.0f, 2, 4, false };
+
+
+float Smooth(float value, float sample) {
+    // the first sample starts it
+    if (value <= 0.0f) return sample;
+
+    return value + (sample - value) * QualityGovernor::SMOOTHING;
+}
+
+} // namespace
+
+
+QualityGovernor::QualityGovernor() :
+    m_highest { ::HIGHEST_SETTINGS },
+    m_lowest { ::LOWEST_SETTINGS },
+    m_settings { ::HIGHEST_SETTINGS },
+    m_targetFrameTime { DEFAULT_TARGET_FRAME_TIME },
+    m_isEnabled { true },
+    m_frameBegin { Clock::now() },
+    m_cpuTime {},
+    m_gpuTime {},
+    m_queries {},
+    m_query {},
+    m_issuedQueries {},
+    m_overFrames {},
+    m_underFrames {},
+    m_settleFrames {} {
+    glGenQueries(static_cast<GLsizei>(m_queries.size()), m_queries.data());
+}
+
+QualityGovernor::~QualityGovernor() {
+    glDeleteQueries(static_cast<GLsizei>(m_queries.size()), m_queries.data());
+}
+
+void QualityGovernor::ReadGpuTime() {
+    if (m_issuedQueries < TIMER_QUERIES) return;
+
+    // the oldest one, the driver had the most frames to finish it
+    const GLuint query = m_queries[(m_query + 1) % TIMER_QUERIES];
+
+    GLint isAvailable {};
+    glGetQueryObjectiv(query, GL_QUERY_RESULT_AVAILABLE, &isAvailable);
+    if (!isAvailable) return;
+
+    GLuint64 elapsed {};
+    glGetQueryObjectui64v(query, GL_QUERY_RESULT, &elapsed);
+
+    m_gpuTime = ::Smooth(m_gpuTime, static_cast<float>(elapsed) * ::NANOSECONDS);
+}
+
+void QualityGovernor::Control() {
+    if (m_settleFrames) {
+        --m_settleFrames;
+        return;
+    }
+
+    const float load = std::max(m_cpuTime, m_gpuTime) / m_targetFrameTime;
+
+    m_overFrames = load > DEGRADE_LOAD ? m_overFrames + 1 : 0;
+    m_underFrames = load < UPGRADE_LOAD ? m_underFrames + 1 : 0;
+
+    bool isAdjusted { false };
+
+    if (m_overFrames >= DEGRADE_FRAMES) {
+        isAdjusted = Degrade();
+    } else if (m_underFrames >= UPGRADE_FRAMES) {
+        isAdjusted = Upgrade();
+    }
+
+    if (isAdjusted) {
+        Apply();
+
+        m_overFrames = 0;
+        m_underFrames = 0;
+        m_settleFrames = SETTLE_FRAMES;
+    }
+}
+
+bool QualityGovernor::Degrade() {
+    QualitySettings& settings = m_settings;
+
+    if (settings.lodBias < m_lowest.lodBias) {
+        const float lodBias = std::min(settings.lodBias + LOD_BIAS_STEP, m_lowest.lodBias);
+        Log("LOD bias", settings.lodBias, lodBias);
+        settings.lodBias = lodBias;
+        return true;
+    }
+
+    if (settings.textureMipBias < m_lowest.textureMipBias) {
+        Log("texture mip bias", static_cast<float>(settings.textureMipBias),
+            static_cast<float>(settings.textureMipBias + 1));
+        ++settings.textureMipBias;
+        return true;
+    }
+
+    if (settings.maxActiveLights > m_lowest.maxActiveLights) {
+        const size_t lights = settings.maxActiveLights > m_lowest.maxActiveLights + LIGHTS_STEP
+            ? settings.maxActiveLights - LIGHTS_STEP
+            : m_lowest.maxActiveLights;
+        Log("max active lights", static_cast<float>(settings.maxActiveLights), static_cast<float>(lights));
+        settings.maxActiveLights = lights;
+        return true;
+    }
+
+    if (settings.antialiasing && !m_lowest.antialiasing) {
+        Log("antialiasing", 1.0f, 0.0f);
+        settings.antialiasing = false;
+        return true;
+    }
+
+    return false;
+}
+
+bool QualityGovernor::Upgrade() {
+    QualitySettings& settings = m_settings;
+
+    if (!settings.antialiasing && m_highest.antialiasing) {
+        Log("antialiasing", 0.0f, 1.0f);
+        settings.antialiasing = true;
+        return true;
+    }
+
+    if (settings.maxActiveLights < m_highest.maxActiveLights) {
+        const size_t lights = std::min(settings.maxActiveLights + LIGHTS_STEP, m_highest.maxActiveLights);
+        Log("max active lights", static_cast<float>(settings.maxActiveLights), static_cast<float>(lights));
+        settings.maxActiveLights = lights;
+        return true;
+    }
+
+    if (settings.textureMipBias > m_highest.textureMipBias) {
+        Log("texture mip bias", static_cast<float>(settings.textureMipBias),
+            static_cast<float>(settings.textureMipBias - 1));
+        --settings.textureMipBias;
+        return true;
+    }
+
+    if (settings.lodBias > m_highest.lodBias) {
+        const float lodBias = std::max(settings.lodBias - LOD_BIAS_STEP, m_highest.lodBias);
+        Log("LOD bias", settings.lodBias, lodBias);
+        settings.lodBias = lodBias;
+        return true;
+    }
+
+    return false;
+}
+
+void QualityGovernor::Apply() const {
+    Everywhere::Instance().Get<LodSelector>().SetBias(m_settings.lodBias);
+    Everywhere::Instance().Get<TextureStorage>().SetMipBias(m_settings.textureMipBias);
+    Everywhere::Instance().Get<LightStorage>().SetMaxActiveLights(m_settings.maxActiveLights);
+    Everywhere::Instance().Get<Graphics>().SetAntialiasing(m_settings.antialiasing);
+}
+
+void QualityGovernor::Log(const char* knob, float from, float to) const {
+    std::clog << "quality: " << knob << ' ' << from << " -> " << to
+              << " (cpu " << m_cpuTime * ::MILLISECONDS << " ms, gpu " << m_gpuTime * ::MILLISECONDS
+              << " ms, target " << m_targetFrameTime * ::MILLISECONDS << " ms)" << std::endl;
+}
+
+void QualityGovernor::BeginFrame() {
+    m_frameBegin = Clock::now();
+    glBeginQuery(GL_TIME_ELAPSED, m_queries[m_query]);
+}
+
+float QualityGovernor::GetTargetFrameTime() const {
+    return m_targetFrameTime;
+}
+
+void QualityGovernor::SetTargetFrameTime(float seconds) {
+    if (seconds > 0.0f) {
+        m_targetFrameTime = seconds;
+    }
+}
+
+void QualityGovernor::SetBounds(const QualitySettings& highest, const QualitySettings& lowest) {
+    m_highest = highest;
+    m_lowest = lowest;
+
+    m_settings.lodBias = std::clamp(m_settings.lodBias, highest.lodBias, lowest.lodBias);
+    m_settings.textureMipBias = std::clamp(m_settings.textureMipBias,
+                                           highest.textureMipBias, lowest.textureMipBias);
+    m_settings.maxActiveLights = std::clamp(m_settings.maxActiveLights,
+                                            lowest.maxActiveLights, highest.maxActiveLights);
+    m_settings.antialiasing = (m_settings.antialiasing && highest.antialiasing) || lowest.antialiasing;
+
+    Apply();
+}
+
+const QualitySettings& QualityGovernor::GetSettings() const {
+    return m_settings;
+}
+
+bool QualityGovernor::IsEnabled() const {
+    return m_isEnabled;
+}
+
+void QualityGovernor::SetEnabled(bool isEnabled) {
+    m_isEnabled = isEnabled;
+
+    m_overFrames = 0;
+    m_underFrames = 0;
+}
+
+float QualityGovernor::GetCpuTime() const {
+    return m_cpuTime;
+}
+
+float QualityGovernor::GetGpuTime() const {
+    return m_gpuTime;
+}
+
+void QualityGovernor::Processing() {
+    glEndQuery(GL_TIME_ELAPSED);
+    ++m_issuedQueries;
+
+    const std::chrono::duration<float> cpuTime { Clock::now() - m_frameBegin };
+    m_cpuTime = ::Smooth(m_cpuTime, cpuTime.count());
+
+    ReadGpuTime();
+
+    if (m_isEnabled) {
+        Control();
+    }
+
+    m_query = (m_query + 1) % TIMER_QUERIES;
+}
@@ -0,0 +1,331 @@
+#include "render/renderqueue.h"
+
+#include "everywhere.h"
+#include "mesh/mesh.h"
+#include "material/material.h"
+
+#include <algorithm>
+#include <array>
+
+
+namespace {
+
+static constexpr uint64_t OPAQUE_LAYER { 0 };
+static constexpr uint32_t GEOMETRY_PAGE_BITS { 4 };
+static constexpr uint32_t GEOMETRY_ID_BITS { RenderQueue::GEOMETRY_BITS - GEOMETRY_PAGE_BITS };
+
+static constexpr size_t RADIX_BITS { 8 };
+static constexpr size_t RADIX_SIZE { size_t { 1 } << RADIX_BITS };
+static constexpr size_t RADIX_MASK { RADIX_SIZE - 1 };
+static constexpr size_t RADIX_PASSES { 64 / RADIX_BITS };
+
+constexpr uint64_t FieldMask(uint32_t bits) {
+    return (uint64_t { 1 } << bits) - 1;
+}
+
+// LSD radix sort by 64-bit key, stable, skips passes where all digits match
+template <typename T>
+void RadixSort(std::vector<T>& items, std::vector<T>& scratch) {
+    if (items.size() < 2) return;
+
+    scratch.resize(items.size());
+
+    for (size_t pass = 0; pass < ::RADIX_PASSES; ++pass) {
+        const size_t shift = pass * ::RADIX_BITS;
+
+        std::array<size_t, ::RADIX_SIZE> offsets {};
+        for (const auto& item : items) {
+            ++offsets[(item.key >> shift) & ::RADIX_MASK];
+        }
+
+        if (offsets[(items.front().key >> shift) & ::RADIX_MASK] == items.size()) continue;
+
+        size_t offset = 0;
+        for (auto& count : offsets) {
+            const size_t digitCount = count;
+            count = offset;
+            offset += digitCount;
+        }
+
+        for (const auto& item : items) {
+            scratch[offsets[(item.key >> shift) & ::RADIX_MASK]++] = item;
+        }
+
+        items.swap(scratch);
+    }
+}
+
+} // namespace
+
+
+static_assert(RenderQueue::LAYER_BITS + RenderQueue::PROGRAM_BITS +
+              RenderQueue::MATERIAL_BITS + RenderQueue::GEOMETRY_BITS +
+              RenderQueue::DEPTH_BITS == 64, "Sort key must use 64 bits");
+
+
+RenderQueue::RenderQueue() :
+    m_packets {},
+    m_sortItems {},
+    m_sortScratch {},
+    m_instanceTransforms {},
+    m_instanceMaterials {},
+    m_commands {},
+    m_batches {},
+    m_frustum {},
+    m_cullX {}, m_cullY {}, m_cullZ {}, m_cullRadius {},
+    m_visible {},
+    m_cullingStats {},
+    m_materialScreenSizes {},
+    m_drawCallCount {} {}
+
+RenderQueue::~RenderQueue() {
+    m_packets.clear();
+    m_sortItems.clear();
+    m_sortScratch.clear();
+    m_instanceTransforms.clear();
+    m_instanceMaterials.clear();
+    m_commands.clear();
+    m_batches.clear();
+}
+
+uint64_t RenderQueue::MakeSortKey(const DrawPacket& packet, float depthFar) {
+    const float normalizedDepth = std::clamp(packet.viewDepth / depthFar, 0.0f, 1.0f);
+    const uint64_t depth =
+        static_cast<uint64_t>(normalizedDepth * static_cast<float>(::FieldMask(DEPTH_BITS)));
+
+    uint64_t key { ::OPAQUE_LAYER };
+    key = (key << PROGRAM_BITS) | (packet.program & ::FieldMask(PROGRAM_BITS));
+    key = (key << MATERIAL_BITS) | (packet.materialId & ::FieldMask(MATERIAL_BITS));
+    key = (key << GEOMETRY_BITS) | (packet.geometry & ::FieldMask(GEOMETRY_BITS));
+    key = (key << DEPTH_BITS) | depth;
+
+    return key;
+}
+
+void RenderQueue::BeginFrame() {
+    const glm::mat4 projection = Everywhere::Instance().Get<Projection>().ToMatrix();
+    const glm::mat4 view = Everywhere::Instance().Get<Camera>().ToMatrix();
+
+    m_frustum = Frustum { projection * view };
+    m_cullingStats = CullingStats {};
+}
+
+bool RenderQueue::IsVisible(const Bounds& bounds, const glm::mat4& transform) {
+    if (bounds.IsEmpty()) return true;
+
+    ++m_cullingStats.testedObjects;
+
+    if (!m_frustum.TestSphere(bounds.ToSphere(transform))) {
+        ++m_cullingStats.culledObjects;
+        return false;
+    }
+
+    return true;
+}
+
+void RenderQueue::Add(Mesh& mesh, const glm::mat4& transform) {
+    auto material =
+        Everywhere::Instance().Get<MaterialStorage>().GetMaterials()[mesh.GetMaterialId()];
+
+    const GeometryRange& geometry = mesh.GetGeometry();
+
+    if (!material || !geometry.IsValid()) return;
+
+    DrawPacket packet {};
+    packet.mesh = &mesh;
+    packet.material = material.get();
+    packet.materialId = mesh.GetMaterialId();
+    packet.program = material->GetShader()->GetProgram();
+    packet.geometry = static_cast<uint32_t>(
+        ((geometry.page & ::FieldMask(::GEOMETRY_PAGE_BITS)) << ::GEOMETRY_ID_BITS) |
+        (geometry.id & ::FieldMask(::GEOMETRY_ID_BITS)));
+    packet.drawingMode = static_cast<GLenum>(mesh.GetDrawingMode());
+    packet.transform = transform;
+    packet.sphere = mesh.GetBounds().ToSphere(transform);
+
+    m_packets.push_back(packet);
+}
+
+void RenderQueue::Cull() {
+    const size_t count = m_packets.size();
+
+    m_cullX.resize(count);
+    m_cullY.resize(count);
+    m_cullZ.resize(count);
+    m_cullRadius.resize(count);
+    m_visible.resize(count);
+
+    for (size_t i = 0; i < count; ++i) {
+        const glm::vec4& sphere = m_packets[i].sphere;
+
+        m_cullX[i] = sphere.x;
+        m_cullY[i] = sphere.y;
+        m_cullZ[i] = sphere.z;
+        m_cullRadius[i] = sphere.w;
+    }
+
+    m_frustum.TestSpheres(m_cullX.data(), m_cullY.data(), m_cullZ.data(), m_cullRadius.data(),
+                          count, m_visible.data());
+
+    size_t visibleCount = 0;
+    for (size_t i = 0; i < count; ++i) {
+        if (!m_visible[i]) continue;
+
+        if (visibleCount != i) {
+            m_packets[visibleCount] = m_packets[i];
+        }
+
+        ++visibleCount;
+    }
+
+    m_packets.resize(visibleCount);
+
+    m_cullingStats.testedPackets = count;
+    m_cullingStats.culledPackets = count - visibleCount;
+}
+
+void RenderQueue::RequestTextures() {
+    const Projection& projection = Everywhere::Instance().Get<Projection>();
+    const glm::vec3 cameraPosition = Everywhere::Instance().Get<Camera>().GetTransform().GetPosition();
+    const float screenHeight = static_cast<float>(Everywhere::Instance().Get<Window>().GetScreen().GetHeight());
+
+    // pixels per world unit at distance one
+    const float pixelScale = projection.ToMatrix()[1][1] * screenHeight * 0.5f;
+    const float depthNear = projection.GetDepthNear();
+
+    m_materialScreenSizes.assign(m_materialScreenSizes.size(), 0.0f);
+
+    for (const DrawPacket& packet : m_packets) {
+        const float distance = std::max(glm::distance(cameraPosition, glm::vec3 { packet.sphere }), depthNear);
+        const float screenSize = 2.0f * packet.sphere.w * pixelScale / distance;
+
+        if (packet.materialId >= m_materialScreenSizes.size()) {
+            m_materialScreenSizes.resize(packet.materialId + 1, 0.0f);
+        }
+
+        m_materialScreenSizes[packet.materialId] = std::max(m_materialScreenSizes[packet.materialId], screenSize);
+    }
+
+    for (const DrawPacket& packet : m_packets) {
+        float& screenSize = m_materialScreenSizes[packet.materialId];
+        if (screenSize <= 0.0f) continue;
+
+        packet.material->RequestTextureResidency(screenSize);
+        screenSize = 0.0f; // once per material
+    }
+}
+
+void RenderQueue::BuildSortKeys() {
+    const glm::mat4 view = Everywhere::Instance().Get<Camera>().ToMatrix();
+    const float depthFar = Everywhere::Instance().Get<Projection>().GetDepthFar();
+
+    m_sortItems.resize(m_packets.size());
+
+    for (size_t i = 0; i < m_packets.size(); ++i) {
+        DrawPacket& packet = m_packets[i];
+
+        packet.viewDepth = -(view * packet.transform[3]).z;
+        packet.key = MakeSortKey(packet, depthFar);
+
+        m_sortItems[i] = SortItem { packet.key, static_cast<uint32_t>(i) };
+    }
+}
+
+void RenderQueue::Sort() {
+    BuildSortKeys();
+    ::RadixSort(m_sortItems, m_sortScratch);
+}
+
+void RenderQueue::BuildCommands() {
+    m_instanceTransforms.clear();
+    m_instanceMaterials.clear();
+    m_commands.clear();
+    m_batches.clear();
+
+    for (size_t first = 0; first < m_sortItems.size();) {
+        const DrawPacket& packet = m_packets[m_sortItems[first].index];
+        const GeometryRange& geometry = packet.mesh->GetGeometry();
+
+        // consecutive packets of one mesh and material become one command
+        const size_t baseInstance = m_instanceTransforms.size();
+        size_t last = first;
+
+        while (last < m_sortItems.size()) {
+            const DrawPacket& other = m_packets[m_sortItems[last].index];
+            if (other.mesh != packet.mesh || other.material != packet.material) break;
+
+            m_instanceTransforms.push_back(other.mesh->GetVertexFormat().IsQuantized()
+                                               ? other.transform * other.mesh->GetDequantization()
+                                               : other.transform);
+            m_instanceMaterials.push_back(other.material->GetTableIndex());
+            ++last;
+        }
+
+        // consecutive commands of one material, page and mode become one call
+        if (m_batches.empty() ||
+            m_batches.back().material->GetBatchKey() != packet.material->GetBatchKey() ||
+            m_batches.back().page != geometry.page ||
+            m_batches.back().drawingMode != packet.drawingMode) {
+            m_batches.push_back(Batch { packet.material, geometry.page, packet.drawingMode,
+                                        m_commands.size(), 0 });
+        }
+
+        m_commands.push_back(DrawElementsIndirectCommand {
+            static_cast<GLuint>(geometry.indexCount),
+            static_cast<GLuint>(last - first),
+            geometry.firstIndex,
+            geometry.baseVertex,
+            static_cast<GLuint>(baseInstance),
+        });
+        ++m_batches.back().commandCount;
+
+        first = last;
+    }
+}
+
+void RenderQueue::Submit() {
+    m_drawCallCount = 0;
+
+    GeometryPool& pool = Everywhere::Instance().Get<GeometryPool>();
+    pool.UploadInstances(m_instanceTransforms, m_instanceMaterials);
+    pool.UploadCommands(m_commands);
+
+    const void* currentBatchKey { nullptr };
+
+    for (const auto& batch : m_batches) {
+        if (batch.material->GetBatchKey() != currentBatchKey) {
+            currentBatchKey = batch.material->GetBatchKey();
+            batch.material->Processing();
+        }
+
+        pool.MultiDraw(batch.page, batch.drawingMode, batch.firstCommand, batch.commandCount);
+        ++m_drawCallCount;
+    }
+}
+
+const Frustum& RenderQueue::GetFrustum() const {
+    return m_frustum;
+}
+
+size_t RenderQueue::GetPacketCount() const {
+    return m_packets.size();
+}
+
+size_t RenderQueue::GetDrawCallCount() const {
+    return m_drawCallCount;
+}
+
+const CullingStats& RenderQueue::GetCullingStats() const {
+    return m_cullingStats;
+}
+
+void RenderQueue::Processing() {
+    Cull();
+    RequestTextures();
+    Sort();
+    BuildCommands();
+    Submit();
+
+    m_packets.clear();
+    m_sortItems.clear();
+}
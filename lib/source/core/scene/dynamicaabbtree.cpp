@@ -0,0 +1,472 @@
+#include "scene/dynamicaabbtree.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+
+
+namespace {
+
+static constexpr size_t SAH_BINS { 12 };
+
+float Area(const glm::vec3& min, const glm::vec3& max) {
+    const glm::vec3 size = max - min;
+    return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+}
+
+float UnionArea(const glm::vec3& minA, const glm::vec3& maxA,
+                const glm::vec3& minB, const glm::vec3& maxB) {
+    return Area(glm::min(minA, minB), glm::max(maxA, maxB));
+}
+
+bool Contains(const glm::vec3& outerMin, const glm::vec3& outerMax,
+              const glm::vec3& innerMin, const glm::vec3& innerMax) {
+    return outerMin.x <= innerMin.x && outerMin.y <= innerMin.y && outerMin.z <= innerMin.z &&
+           innerMax.x <= outerMax.x && innerMax.y <= outerMax.y && innerMax.z <= outerMax.z;
+}
+
+} // namespace
+
+
+bool DynamicAABBTree::Node::IsLeaf() const {
+    return left == NULL_NODE;
+}
+
+DynamicAABBTree::DynamicAABBTree() :
+    m_nodes {},
+    m_root { NULL_NODE },
+    m_freeList { NULL_NODE },
+    m_leafCount {},
+    m_changeCount {},
+    m_stack {} {}
+
+int DynamicAABBTree::AllocateNode() {
+    if (m_freeList == NULL_NODE) {
+        m_nodes.push_back(Node {});
+        m_nodes.back().parent = m_freeList;
+        m_freeList = static_cast<int>(m_nodes.size() - 1);
+    }
+
+    const int node = m_freeList;
+    m_freeList = m_nodes[node].parent;
+
+    m_nodes[node] = Node { glm::vec3 {}, glm::vec3 {}, nullptr,
+                           NULL_NODE, NULL_NODE, NULL_NODE, 0 };
+
+    return node;
+}
+
+void DynamicAABBTree::FreeNode(int node) {
+    m_nodes[node].parent = m_freeList;
+    m_nodes[node].height = -1;
+    m_freeList = node;
+}
+
+void DynamicAABBTree::InsertLeaf(int leaf) {
+    if (m_root == NULL_NODE) {
+        m_root = leaf;
+        m_nodes[leaf].parent = NULL_NODE;
+        return;
+    }
+
+    const glm::vec3 leafMin = m_nodes[leaf].min;
+    const glm::vec3 leafMax = m_nodes[leaf].max;
+
+    // descend while pushing the leaf down is cheaper than pairing it here
+    int index = m_root;
+    while (!m_nodes[index].IsLeaf()) {
+        const Node& node = m_nodes[index];
+
+        const float area = ::Area(node.min, node.max);
+        const float combinedArea = ::UnionArea(node.min, node.max, leafMin, leafMax);
+
+        const float cost = 2.0f * combinedArea;
+        const float inheritanceCost = 2.0f * (combinedArea - area);
+
+        auto childCost = [&](int child) {
+            const Node& childNode = m_nodes[child];
+            const float unionArea = ::UnionArea(childNode.min, childNode.max, leafMin, leafMax);
+
+            return childNode.IsLeaf()
+                ? unionArea + inheritanceCost
+                : unionArea - ::Area(childNode.min, childNode.max) + inheritanceCost;
+        };
+
+        const float leftCost = childCost(node.left);
+        const float rightCost = childCost(node.right);
+
+        if (cost < leftCost && cost < rightCost) break;
+
+        index = leftCost < rightCost ? node.left : node.right;
+    }
+
+    const int sibling = index;
+    const int oldParent = m_nodes[sibling].parent;
+    const int newParent = AllocateNode();
+
+    m_nodes[newParent].parent = oldParent;
+    m_nodes[newParent].min = glm::min(leafMin, m_nodes[sibling].min);
+    m_nodes[newParent].max = glm::max(leafMax, m_nodes[sibling].max);
+    m_nodes[newParent].height = m_nodes[sibling].height + 1;
+    m_nodes[newParent].left = sibling;
+    m_nodes[newParent].right = leaf;
+
+    if (oldParent != NULL_NODE) {
+        if (m_nodes[oldParent].left == sibling) {
+            m_nodes[oldParent].left = newParent;
+        } else {
+            m_nodes[oldParent].right = newParent;
+        }
+    } else {
+        m_root = newParent;
+    }
+
+    m_nodes[sibling].parent = newParent;
+    m_nodes[leaf].parent = newParent;
+
+    RefitUpwards(m_nodes[leaf].parent);
+}
+
+void DynamicAABBTree::RemoveLeaf(int leaf) {
+    if (leaf == m_root) {
+        m_root = NULL_NODE;
+        return;
+    }
+
+    const int parent = m_nodes[leaf].parent;
+    const int grandParent = m_nodes[parent].parent;
+    const int sibling = m_nodes[parent].left == leaf ? m_nodes[parent].right : m_nodes[parent].left;
+
+    if (grandParent != NULL_NODE) {
+        if (m_nodes[grandParent].left == parent) {
+            m_nodes[grandParent].left = sibling;
+        } else {
+            m_nodes[grandParent].right = sibling;
+        }
+
+        m_nodes[sibling].parent = grandParent;
+        FreeNode(parent);
+
+        RefitUpwards(grandParent);
+    } else {
+        m_root = sibling;
+        m_nodes[sibling].parent = NULL_NODE;
+        FreeNode(parent);
+    }
+}
+
+void DynamicAABBTree::RefitUpwards(int node) {
+    while (node != NULL_NODE) {
+        node = Balance(node);
+
+        const int left = m_nodes[node].left;
+        const int right = m_nodes[node].right;
+
+        m_nodes[node].height = 1 + std::max(m_nodes[left].height, m_nodes[right].height);
+        m_nodes[node].min = glm::min(m_nodes[left].min, m_nodes[right].min);
+        m_nodes[node].max = glm::max(m_nodes[left].max, m_nodes[right].max);
+
+        node = m_nodes[node].parent;
+    }
+}
+
+int DynamicAABBTree::Balance(int iA) {
+    Node& a = m_nodes[iA];
+    if (a.IsLeaf() || a.height < 2) return iA;
+
+    const int iB = a.left;
+    const int iC = a.right;
+    Node& b = m_nodes[iB];
+    Node& c = m_nodes[iC];
+
+    const int balance = c.height - b.height;
+
+    // rotate the taller child up
+    auto rotateUp = [&](int iUp, Node& up, Node& stay, bool upIsRight) {
+        const int iF = up.left;
+        const int iG = up.right;
+        Node& f = m_nodes[iF];
+        Node& g = m_nodes[iG];
+
+        up.left = iA;
+        up.parent = a.parent;
+        a.parent = iUp;
+
+        if (up.parent != NULL_NODE) {
+            if (m_nodes[up.parent].left == iA) {
+                m_nodes[up.parent].left = iUp;
+            } else {
+                m_nodes[up.parent].right = iUp;
+            }
+        } else {
+            m_root = iUp;
+        }
+
+        const bool keepF = f.height > g.height;
+        const int iKeep = keepF ? iF : iG;
+        const int iMove = keepF ? iG : iF;
+        Node& keep = m_nodes[iKeep];
+        Node& move = m_nodes[iMove];
+
+        up.right = iKeep;
+        if (upIsRight) {
+            a.right = iMove;
+        } else {
+            a.left = iMove;
+        }
+        move.parent = iA;
+
+        a.min = glm::min(stay.min, move.min);
+        a.max = glm::max(stay.max, move.max);
+        up.min = glm::min(a.min, keep.min);
+        up.max = glm::max(a.max, keep.max);
+
+        a.height = 1 + std::max(stay.height, move.height);
+        up.height = 1 + std::max(a.height, keep.height);
+
+        return iUp;
+    };
+
+    if (balance > 1) {
+        return rotateUp(iC, c, b, true);
+    }
+
+    if (balance < -1) {
+        return rotateUp(iB, b, c, false);
+    }
+
+    return iA;
+}
+
+int DynamicAABBTree::BuildRange(std::vector<int>& leaves, size_t begin, size_t end) {
+    if (end - begin == 1) {
+        return leaves[begin];
+    }
+
+    glm::vec3 centroidMin { std::numeric_limits<float>::max() };
+    glm::vec3 centroidMax { std::numeric_limits<float>::lowest() };
+
+    for (size_t i = begin; i < end; ++i) {
+        const glm::vec3 centroid = (m_nodes[leaves[i]].min + m_nodes[leaves[i]].max) * 0.5f;
+        centroidMin = glm::min(centroidMin, centroid);
+        centroidMax = glm::max(centroidMax, centroid);
+    }
+
+    const glm::vec3 extent = centroidMax - centroidMin;
+    int axis = 0;
+    if (extent.y > extent[axis]) axis = 1;
+    if (extent.z > extent[axis]) axis = 2;
+
+    size_t middle = begin + (end - begin) / 2;
+
+    if (extent[axis] > 0.0f) {
+        struct Bin {
+            glm::vec3 min { std::numeric_limits<float>::max() };
+            glm::vec3 max { std::numeric_limits<float>::lowest() };
+            size_t count {};
+        };
+
+        std::array<Bin, ::SAH_BINS> bins {};
+        const float scale = static_cast<float>(::SAH_BINS) / extent[axis];
+
+        auto binOf = [&](int leaf) {
+            const float centroid = (m_nodes[leaf].min[axis] + m_nodes[leaf].max[axis]) * 0.5f;
+            const size_t bin = static_cast<size_t>((centroid - centroidMin[axis]) * scale);
+            return std::min(bin, ::SAH_BINS - 1);
+        };
+
+        for (size_t i = begin; i < end; ++i) {
+            Bin& bin = bins[binOf(leaves[i])];
+            bin.min = glm::min(bin.min, m_nodes[leaves[i]].min);
+            bin.max = glm::max(bin.max, m_nodes[leaves[i]].max);
+            ++bin.count;
+        }
+
+        // cost of splitting after each bin, swept from both sides
+        std::array<float, ::SAH_BINS - 1> leftCosts {};
+        Bin sweep {};
+        for (size_t i = 0; i + 1 < ::SAH_BINS; ++i) {
+            sweep.min = glm::min(sweep.min, bins[i].min);
+            sweep.max = glm::max(sweep.max, bins[i].max);
+            sweep.count += bins[i].count;
+            leftCosts[i] = sweep.count ? sweep.count * ::Area(sweep.min, sweep.max) : 0.0f;
+        }
+
+        float bestCost { std::numeric_limits<float>::max() };
+        size_t bestSplit { 0 };
+
+        sweep = Bin {};
+        for (size_t i = ::SAH_BINS - 1; i > 0; --i) {
+            sweep.min = glm::min(sweep.min, bins[i].min);
+            sweep.max = glm::max(sweep.max, bins[i].max);
+            sweep.count += bins[i].count;
+
+            const float cost = leftCosts[i - 1] +
+                (sweep.count ? sweep.count * ::Area(sweep.min, sweep.max) : 0.0f);
+
+            if (cost < bestCost) {
+                bestCost = cost;
+                bestSplit = i;
+            }
+        }
+
+        auto split = std::partition(leaves.begin() + begin, leaves.begin() + end,
+                                    [&](int leaf) { return binOf(leaf) < bestSplit; });
+        const size_t splitIndex = static_cast<size_t>(split - leaves.begin());
+
+        if (splitIndex != begin && splitIndex != end) {
+            middle = splitIndex;
+        }
+    }
+
+    const int left = BuildRange(leaves, begin, middle);
+    const int right = BuildRange(leaves, middle, end);
+    const int node = AllocateNode();
+
+    m_nodes[node].left = left;
+    m_nodes[node].right = right;
+    m_nodes[node].min = glm::min(m_nodes[left].min, m_nodes[right].min);
+    m_nodes[node].max = glm::max(m_nodes[left].max, m_nodes[right].max);
+    m_nodes[node].height = 1 + std::max(m_nodes[left].height, m_nodes[right].height);
+
+    m_nodes[left].parent = node;
+    m_nodes[right].parent = node;
+
+    return node;
+}
+
+template <typename Overlaps>
+void DynamicAABBTree::Query(const Overlaps& overlaps, std::vector<Object*>& result) const {
+    if (m_root == NULL_NODE) return;
+
+    m_stack.clear();
+    m_stack.push_back(m_root);
+
+    while (!m_stack.empty()) {
+        const Node& node = m_nodes[m_stack.back()];
+        m_stack.pop_back();
+
+        if (!overlaps(node.min, node.max)) continue;
+
+        if (node.IsLeaf()) {
+            result.push_back(node.object);
+        } else {
+            m_stack.push_back(node.left);
+            m_stack.push_back(node.right);
+        }
+    }
+}
+
+int DynamicAABBTree::Insert(const Bounds& bounds, Object* object) {
+    const int proxy = AllocateNode();
+
+    m_nodes[proxy].min = bounds.min - glm::vec3 { FAT_MARGIN };
+    m_nodes[proxy].max = bounds.max + glm::vec3 { FAT_MARGIN };
+    m_nodes[proxy].object = object;
+
+    InsertLeaf(proxy);
+
+    ++m_leafCount;
+    ++m_changeCount;
+
+    return proxy;
+}
+
+void DynamicAABBTree::Remove(int proxy) {
+    RemoveLeaf(proxy);
+    FreeNode(proxy);
+
+    --m_leafCount;
+    ++m_changeCount;
+}
+
+bool DynamicAABBTree::Move(int proxy, const Bounds& bounds) {
+    if (::Contains(m_nodes[proxy].min, m_nodes[proxy].max, bounds.min, bounds.max)) {
+        return false;
+    }
+
+    RemoveLeaf(proxy);
+
+    m_nodes[proxy].min = bounds.min - glm::vec3 { FAT_MARGIN };
+    m_nodes[proxy].max = bounds.max + glm::vec3 { FAT_MARGIN };
+
+    InsertLeaf(proxy);
+    ++m_changeCount;
+
+    return true;
+}
+
+void DynamicAABBTree::Clear() {
+    m_nodes.clear();
+    m_root = NULL_NODE;
+    m_freeList = NULL_NODE;
+    m_leafCount = 0;
+    m_changeCount = 0;
+}
+
+void DynamicAABBTree::Rebuild() {
+    m_changeCount = 0;
+
+    if (m_leafCount < 2) return;
+
+    std::vector<int> leaves {};
+    leaves.reserve(m_leafCount);
+
+    for (size_t i = 0; i < m_nodes.size(); ++i) {
+        if (m_nodes[i].height < 0) continue;
+
+        if (m_nodes[i].IsLeaf()) {
+            leaves.push_back(static_cast<int>(i));
+        } else {
+            FreeNode(static_cast<int>(i));
+        }
+    }
+
+    m_root = BuildRange(leaves, 0, leaves.size());
+    m_nodes[m_root].parent = NULL_NODE;
+}
+
+size_t DynamicAABBTree::GetLeafCount() const {
+    return m_leafCount;
+}
+
+size_t DynamicAABBTree::GetChangeCount() const {
+    return m_changeCount;
+}
+
+int DynamicAABBTree::GetHeight() const {
+    return m_root == NULL_NODE ? 0 : m_nodes[m_root].height;
+}
+
+void DynamicAABBTree::QueryFrustum(const Frustum& frustum, std::vector<Object*>& result) const {
+    Query([&](const glm::vec3& min, const glm::vec3& max) {
+        return frustum.TestAabb(min, max);
+    }, result);
+}
+
+void DynamicAABBTree::QuerySphere(const glm::vec3& center, float radius,
+                                  std::vector<Object*>& result) const {
+    Query([&](const glm::vec3& min, const glm::vec3& max) {
+        const glm::vec3 offset = center - glm::clamp(center, min, max);
+        return glm::dot(offset, offset) <= radius * radius;
+    }, result);
+}
+
+void DynamicAABBTree::QueryRay(const glm::vec3& origin, const glm::vec3& direction,
+                               float maxDistance, std::vector<Object*>& result) const {
+    const glm::vec3 inverse = 1.0f / direction;
+
+    Query([&](const glm::vec3& min, const glm::vec3& max) {
+        const glm::vec3 t0 = (min - origin) * inverse;
+        const glm::vec3 t1 = (max - origin) * inverse;
+
+        const glm::vec3 near = glm::min(t0, t1);
+        const glm::vec3 far = glm::max(t0, t1);
+
+        const float enter = std::max({ near.x, near.y, near.z, 0.0f });
+        const float exit = std::min({ far.x, far.y, far.z, maxDistance });
+
+        return enter <= exit;
+    }, result);
+}
@@ -1,31 +1,327 @@
 #include "scene/scene.h"
 
 #include "app_exceptions.h"
+#include "everywhere.h"
 
+#include <algorithm>
 #include <iterator>
+#include <utility>
+
+
+namespace {
+
+static constexpr size_t HIERARCHY_GRAIN { 1024 };
+
+} // namespace
 
 
 Scene::Scene() :
     Transformable {},
-    m_objects {} {}
+    m_objects {},
+    m_hierarchy {},
+    m_hierarchyObjects {},
+    m_staleNodes {},
+    m_tree {},
+    m_proxies {},
+    m_proxyIndices {},
+    m_unboundedObjects {},
+    m_movedProxies {},
+    m_visibleObjects {},
+    m_syncedMatrix { 1.0f },
+    m_syncedModelGeneration {} {}
 
 Scene::~Scene() {
+    ReleaseHierarchy();
     m_objects.Clear();
 }
 
-CollectionOf<Object>& Scene::GetObjects() {
-    return m_objects;
+void Scene::RebuildHierarchy() {
+    ReleaseHierarchy();
+
+    for (auto& object : m_objects.Get()) {
+        if (!object) continue;
+
+        object->BindHierarchy(m_hierarchy, m_hierarchy.Add(TransformHierarchy::NO_PARENT,
+                                                           object->GetTransform()));
+        m_hierarchyObjects.push_back({ object, object.get() });
+    }
+
+    // the node list doubles as the breadth first queue
+    for (size_t i = 0; i < m_hierarchyObjects.size(); ++i) {
+        Object* parent = m_hierarchyObjects[i].object;
+
+        for (auto& child : parent->Children().Get()) {
+            if (!child) continue;
+
+            child->BindHierarchy(m_hierarchy, m_hierarchy.Add(parent->GetHierarchyNode(),
+                                                              child->GetTransform()));
+            m_hierarchyObjects.push_back({ child, child.get() });
+        }
+    }
 }
 
-const CollectionOf<Object>& Scene::GetObjects() const {
-    return m_objects;
+void Scene::ReleaseHierarchy() {
+    for (auto& entry : m_hierarchyObjects) {
+        if (entry.object && !entry.owner.expired()) {
+            entry.object->UnbindHierarchy();
+        }
+    }
+
+    m_hierarchyObjects.clear();
+    m_hierarchy.Clear();
+    m_staleNodes = 0;
 }
 
-void Scene::Processing() {
+void Scene::AddToHierarchy(const std::shared_ptr<Object>& object) {
+    const size_t first = m_hierarchyObjects.size();
+
+    object->BindHierarchy(m_hierarchy, m_hierarchy.Add(TransformHierarchy::NO_PARENT,
+                                                       object->GetTransform()));
+    m_hierarchyObjects.push_back({ object, object.get() });
+
+    for (size_t i = first; i < m_hierarchyObjects.size(); ++i) {
+        Object* parent = m_hierarchyObjects[i].object;
+
+        for (auto& child : parent->Children().Get()) {
+            if (!child) continue;
+
+            child->BindHierarchy(m_hierarchy, m_hierarchy.Add(parent->GetHierarchyNode(),
+                                                              child->GetTransform()));
+            m_hierarchyObjects.push_back({ child, child.get() });
+        }
+    }
+
+    // deeper nodes before it, the levels can't be updated in parallel until the next rebuild
+    if (!m_hierarchy.IsBreadthFirst()) {
+        m_staleNodes += m_hierarchyObjects.size() - first;
+    }
+}
+
+void Scene::RemoveFromHierarchy(Object& object) {
+    if (!object.IsInHierarchy()) return;
+
+    // the node stays, unbound, until the next rebuild
+    m_hierarchyObjects[object.GetHierarchyNode()] = HierarchyEntry { {}, nullptr };
+    object.UnbindHierarchy();
+    ++m_staleNodes;
+
+    for (auto& child : object.Children().Get()) {
+        if (child) {
+            RemoveFromHierarchy(*child);
+        }
+    }
+}
+
+void Scene::UpdateHierarchy() {
+    JobSystem& jobs = Everywhere::Instance().Get<JobSystem>();
+
+    jobs.ParallelFor(m_hierarchy.GetSize(), [this](size_t begin, size_t end) {
+        m_hierarchy.UpdateLocal(begin, end);
+    }, ::HIERARCHY_GRAIN);
+
+    // a level only reads the ones above it
+    for (size_t level = 0; level < m_hierarchy.GetLevelCount(); ++level) {
+        const auto [first, last] = m_hierarchy.GetLevel(level);
+
+        if (!m_hierarchy.IsBreadthFirst()) {
+            m_hierarchy.UpdateWorld(first, last);
+            continue;
+        }
+
+        jobs.ParallelFor(last - first, [this, first = first](size_t begin, size_t end) {
+            m_hierarchy.UpdateWorld(first + begin, first + end);
+        }, ::HIERARCHY_GRAIN);
+    }
+
+    m_hierarchy.ClearDirty();
+}
+
+void Scene::SyncTree() {
+    const glm::mat4& sceneMatrix = GetGlobalMatrix();
+    m_hierarchy.SetRoot(sceneMatrix);
+
+    if (m_staleNodes > m_hierarchy.GetSize() / 2) {
+        RebuildHierarchy();
+    }
+
+    FindMoved();
+
+    // children and unbounded objects too, so no world matrix is built from an old parent
+    for (const HierarchyEntry& entry : m_hierarchyObjects) {
+        if (entry.object && !entry.owner.expired()) {
+            entry.object->SyncHierarchy();
+        }
+    }
+
+    UpdateHierarchy();
+
+    // models that finished loading have bounds now
+    const size_t modelGeneration = Everywhere::Instance().Get<ModelStorage>().GetReadyGeneration();
+
+    if (sceneMatrix != m_syncedMatrix) {
+        m_syncedMatrix = sceneMatrix;
+        m_syncedModelGeneration = modelGeneration;
+
+        RebuildTree();
+    } else if (modelGeneration != m_syncedModelGeneration) {
+        m_syncedModelGeneration = modelGeneration;
+
+        InsertBounded();
+    }
+}
+
+void Scene::AddToTree(Object& object) {
+    object.SetParentTransform(GetGlobalTransform());
+
+    const Bounds bounds = object.GetWorldBounds();
+    if (bounds.IsEmpty()) {
+        m_unboundedObjects.push_back(&object);
+    } else {
+        AddProxy(object, bounds);
+    }
+}
+
+void Scene::RemoveFromTree(Object& object) {
+    auto found = m_proxyIndices.find(&object);
+
+    if (found != m_proxyIndices.end()) {
+        RemoveProxy(found->second);
+        return;
+    }
+
+    auto unbounded = std::find(m_unboundedObjects.begin(), m_unboundedObjects.end(), &object);
+    if (unbounded != m_unboundedObjects.end()) {
+        *unbounded = m_unboundedObjects.back();
+        m_unboundedObjects.pop_back();
+    }
+}
+
+void Scene::AddProxy(Object& object, const Bounds& bounds) {
+    m_proxyIndices[&object] = m_proxies.size();
+    m_proxies.push_back(Proxy {
+        &object, m_tree.Insert(bounds, &object), object.GetTransform().GetVersion()
+    });
+}
+
+void Scene::RemoveProxy(size_t index) {
+    m_tree.Remove(m_proxies[index].id);
+    m_proxyIndices.erase(m_proxies[index].object);
+
+    if (index + 1 != m_proxies.size()) {
+        m_proxies[index] = m_proxies.back();
+        m_proxyIndices[m_proxies[index].object] = index;
+    }
+
+    m_proxies.pop_back();
+}
+
+void Scene::RebuildTree() {
+    m_tree.Clear();
+    m_proxies.clear();
+    m_proxyIndices.clear();
+    m_unboundedObjects.clear();
+    m_movedProxies.clear();
+
     for (auto& object : m_objects.Get()) {
         if (object) {
-            object->SetParentTransform(GetGlobalTransform());
-            object->Processing();
+            AddToTree(*object);
+        }
+    }
+
+    m_tree.Rebuild();
+}
+
+void Scene::InsertBounded() {
+    std::vector<Object*> unbounded {};
+    unbounded.swap(m_unboundedObjects);
+
+    for (Object* object : unbounded) {
+        AddToTree(*object);
+    }
+}
+
+void Scene::FindMoved() {
+    m_movedProxies.clear();
+
+    // the parent is the scene, a moved scene reinserts everything
+    for (size_t i = 0; i < m_proxies.size(); ++i) {
+        if (m_proxies[i].object->GetTransform().GetVersion() != m_proxies[i].version) {
+            m_movedProxies.push_back(i);
+        }
+    }
+}
+
+void Scene::RefitMoved() {
+    // backwards, a removed proxy only swaps in one that is done already
+    for (auto index = m_movedProxies.rbegin(); index != m_movedProxies.rend(); ++index) {
+        Proxy& proxy = m_proxies[*index];
+        Object& object = *proxy.object;
+
+        object.SetParentTransform(GetGlobalTransform());
+        proxy.version = object.GetTransform().GetVersion();
+
+        const Bounds bounds = object.GetWorldBounds();
+        if (bounds.IsEmpty()) {
+            RemoveProxy(*index);
+            m_unboundedObjects.push_back(&object);
+        } else {
+            m_tree.Move(proxy.id, bounds);
         }
     }
+
+    m_movedProxies.clear();
+
+    // incremental inserts degrade the tree, rebuild once half of it was touched
+    if (m_tree.GetChangeCount() > m_tree.GetLeafCount() / 2) {
+        m_tree.Rebuild();
+    }
+}
+
+void Scene::ProcessObject(Object& object) {
+    object.SetParentTransform(GetGlobalTransform());
+    object.Processing();
+}
+
+void Scene::Add(const std::shared_ptr<Object>& object) {
+    if (!object) return;
+
+    m_objects.Add(object);
+    AddToHierarchy(object);
+    AddToTree(*object);
+}
+
+void Scene::Remove(const std::shared_ptr<Object>& object) {
+    if (!object) return;
+
+    RemoveFromTree(*object);
+    RemoveFromHierarchy(*object);
+    m_objects.Delete(object);
+}
+
+const CollectionOf<Object>& Scene::GetObjects() const {
+    return m_objects;
+}
+
+const DynamicAABBTree& Scene::GetTree() const {
+    return m_tree;
+}
+
+const TransformHierarchy& Scene::GetHierarchy() const {
+    return m_hierarchy;
+}
+
+void Scene::Processing() {
+    SyncTree();
+    RefitMoved();
+
+    m_visibleObjects.clear();
+    m_tree.QueryFrustum(Everywhere::Instance().Get<RenderQueue>().GetFrustum(), m_visibleObjects);
+
+    for (Object* object : m_unboundedObjects) {
+        ProcessObject(*object);
+    }
+
+    for (Object* object : m_visibleObjects) {
+        ProcessObject(*object);
+    }
 }
@@ -11,31 +11,71 @@
 
 namespace {
 
-static const std::filesystem::path DEFAULT_VERTEX_PATH {
+// defines go right after the "#version" line, which must stay first
+std::string InjectDefines(const std::string& sourceCode, const ShaderDefines& defines) {
+    if (defines.empty()) return sourceCode;
+
+    std::string defineLines {};
+    for (const auto& [name, value] : defines) {
+        defineLines += "#define " + name + " " + value + "\n";
+    }
+
+    const size_t versionPosition = sourceCode.find("#version");
+    if (versionPosition == std::string::npos) {
+        return defineLines + sourceCode;
+    }
+
+    const size_t versionLineEnd = sourceCode.find('\n', versionPosition);
+    if (versionLineEnd == std::string::npos) {
+        return sourceCode + "\n" + defineLines;
+    }
+
+    std::string result { sourceCode };
+    result.insert(versionLineEnd + 1, defineLines);
+
+    return result;
+}
+
+} // namespace
+
+
+const std::filesystem::path Shader::DEFAULT_VERTEX_PATH {
     R"vert(./resources/shaders/default.vert)vert"
 };
 
-static const std::filesystem::path DEFAULT_FRAGMENT_PATH {
+const std::filesystem::path Shader::DEFAULT_FRAGMENT_PATH {
     R"frag(./resources/shaders/default.frag)frag"
 };
 
-} // namespace
-
-
 Shader::Shader() :
-    Shader { ::DEFAULT_VERTEX_PATH, ::DEFAULT_FRAGMENT_PATH } {}
+    Shader { DEFAULT_VERTEX_PATH, DEFAULT_FRAGMENT_PATH } {}
 
 Shader::Shader(const std::filesystem::path& vertexPath,
                const std::filesystem::path& fragmentPath) :
-    ParentTransformation {},
+    Shader { vertexPath, fragmentPath, ShaderDefines {} } {}
+
+Shader::Shader(const std::filesystem::path& vertexPath,
+               const std::filesystem::path& fragmentPath,
+               const ShaderDefines& defines) :
     m_program {},
-    m_uniformProcessingFunctions {} {
+    m_defines { defines },
+    m_uniforms {},
+    m_uniformIndices {},
+    m_modelUniform {},
+    m_viewUniform {},
+    m_projectionUniform {} {
     CreateProgram(vertexPath, fragmentPath);
+    ReflectUniforms();
+
+    m_modelUniform = GetUniform("mvp.model");
+    m_viewUniform = GetUniform("mvp.view");
+    m_projectionUniform = GetUniform("mvp.projection");
 }
 
 Shader::~Shader() {
     glDeleteProgram(m_program);
-    m_uniformProcessingFunctions.clear();
+    m_uniforms.clear();
+    m_uniformIndices.clear();
 }
 
 void Shader::CreateProgram(const std::filesystem::path& vertexPath,
@@ -59,7 +99,8 @@ void Shader::CreateProgram(const std::filesystem::path& vertexPath,
 GLuint* Shader::CompileVertex(const std::filesystem::path& vertexPath) {
     GLuint* vertex = new GLuint { glCreateShader(GL_VERTEX_SHADER) };
 
-    std::string vertexSourceCode = filesystem::GetContentFile(vertexPath);
+    std::string vertexSourceCode =
+        ::InjectDefines(filesystem::GetContentFile(vertexPath), m_defines);
     const GLchar* vertexSourcePtr = vertexSourceCode.c_str();
 
     glShaderSource(*vertex, 1, &vertexSourcePtr, nullptr);
@@ -82,7 +123,8 @@ GLuint* Shader::CompileVertex(const std::filesystem::path& vertexPath) {
 GLuint* Shader::CompileFragment(const std::filesystem::path& fragmentPath) {
     GLuint* fragment = new GLuint { glCreateShader(GL_FRAGMENT_SHADER) };
 
-    std::string fragmentSourceCode = filesystem::GetContentFile(fragmentPath);
+    std::string fragmentSourceCode =
+        ::InjectDefines(filesystem::GetContentFile(fragmentPath), m_defines);
     const GLchar* fragmentSourcePtr = fragmentSourceCode.c_str();
 
     glShaderSource(*fragment, 1, &fragmentSourcePtr, nullptr);
@@ -131,104 +173,192 @@ void Shader::DeleteShaders(GLuint* vertex, GLuint* fragment) {
     }
 }
 
+void Shader::ReflectUniforms() {
+    m_uniforms.clear();
+    m_uniformIndices.clear();
+
+    GLint activeUniforms {};
+    glGetProgramiv(m_program, GL_ACTIVE_UNIFORMS, &activeUniforms);
+
+    GLint maxNameLength {};
+    glGetProgramiv(m_program, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxNameLength);
+
+    std::vector<GLchar> nameBuffer(static_cast<size_t>(maxNameLength) + 1);
+
+    for (GLint i = 0; i < activeUniforms; ++i) {
+        GLsizei nameLength {};
+        GLint arraySize {};
+        GLenum type {};
+
+        glGetActiveUniform(m_program, static_cast<GLuint>(i), maxNameLength,
+                           &nameLength, &arraySize, &type, nameBuffer.data());
+
+        const std::string name { nameBuffer.data(), static_cast<size_t>(nameLength) };
+        const GLint location = glGetUniformLocation(m_program, name.c_str());
+
+        // members of uniform blocks have no location
+        if (location == LOCATION_ERROR_FLAG) continue;
+
+        AddUniform(name, location, type);
+
+        // arrays of basic types are reported once as "name[0]"
+        const size_t arraySuffix = name.rfind("[0]");
+        if (arraySuffix == std::string::npos || arraySuffix + 3 != name.size()) continue;
+
+        const std::string arrayName { name.substr(0, arraySuffix) };
+        AddUniform(arrayName, location, type);
+
+        for (GLint element = 1; element < arraySize; ++element) {
+            const std::string elementName { arrayName + "[" + std::to_string(element) + "]" };
+            AddUniform(elementName, glGetUniformLocation(m_program, elementName.c_str()), type);
+        }
+    }
+}
+
+void Shader::AddUniform(const std::string& uniformName, GLint location, GLenum type) {
+    if (location == LOCATION_ERROR_FLAG) return;
+
+    m_uniformIndices.emplace(uniformName, m_uniforms.size());
+    m_uniforms.emplace_back(location, type);
+}
+
+UniformHandle Shader::GetUniform(const std::string& uniformName) const {
+    auto found = m_uniformIndices.find(uniformName);
+
+    if (found == m_uniformIndices.end()) {
+        return UniformHandle {};
+    }
+
+    return m_uniforms[found->second];
+}
+
+bool Shader::HasUniform(const std::string& uniformName) const {
+    return m_uniformIndices.count(uniformName) != 0;
+}
+
 void Shader::Use() const {
-    glUseProgram(m_program);
+    OpenGL::State().UseProgram(m_program);
 }
 
-Shader::UniformProcessingVector& Shader::UniformProcessingFunctions() {
-    return m_uniformProcessingFunctions;
+GLuint Shader::GetProgram() const {
+    return m_program;
 }
 
-const Shader::UniformProcessingVector& Shader::UniformProcessingFunctions() const {
-    return m_uniformProcessingFunctions;
+const ShaderDefines& Shader::GetDefines() const {
+    return m_defines;
 }
 
-void Shader::SetBool(const std::string& uniformName, bool value) const {
-    SetUInt(uniformName, static_cast<GLuint>(value));
+void Shader::SetBool(const UniformHandle& uniform, bool value) const {
+    SetUInt(uniform, static_cast<GLuint>(value));
 }
 
-void Shader::CheckLocationError(GLint location, const std::string& uniformName) const {
-    if (location == LOCATION_ERROR_FLAG) {
-        throw UniformShaderException("For uniform \"" + uniformName + "\" not found location");
-    }
+void Shader::SetInt(const UniformHandle& uniform, GLint value) const {
+    if (uniform.IsMissing()) return;
+    glUniform1i(uniform.GetLocation(), value);
+}
+
+void Shader::SetUInt(const UniformHandle& uniform, GLuint value) const {
+    if (uniform.IsMissing()) return;
+    glUniform1ui(uniform.GetLocation(), value);
+}
+
+void Shader::SetFloat(const UniformHandle& uniform, GLfloat value) const {
+    if (uniform.IsMissing()) return;
+    glUniform1f(uniform.GetLocation(), value);
+}
+
+void Shader::SetDouble(const UniformHandle& uniform, GLdouble value) const {
+    if (uniform.IsMissing()) return;
+    glUniform1d(uniform.GetLocation(), value);
+}
+
+void Shader::SetVec1(const UniformHandle& uniform, const glm::vec1& value) const {
+    if (uniform.IsMissing()) return;
+    glUniform1fv(uniform.GetLocation(), 1, &value[0]);
+}
+
+void Shader::SetVec2(const UniformHandle& uniform, const glm::vec2& value) const {
+    if (uniform.IsMissing()) return;
+    glUniform2fv(uniform.GetLocation(), 1, &value[0]);
+}
+
+void Shader::SetVec3(const UniformHandle& uniform, const glm::vec3& value) const {
+    if (uniform.IsMissing()) return;
+    glUniform3fv(uniform.GetLocation(), 1, &value[0]);
+}
+
+void Shader::SetVec4(const UniformHandle& uniform, const glm::vec4& value) const {
+    if (uniform.IsMissing()) return;
+    glUniform4fv(uniform.GetLocation(), 1, &value[0]);
+}
+
+void Shader::SetMat2(const UniformHandle& uniform, const glm::mat2& value) const {
+    if (uniform.IsMissing()) return;
+    glUniformMatrix2fv(uniform.GetLocation(), 1, GL_FALSE, glm::value_ptr(value));
+}
+
+void Shader::SetMat3(const UniformHandle& uniform, const glm::mat3& value) const {
+    if (uniform.IsMissing()) return;
+    glUniformMatrix3fv(uniform.GetLocation(), 1, GL_FALSE, glm::value_ptr(value));
+}
+
+void Shader::SetMat4(const UniformHandle& uniform, const glm::mat4& value) const {
+    if (uniform.IsMissing()) return;
+    glUniformMatrix4fv(uniform.GetLocation(), 1, GL_FALSE, glm::value_ptr(value));
+}
+
+void Shader::SetBool(const std::string& uniformName, bool value) const {
+    SetBool(GetUniform(uniformName), value);
 }
 
 void Shader::SetInt(const std::string& uniformName, GLint value) const {
-    GLint location = glGetUniformLocation(m_program, uniformName.c_str());
-    CheckLocationError(location, uniformName);
-    glUniform1i(location, value);
+    SetInt(GetUniform(uniformName), value);
 }
 
 void Shader::SetUInt(const std::string& uniformName, GLuint value) const {
-    GLint location = glGetUniformLocation(m_program, uniformName.c_str());
-    CheckLocationError(location, uniformName);
-    glUniform1ui(location, value);
+    SetUInt(GetUniform(uniformName), value);
 }
 
 void Shader::SetFloat(const std::string& uniformName, GLfloat value) const {
-    GLint location = glGetUniformLocation(m_program, uniformName.c_str());
-    CheckLocationError(location, uniformName);
-    glUniform1f(location, value);
+    SetFloat(GetUniform(uniformName), value);
 }
 
 void Shader::SetDouble(const std::string& uniformName, GLdouble value) const {
-    GLint location = glGetUniformLocation(m_program, uniformName.c_str());
-    CheckLocationError(location, uniformName);
-    glUniform1d(location, value);
+    SetDouble(GetUniform(uniformName), value);
 }
 
 void Shader::SetVec1(const std::string& uniformName, const glm::vec1& value) const {
-    GLint location = glGetUniformLocation(m_program, uniformName.c_str());
-    CheckLocationError(location, uniformName);
-    glUniform1fv(location, 1, &value[0]);
+    SetVec1(GetUniform(uniformName), value);
 }
 
 void Shader::SetVec2(const std::string& uniformName, const glm::vec2& value) const {
-    GLint location = glGetUniformLocation(m_program, uniformName.c_str());
-    CheckLocationError(location, uniformName);
-    glUniform2fv(location, 1, &value[0]);
+    SetVec2(GetUniform(uniformName), value);
 }
 
 void Shader::SetVec3(const std::string& uniformName, const glm::vec3& value) const {
-    GLint location = glGetUniformLocation(m_program, uniformName.c_str());
-    CheckLocationError(location, uniformName);
-    glUniform3fv(location, 1, &value[0]);
+    SetVec3(GetUniform(uniformName), value);
 }
 
 void Shader::SetVec4(const std::string& uniformName, const glm::vec4& value) const {
-    GLint location = glGetUniformLocation(m_program, uniformName.c_str());
-    CheckLocationError(location, uniformName);
-    glUniform4fv(location, 1, &value[0]);
+    SetVec4(GetUniform(uniformName), value);
 }
 
 void Shader::SetMat2(const std::string& uniformName, const glm::mat2& value) const {
-    GLint location = glGetUniformLocation(m_program, uniformName.c_str());
-    CheckLocationError(location, uniformName);
-    glUniformMatrix2fv(location, 1, GL_FALSE, glm::value_ptr(value));
+    SetMat2(GetUniform(uniformName), value);
 }
 
 void Shader::SetMat3(const std::string& uniformName, const glm::mat3& value) const {
-    GLint location = glGetUniformLocation(m_program, uniformName.c_str());
-    CheckLocationError(location, uniformName);
-    glUniformMatrix3fv(location, 1, GL_FALSE, glm::value_ptr(value));
+    SetMat3(GetUniform(uniformName), value);
 }
 
 void Shader::SetMat4(const std::string& uniformName, const glm::mat4& value) const {
-    GLint location = glGetUniformLocation(m_program, uniformName.c_str());
-    CheckLocationError(location, uniformName);
-    glUniformMatrix4fv(location, 1, GL_FALSE, glm::value_ptr(value));
+    SetMat4(GetUniform(uniformName), value);
 }
 
 void Shader::Processing() {
     Use();
 
-    SetMat4("mvp.model", Everywhere::Instance().Get<Space>().ToMatrix());
-    SetMat4("mvp.view", Everywhere::Instance().Get<Camera>().ToMatrix());
-    SetMat4("mvp.projection", Everywhere::Instance().Get<Projection>().ToMatrix());
-
-    SetMat4("transform", GetParentTransform().ToMatrix());
-
-    for (auto& uniformProcessingFunction : m_uniformProcessingFunctions) {
-        uniformProcessingFunction(this);
-    }
+    SetMat4(m_modelUniform, Everywhere::Instance().Get<Space>().ToMatrix());
+    SetMat4(m_viewUniform, Everywhere::Instance().Get<Camera>().ToMatrix());
+    SetMat4(m_projectionUniform, Everywhere::Instance().Get<Projection>().ToMatrix());
 }
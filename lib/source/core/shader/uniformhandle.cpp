@@ -0,0 +1,26 @@
+#include "shader/uniformhandle.h"
+
+
+UniformHandle::UniformHandle() :
+    m_location { MISSING_LOCATION },
+    m_type { GL_NONE } {}
+
+UniformHandle::UniformHandle(GLint location, GLenum type) :
+    m_location { location },
+    m_type { type } {}
+
+GLint UniformHandle::GetLocation() const {
+    return m_location;
+}
+
+GLenum UniformHandle::GetType() const {
+    return m_type;
+}
+
+bool UniformHandle::IsValid() const {
+    return m_location != MISSING_LOCATION;
+}
+
+bool UniformHandle::IsMissing() const {
+    return !IsValid();
+}
@@ -0,0 +1,165 @@
+#include "storage/impostorstorage.h"
+
+#include "everywhere.h"
+#include "mesh/mesh.h"
+#include "material/material.h"
+#include "object/modeldata.h"
+
+#include <filesystem>
+#include <string>
+
+
+namespace {
+
+static const std::filesystem::path IMPOSTOR_VERTEX_PATH {
+    R"vert(./resources/shaders/impostor.vert)vert"
+};
+
+static const std::filesystem::path IMPOSTOR_FRAGMENT_PATH {
+    R"frag(./resources/shaders/impostor.frag)frag"
+};
+
+static const ShaderDefines IMPOSTOR_DEFINES {
+    { "IMPOSTOR_FRAMES", std::to_string(Impostor::FRAMES) },
+};
+
+static constexpr GLenum ALBEDO_UNIT { GL_TEXTURE0 };
+static constexpr GLenum NORMAL_DEPTH_UNIT { GL_TEXTURE1 };
+static constexpr GLsizei QUAD_VERTICES { 4 };
+
+} // namespace
+
+
+ImpostorStorage::ImpostorStorage() :
+    m_impostors {},
+    m_shader { Everywhere::Instance().Get<ShaderStorage>().Get(::IMPOSTOR_VERTEX_PATH, ::IMPOSTOR_FRAGMENT_PATH,
+                                                               ::IMPOSTOR_DEFINES) },
+    m_vertexArray {},
+    m_drawCallCount {} {
+    glCreateVertexArrays(1, &m_vertexArray);
+}
+
+ImpostorStorage::~ImpostorStorage() {
+    m_impostors.clear();
+
+    if (OpenGL::HasState()) {
+        OpenGL::State().ForgetVertexArray(m_vertexArray);
+    }
+
+    glDeleteVertexArrays(1, &m_vertexArray);
+}
+
+void ImpostorStorage::RequestTextures(const ModelData& modelData) {
+    const MaterialStorage& materialStorage = Everywhere::Instance().Get<MaterialStorage>();
+
+    for (const auto& child : modelData.Children()) {
+        const Mesh* mesh = dynamic_cast<const Mesh*>(child.get());
+        if (!mesh) continue;
+
+        auto material = materialStorage.GetMaterials()[mesh->GetMaterialId()];
+        if (material) {
+            material->RequestTextureResidency(static_cast<float>(Impostor::FRAME_SIZE));
+        }
+    }
+}
+
+void ImpostorStorage::Bake() {
+    size_t bakes { 0 };
+    size_t baked { 0 };
+
+    for (auto& [key, entry] : m_impostors) {
+        if (entry.impostor) {
+            ++baked;
+            continue;
+        }
+
+        if (entry.waitedFrames < BAKE_DELAY_FRAMES) {
+            RequestTextures(*entry.modelData);
+            ++entry.waitedFrames;
+            continue;
+        }
+
+        if (bakes >= BAKES_PER_FRAME) continue;
+
+        entry.impostor = std::make_unique<Impostor>(*entry.modelData);
+        ++bakes;
+        ++baked;
+    }
+
+    // never evicted, streamed textures give levels back instead
+    Everywhere::Instance().Get<TextureStorage>().SetExternalBytes(baked * Impostor::GetAtlasBytes());
+}
+
+void ImpostorStorage::Draw() {
+    FrameRingBuffer& ringBuffer = Everywhere::Instance().Get<FrameRingBuffer>();
+    GLStateCache& state = OpenGL::State();
+
+    Shader* shader { nullptr };
+
+    for (auto& [key, entry] : m_impostors) {
+        if (entry.instances.empty()) continue;
+
+        if (!shader) {
+            shader = m_shader.get();
+
+            shader->Processing();
+            shader->SetVec3("cameraPosition", Everywhere::Instance().Get<Camera>().GetTransform().GetPosition());
+            shader->SetInt("albedoAtlas", static_cast<GLint>(::ALBEDO_UNIT - GL_TEXTURE0));
+            shader->SetInt("normalDepthAtlas", static_cast<GLint>(::NORMAL_DEPTH_UNIT - GL_TEXTURE0));
+
+            state.BindVertexArray(m_vertexArray);
+        }
+
+        const FrameAllocation allocation = ringBuffer.Allocate(
+            entry.instances.data(), entry.instances.size() * sizeof(glm::mat4),
+            ringBuffer.GetStorageAlignment());
+
+        state.BindBufferRange(GL_SHADER_STORAGE_BUFFER, INSTANCES_BINDING_POINT,
+                              allocation.buffer, allocation.offset, allocation.size);
+        state.BindTexture(::ALBEDO_UNIT, GL_TEXTURE_2D, entry.impostor->GetAlbedo());
+        state.BindTexture(::NORMAL_DEPTH_UNIT, GL_TEXTURE_2D, entry.impostor->GetNormalDepth());
+        shader->SetVec4("sphere", entry.impostor->GetSphere());
+
+        glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, ::QUAD_VERTICES,
+                              static_cast<GLsizei>(entry.instances.size()));
+        ++m_drawCallCount;
+
+        entry.instances.clear();
+    }
+}
+
+bool ImpostorStorage::Add(const std::shared_ptr<ModelData>& modelData, const glm::mat4& transform) {
+    if (!modelData || !modelData->IsReady()) return false;
+
+    auto found = m_impostors.find(modelData.get());
+
+    if (found == m_impostors.end()) {
+        m_impostors.emplace(modelData.get(), Entry { modelData, nullptr, 0, {} });
+        return false;
+    }
+
+    if (!found->second.impostor) return false;
+
+    found->second.instances.push_back(transform);
+    return true;
+}
+
+bool ImpostorStorage::IsBaked(const ModelData& modelData) const {
+    auto found = m_impostors.find(&modelData);
+    return found != m_impostors.end() && found->second.impostor;
+}
+
+size_t ImpostorStorage::Size() const {
+    return m_impostors.size();
+}
+
+size_t ImpostorStorage::GetDrawCallCount() const {
+    return m_drawCallCount;
+}
+
+void ImpostorStorage::Processing() {
+    m_drawCallCount = 0;
+
+    Bake();
+    Draw();
+}
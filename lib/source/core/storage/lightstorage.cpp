@@ -1,21 +1,109 @@
 #include "storage/lightstorage.h"
 
+#include "graphics/opengl.h"
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
 
-const size_t LightStorage::MAX_DIRECTIONAL_LIGHTS { 4 };
-const size_t LightStorage::MAX_POINT_LIGHTS { 12 };
-const size_t LightStorage::MAX_SPOT_LIGHTS { 6 };
 
 LightStorage::LightStorage() :
     m_directionalLights {},
     m_pointLights {},
-    m_spotLights {} {}
+    m_spotLights {},
+    m_lightBlock {},
+    m_ubo {},
+    m_isDirty { true },
+    m_maxActiveLights { MAX_POINT_LIGHTS + MAX_SPOT_LIGHTS } {
+    glGenBuffers(1, &m_ubo);
+    OpenGL::State().BindBuffer(GL_UNIFORM_BUFFER, m_ubo);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(LightBlock), nullptr, GL_DYNAMIC_DRAW);
+}
 
 LightStorage::~LightStorage() {
+    glDeleteBuffers(1, &m_ubo);
+
+    if (OpenGL::HasState()) {
+        OpenGL::State().ForgetBuffer(m_ubo);
+    }
+
     m_directionalLights.Clear();
     m_pointLights.Clear();
     m_spotLights.Clear();
 }
 
+void LightStorage::PackLightBlock() {
+    m_lightBlock = LightBlock {};
+
+    GLuint& directionalCount = m_lightBlock.counts[0];
+    for (size_t i = 0; i < m_directionalLights.Size(); ++i) {
+        if (directionalCount == MAX_DIRECTIONAL_LIGHTS) break;
+
+        const DirectionalLight* light = m_directionalLights[i];
+        if (!light) continue;
+
+        const GLuint id = directionalCount++;
+        m_lightBlock.directionalDirection[id] =
+            glm::vec4 { light->GetGlobalTransform().GetAxis().GetFront(), 0.0f };
+        m_lightBlock.directionalAmbient[id] =
+            glm::vec4 { static_cast<glm::vec3>(light->GetAmbientColor()), 0.0f };
+        m_lightBlock.directionalDiffuse[id] =
+            glm::vec4 { static_cast<glm::vec3>(light->GetDiffuseColor()), 0.0f };
+        m_lightBlock.directionalSpecular[id] =
+            glm::vec4 { static_cast<glm::vec3>(light->GetSpecularColor()), 0.0f };
+    }
+
+    GLuint& pointCount = m_lightBlock.counts[1];
+    for (size_t i = 0; i < m_pointLights.Size(); ++i) {
+        if (pointCount == MAX_POINT_LIGHTS || pointCount >= m_maxActiveLights) break;
+
+        const PointLight* light = m_pointLights[i];
+        if (!light) continue;
+
+        const GLuint id = pointCount++;
+        m_lightBlock.pointPosition[id] =
+            glm::vec4 { light->GetGlobalTransform().GetPosition(), 1.0f };
+        m_lightBlock.pointAmbient[id] =
+            glm::vec4 { static_cast<glm::vec3>(light->GetAmbientColor()), 0.0f };
+        m_lightBlock.pointDiffuse[id] =
+            glm::vec4 { static_cast<glm::vec3>(light->GetDiffuseColor()), 0.0f };
+        m_lightBlock.pointSpecular[id] =
+            glm::vec4 { static_cast<glm::vec3>(light->GetSpecularColor()), 0.0f };
+        m_lightBlock.pointAttenuation[id] =
+            glm::vec4 { light->GetConstant(), light->GetLinear(), light->GetQuadratic(), 0.0f };
+    }
+
+    GLuint& spotCount = m_lightBlock.counts[2];
+    for (size_t i = 0; i < m_spotLights.Size(); ++i) {
+        if (spotCount == MAX_SPOT_LIGHTS || pointCount + spotCount >= m_maxActiveLights) break;
+
+        const SpotLight* light = m_spotLights[i];
+        if (!light) continue;
+
+        const GLuint id = spotCount++;
+        m_lightBlock.spotPosition[id] =
+            glm::vec4 { light->GetGlobalTransform().GetPosition(), 1.0f };
+        m_lightBlock.spotDirection[id] =
+            glm::vec4 { light->GetGlobalTransform().GetAxis().GetFront(), 0.0f };
+        m_lightBlock.spotAmbient[id] =
+            glm::vec4 { static_cast<glm::vec3>(light->GetAmbientColor()), 0.0f };
+        m_lightBlock.spotDiffuse[id] =
+            glm::vec4 { static_cast<glm::vec3>(light->GetDiffuseColor()), 0.0f };
+        m_lightBlock.spotSpecular[id] =
+            glm::vec4 { static_cast<glm::vec3>(light->GetSpecularColor()), 0.0f };
+        m_lightBlock.spotAttenuation[id] =
+            glm::vec4 { light->GetConstant(), light->GetLinear(), light->GetQuadratic(), 0.0f };
+        m_lightBlock.spotCutoff[id] =
+            glm::vec4 { glm::cos(light->GetCutoffRadians()),
+                        glm::cos(light->GetOuterCutoffRadians()), 0.0f, 0.0f };
+    }
+}
+
+void LightStorage::UploadLightBlock() {
+    OpenGL::State().BindBuffer(GL_UNIFORM_BUFFER, m_ubo);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(LightBlock), &m_lightBlock);
+}
+
 CollectionOfPtr<DirectionalLight>& LightStorage::GetDirectionalLights() {
     return m_directionalLights;
 }
@@ -39,3 +127,32 @@ CollectionOfPtr<SpotLight>& LightStorage::GetSpotLights() {
 const CollectionOfPtr<SpotLight>& LightStorage::GetSpotLights() const {
     return m_spotLights;
 }
+
+void LightStorage::MarkDirty() {
+    m_isDirty = true;
+}
+
+bool LightStorage::IsDirty() const {
+    return m_isDirty;
+}
+
+void LightStorage::SetMaxActiveLights(size_t count) {
+    if (count == m_maxActiveLights) return;
+
+    m_maxActiveLights = count;
+    m_isDirty = true;
+}
+
+size_t LightStorage::GetMaxActiveLights() const {
+    return m_maxActiveLights;
+}
+
+void LightStorage::Processing() {
+    if (m_isDirty) {
+        PackLightBlock();
+        UploadLightBlock();
+        m_isDirty = false;
+    }
+
+    OpenGL::State().BindBufferBase(GL_UNIFORM_BUFFER, LIGHTS_BINDING_POINT, m_ubo);
+}
@@ -1,12 +1,47 @@
 #include "storage/modelstorage.h"
 
 #include "app_exceptions.h"
+#include "everywhere.h"
+
+#include <algorithm>
+#include <iterator>
+
+
+namespace {
+
+// generated LODs are kept under the path of their source
+std::string GetKey(const std::filesystem::path& path, size_t lod) {
+    return lod ? path.string() + "#lod" + std::to_string(lod) : path.string();
+}
+
+} // namespace
 
 
 ModelStorage::ModelStorage() :
-    m_models {} {}
+    m_models {},
+    m_pendingModels {},
+    m_imports {},
+    m_sourceImports {},
+    m_readyGeneration {} {}
 
 ModelStorage::~ModelStorage() {
+    // workers still hold the models being imported
+    JobSystem& jobs = Everywhere::Instance().Get<JobSystem>();
+
+    try {
+        for (auto& [key, source] : m_sourceImports) {
+            jobs.Wait(*source.counter);
+        }
+
+        jobs.Wait(m_imports);
+    } catch (...) {
+        /* DUMMY */
+    }
+
+    m_sourceImports.clear();
+
+    m_pendingModels.clear();
+
     for (auto& [key, model] : m_models) {
         model.reset();
     }
@@ -14,30 +49,63 @@ ModelStorage::~ModelStorage() {
     m_models.clear();
 }
 
-bool ModelStorage::HasModel(std::filesystem::path path) const {
+bool ModelStorage::HasModel(std::filesystem::path path, size_t lod) const {
     path = std::filesystem::canonical(path);
-    return static_cast<bool>(m_models.count(path.string()));
+    return static_cast<bool>(m_models.count(::GetKey(path, lod)));
 }
 
 void ModelStorage::CreateModelData(std::filesystem::path path) const {
-    if (path.empty()) {
-        throw ModelStorageException { "An empty file path was received." };
-    }
-
-    if (!m_models.count(path.string())) {
-        m_models.insert({ path.string(), std::make_shared<ModelData>(path, path.parent_path()) });
-    }
+    CreateModelData(path, path.parent_path());
 }
 
 void ModelStorage::CreateModelData(std::filesystem::path path,
-                                   std::filesystem::path textureDirectory) const {
+                                   std::filesystem::path textureDirectory,
+                                   size_t lod) const {
     if (path.empty()) {
         throw ModelStorageException { "An empty file path was received." };
     }
 
-    if (!m_models.count(path.string())) {
-        m_models.insert({ path.string(), std::make_shared<ModelData>(path, textureDirectory) });
+    const KeyType key = ::GetKey(path, lod);
+    if (m_models.count(key)) return;
+
+    auto modelData = std::make_shared<ModelData>(path, textureDirectory, lod);
+
+    m_models.insert({ key, modelData });
+    m_pendingModels.push_back(modelData);
+
+    JobSystem& jobs = Everywhere::Instance().Get<JobSystem>();
+
+    // Assimp, simplification and texture decoding, never on the main thread
+    auto import = [modelData]() {
+        modelData->Import();
+    };
+
+    if (!lod) {
+        auto meshes = std::make_shared<std::vector<ImportedMesh>>();
+        modelData->ShareSourceMeshes(meshes);
+
+        SourceImport& source = m_sourceImports[key];
+        if (!source.counter) {
+            source.counter = std::make_unique<JobCounter>();
+        }
+
+        source.meshes = meshes;
+        jobs.Run(import, *source.counter, JobAffinity::WORKER);
+        return;
+    }
+
+    auto source = m_sourceImports.find(path.string());
+
+    // the source is read once, unless its meshes are gone already
+    if (source != m_sourceImports.end()) {
+        if (auto meshes = source->second.meshes.lock()) {
+            modelData->ShareSourceMeshes(meshes);
+            jobs.RunAfter(*source->second.counter, import, m_imports, JobAffinity::WORKER);
+            return;
+        }
     }
+
+    jobs.Run(import, m_imports, JobAffinity::WORKER);
 }
 
 const ModelStorage::ValueType ModelStorage::Get(std::filesystem::path path) const {
@@ -50,3 +118,37 @@ const ModelStorage::ValueType
     CreateModelData(path, textureDirectory);
     return m_models.at(path.string());
 }
+
+const ModelStorage::ValueType ModelStorage::GetLod(std::filesystem::path path, size_t lod) const {
+    CreateModelData(path, path.parent_path(), lod);
+    return m_models.at(::GetKey(path, lod));
+}
+
+bool ModelStorage::HasPendingModels() const {
+    return !m_pendingModels.empty();
+}
+
+size_t ModelStorage::GetReadyGeneration() const {
+    return m_readyGeneration;
+}
+
+void ModelStorage::Processing() {
+    size_t budget { UPLOAD_BUDGET_BYTES };
+
+    for (auto& modelData : m_pendingModels) {
+        if (!budget) break;
+
+        const size_t used = modelData->Upload(budget);
+        budget -= std::min(used, budget);
+    }
+
+    const auto ready = std::remove_if(std::begin(m_pendingModels), std::end(m_pendingModels),
+                                      [](const ValueType& modelData) {
+        return modelData->IsReady();
+    });
+
+    if (ready != std::end(m_pendingModels)) {
+        m_pendingModels.erase(ready, std::end(m_pendingModels));
+        ++m_readyGeneration;
+    }
+}
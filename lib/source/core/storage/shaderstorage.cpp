@@ -0,0 +1,59 @@
+#include "storage/shaderstorage.h"
+
+
+ShaderStorage::ShaderStorage() :
+    m_shaders {} {}
+
+ShaderStorage::~ShaderStorage() {
+    for (auto& [key, shader] : m_shaders) {
+        shader.reset();
+    }
+
+    m_shaders.clear();
+}
+
+ShaderStorage::KeyType ShaderStorage::MakeKey(const std::filesystem::path& vertexPath,
+                                              const std::filesystem::path& fragmentPath,
+                                              const ShaderDefines& defines) {
+    KeyType key { std::filesystem::canonical(vertexPath).string() + "|" +
+                  std::filesystem::canonical(fragmentPath).string() };
+
+    for (const auto& [name, value] : defines) {
+        key += "|" + name + "=" + value;
+    }
+
+    return key;
+}
+
+bool ShaderStorage::HasShader(const std::filesystem::path& vertexPath,
+                              const std::filesystem::path& fragmentPath,
+                              const ShaderDefines& defines) const {
+    return m_shaders.count(MakeKey(vertexPath, fragmentPath, defines));
+}
+
+const ShaderStorage::ValueType
+    ShaderStorage::Get(const std::filesystem::path& vertexPath,
+                       const std::filesystem::path& fragmentPath) const {
+    return Get(vertexPath, fragmentPath, ShaderDefines {});
+}
+
+const ShaderStorage::ValueType
+    ShaderStorage::Get(const std::filesystem::path& vertexPath,
+                       const std::filesystem::path& fragmentPath,
+                       const ShaderDefines& defines) const {
+    const KeyType key = MakeKey(vertexPath, fragmentPath, defines);
+
+    if (!m_shaders.count(key)) {
+        m_shaders.insert({ key, std::make_shared<Shader>(vertexPath, fragmentPath, defines) });
+    }
+
+    return m_shaders.at(key);
+}
+
+const ShaderStorage::ValueType ShaderStorage::GetDefaultShader() const {
+    return Get(Shader::DEFAULT_VERTEX_PATH, Shader::DEFAULT_FRAGMENT_PATH);
+}
+
+size_t ShaderStorage::Size() const {
+    return m_shaders.size();
+}
@@ -1,21 +1,41 @@
 #include "storage/texturestorage.h"
 
+#include "app_exceptions.h"
+#include "texture/compressedimage.h"
+
+#include <algorithm>
+#include <cmath>
 #include <filesystem>
 
 
 namespace {
 
 static const GLenum DEFAULT_TEXTURE_UNIT { GL_TEXTURE0 };
+static const bool DEFAULT_FLIP_VERTICAL { true };
+static const GLenum UNCOMPRESSED_FORMAT { GL_RGBA8 };
 
 static std::filesystem::path defaultTexturePath {
     R"png(./resources/textures/default_texture.png)png"
 };
 
+GLsizei CoarsestLevel(const IStreamable& texture) {
+    return IStreamable::GetCoarsestLevel(texture.GetWidth(), texture.GetHeight(),
+                                         texture.GetLevelCount());
+}
+
 } // namespace
 
 
 TextureStorage::TextureStorage() :
-    m_textures {} {
+    m_textures {},
+    m_arrays {},
+    m_slots {},
+    m_streamStates {},
+    m_frame { 1 },
+    m_budgetBytes { DEFAULT_BUDGET_BYTES },
+    m_externalBytes {},
+    m_mipBias {},
+    m_stats {} {
 
     defaultTexturePath = std::filesystem::canonical(defaultTexturePath);
 
@@ -42,6 +62,9 @@ TextureStorage::~TextureStorage() {
     }
 
     m_textures.clear();
+    m_streamStates.clear();
+    m_slots.clear();
+    m_arrays.clear();
 }
 
 TextureStorage::ValueType
@@ -79,6 +102,24 @@ TextureStorage::ValueType
     return m_textures.at(path.string());
 }
 
+TextureStorage::ValueType
+    TextureStorage::Get(const DecodedImage& image, GLenum textureUnit) {
+
+    const std::string key = image.GetPath().string();
+
+    if (!m_textures.count(key)) {
+        m_textures.insert({ key, std::make_shared<Texture>(image, textureUnit) });
+    }
+
+    m_textures.at(key)->SetTextureUnit(textureUnit);
+
+    return m_textures.at(key);
+}
+
+bool TextureStorage::HasTexture(std::filesystem::path path) const {
+    return m_textures.count(std::filesystem::canonical(path).string());
+}
+
 TextureStorage::ValueType TextureStorage::Get(const TextureParams& textureData) {
     return Get(textureData.GetPath(), textureData.GetUnit());
 }
@@ -118,4 +159,281 @@ const TextureStorage::ValueType
 
 std::filesystem::path TextureStorage::GetDefaultTexturePath() const {
     return defaultTexturePath;
-}
\ No newline at end of file
+}
+
+TextureSlot TextureStorage::GetSlot(std::filesystem::path path) {
+    path = std::filesystem::canonical(path);
+
+    auto found = m_slots.find(path.string());
+    if (found != m_slots.end()) {
+        return found->second;
+    }
+
+    if (!CompressedImage::IsUpToDate(path)) {
+        return GetSlot(DecodedImage { path, ::DEFAULT_FLIP_VERTICAL });
+    }
+
+    auto image = std::make_unique<CompressedImage>(path);
+
+    TextureSlot slot {};
+    slot.array = static_cast<uint32_t>(GetArray(image->GetWidth(), image->GetHeight(),
+                                                image->GetFormat()));
+    slot.layer = m_arrays[slot.array]->AddLayer(std::move(image));
+
+    m_slots.insert({ path.string(), slot });
+    return slot;
+}
+
+TextureSlot TextureStorage::GetSlot(const DecodedImage& image) {
+    const std::string key = image.GetPath().string();
+
+    auto found = m_slots.find(key);
+    if (found != m_slots.end()) {
+        return found->second;
+    }
+
+    TextureSlot slot {};
+    slot.array = static_cast<uint32_t>(GetArray(image.GetWidth(), image.GetHeight(), ::UNCOMPRESSED_FORMAT));
+    slot.layer = m_arrays[slot.array]->AddLayer(image);
+
+    m_slots.insert({ key, slot });
+    return slot;
+}
+
+bool TextureStorage::HasSlot(std::filesystem::path path) const {
+    return m_slots.count(std::filesystem::canonical(path).string());
+}
+
+size_t TextureStorage::GetArray(GLsizei width, GLsizei height, GLenum format) {
+    size_t arrayId { 0 };
+    while (arrayId < m_arrays.size() &&
+           (m_arrays[arrayId]->GetWidth() != width || m_arrays[arrayId]->GetHeight() != height ||
+            m_arrays[arrayId]->GetFormat() != format)) {
+        ++arrayId;
+    }
+
+    if (arrayId == m_arrays.size()) {
+        if (m_arrays.size() == MAX_TEXTURE_ARRAYS) {
+            throw TextureException { "Too many texture sizes and formats for texture arrays" };
+        }
+
+        m_arrays.push_back(std::make_unique<TextureArray>(width, height, format));
+    }
+
+    return arrayId;
+}
+
+size_t TextureStorage::GetArrayCount() const {
+    return m_arrays.size();
+}
+
+void TextureStorage::BindArrays() const {
+    for (size_t i = 0; i < m_arrays.size(); ++i) {
+        m_arrays[i]->UpdateMipmaps();
+        m_arrays[i]->Bind(FIRST_ARRAY_UNIT + static_cast<GLenum>(i));
+    }
+}
+
+TextureStorage::StreamState& TextureStorage::GetStreamState(IStreamable& texture) {
+    auto found = m_streamStates.find(&texture);
+
+    if (found == m_streamStates.end()) {
+        found = m_streamStates.insert({ &texture, { 0, ::CoarsestLevel(texture), 0 } }).first;
+    }
+
+    return found->second;
+}
+
+std::vector<IStreamable*> TextureStorage::GetStreamables() const {
+    std::vector<IStreamable*> streamables {};
+    streamables.reserve(m_textures.size() + m_arrays.size());
+
+    for (const auto& [key, texture] : m_textures) {
+        streamables.push_back(texture.get());
+    }
+
+    for (const auto& array : m_arrays) {
+        streamables.push_back(array.get());
+    }
+
+    return streamables;
+}
+
+size_t TextureStorage::GetResidentBytes() const {
+    size_t bytes { 0 };
+
+    for (IStreamable* texture : GetStreamables()) {
+        bytes += texture->GetResidentBytes(texture->GetResidentLevel());
+    }
+
+    return bytes;
+}
+
+void TextureStorage::Request(IStreamable& texture, float screenSize) {
+    if (!texture.IsStreamable()) return;
+
+    const GLsizei coarsest = ::CoarsestLevel(texture);
+    GLsizei level { coarsest };
+
+    if (screenSize > 0.0f) {
+        const float ratio = static_cast<float>(std::max(texture.GetWidth(), texture.GetHeight())) / screenSize;
+        level = ratio > 1.0f ? static_cast<GLsizei>(std::floor(std::log2(ratio))) : 0;
+        level = std::clamp(level + m_mipBias, 0, coarsest);
+    }
+
+    StreamState& state = GetStreamState(texture);
+
+    // the largest use of the frame wins
+    if (state.lastUsedFrame != m_frame) {
+        state.lastUsedFrame = m_frame;
+        state.wantedLevel = level;
+    } else {
+        state.wantedLevel = std::min(state.wantedLevel, level);
+    }
+}
+
+void TextureStorage::RequestSlot(TextureSlot slot, float screenSize) {
+    if (slot.array < m_arrays.size()) {
+        Request(*m_arrays[slot.array], screenSize);
+    }
+}
+
+void TextureStorage::SetBudget(size_t bytes) {
+    m_budgetBytes = bytes;
+}
+
+size_t TextureStorage::GetBudget() const {
+    return m_budgetBytes;
+}
+
+void TextureStorage::SetExternalBytes(size_t bytes) {
+    m_externalBytes = bytes;
+}
+
+size_t TextureStorage::GetExternalBytes() const {
+    return m_externalBytes;
+}
+
+void TextureStorage::SetMipBias(GLsizei levels) {
+    m_mipBias = std::max(levels, 0);
+}
+
+GLsizei TextureStorage::GetMipBias() const {
+    return m_mipBias;
+}
+
+const TextureStreamingStats& TextureStorage::GetStreamingStats() const {
+    return m_stats;
+}
+
+void TextureStorage::Processing() {
+    m_stats.uploadedLevels = 0;
+    m_stats.evictedLevels = 0;
+
+    std::vector<IStreamable*> evictable {};
+    std::vector<IStreamable*> wanting {};
+
+    for (IStreamable* texture : GetStreamables()) {
+        if (!texture->IsStreamable()) continue;
+
+        StreamState& state = GetStreamState(*texture);
+        const bool used = state.lastUsedFrame == m_frame;
+        state.targetLevel = texture->GetResidentLevel();
+
+        if (!used && texture->GetResidentLevel() < ::CoarsestLevel(*texture)) {
+            evictable.push_back(texture);
+        } else if (used && texture->GetResidentLevel() > state.wantedLevel) {
+            wanting.push_back(texture);
+        } else if (used && texture->GetResidentLevel() < state.wantedLevel) {
+            // drawn smaller than before, the extra levels go first
+            evictable.push_back(texture);
+        }
+    }
+
+    // least recently used first
+    std::sort(evictable.begin(), evictable.end(), [this](IStreamable* lhs, IStreamable* rhs) {
+        return m_streamStates.at(lhs).lastUsedFrame < m_streamStates.at(rhs).lastUsedFrame;
+    });
+
+    // the most missing detail first
+    std::sort(wanting.begin(), wanting.end(), [this](IStreamable* lhs, IStreamable* rhs) {
+        return lhs->GetResidentLevel() - m_streamStates.at(lhs).wantedLevel >
+               rhs->GetResidentLevel() - m_streamStates.at(rhs).wantedLevel;
+    });
+
+    size_t residentBytes = GetResidentBytes() + m_externalBytes;
+    size_t nextEvictable { 0 };
+
+    // levels are planned one at a time, every texture is resized once at the end,
+    // since each resize moves all of its resident levels into new storage
+
+    // drops one planned level of the least recently used texture, false when nothing is left
+    auto evictOne = [&]() {
+        while (nextEvictable < evictable.size()) {
+            IStreamable* texture = evictable[nextEvictable];
+            StreamState& state = m_streamStates.at(texture);
+            const GLsizei floor = state.lastUsedFrame == m_frame ? state.wantedLevel
+                                                                 : ::CoarsestLevel(*texture);
+            const GLsizei level = state.targetLevel;
+
+            if (level >= floor) {
+                ++nextEvictable;
+                continue;
+            }
+
+            residentBytes -= texture->GetResidentBytes(level) - texture->GetResidentBytes(level + 1);
+            state.targetLevel = level + 1;
+            ++m_stats.evictedLevels;
+
+            return true;
+        }
+
+        return false;
+    };
+
+    while (residentBytes > m_budgetBytes && evictOne()) {}
+
+    for (IStreamable* texture : wanting) {
+        StreamState& state = m_streamStates.at(texture);
+        bool fits { true };
+
+        while (fits && state.targetLevel > state.wantedLevel &&
+               m_stats.uploadedLevels < MAX_LEVELS_PER_FRAME) {
+            const GLsizei level = state.targetLevel;
+            const size_t growth = texture->GetResidentBytes(level - 1) - texture->GetResidentBytes(level);
+
+            while (residentBytes + growth > m_budgetBytes && (fits = evictOne())) {}
+            if (!fits) break;
+
+            state.targetLevel = level - 1;
+            residentBytes += growth;
+            ++m_stats.uploadedLevels;
+        }
+
+        if (!fits || m_stats.uploadedLevels == MAX_LEVELS_PER_FRAME) break;
+    }
+
+    for (IStreamable* texture : evictable) {
+        const GLsizei level = m_streamStates.at(texture).targetLevel;
+        if (level != texture->GetResidentLevel()) texture->SetResidentLevel(level);
+    }
+
+    for (IStreamable* texture : wanting) {
+        const GLsizei level = m_streamStates.at(texture).targetLevel;
+        if (level != texture->GetResidentLevel()) texture->SetResidentLevel(level);
+    }
+
+    m_stats.budgetBytes = m_budgetBytes;
+    m_stats.residentBytes = residentBytes;
+    m_stats.externalBytes = m_externalBytes;
+    m_stats.fullBytes = 0;
+    m_stats.streamedTextures = 0;
+    m_stats.pinnedTextures = 0;
+
+    for (IStreamable* texture : GetStreamables()) {
+        m_stats.fullBytes += texture->GetResidentBytes(0);
+        ++(texture->IsStreamable() ? m_stats.streamedTextures : m_stats.pinnedTextures);
+    }
+
+    ++m_frame;
+}
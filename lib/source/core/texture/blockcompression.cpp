@@ -0,0 +1,296 @@
+#include "texture/blockcompression.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+
+namespace {
+
+static constexpr size_t PIXELS { 16 };
+static constexpr size_t CHANNELS { 4 };
+
+static constexpr int BC7_WEIGHTS[16] { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+static constexpr size_t POWER_ITERATIONS { 8 };
+
+
+// little endian bit stream over one block
+class BitWriter final {
+private:
+    uint8_t* m_block;
+    size_t m_position;
+
+public:
+    explicit BitWriter(uint8_t* block, size_t bytes) :
+        m_block { block },
+        m_position { 0 } {
+        std::memset(m_block, 0, bytes);
+    }
+
+    void Write(uint32_t value, size_t bits) {
+        for (size_t i = 0; i < bits; ++i, ++m_position) {
+            m_block[m_position / 8] |= static_cast<uint8_t>(((value >> i) & 1u) << (m_position % 8));
+        }
+    }
+};
+
+int Bc7Interpolate(int e0, int e1, size_t index) {
+    return ((64 - BC7_WEIGHTS[index]) * e0 + BC7_WEIGHTS[index] * e1 + 32) >> 6;
+}
+
+// endpoints of 7 bits plus a p-bit shared by the four channels
+void QuantizeBc7Endpoint(const float* endpoint, uint32_t* result, uint32_t& pBit) {
+    float bestError { INFINITY };
+
+    for (uint32_t p = 0; p < 2; ++p) {
+        uint32_t quantized[CHANNELS] {};
+        float error { 0.0f };
+
+        for (size_t c = 0; c < CHANNELS; ++c) {
+            const float value = std::round((endpoint[c] - static_cast<float>(p)) / 2.0f);
+            quantized[c] = static_cast<uint32_t>(std::clamp(value, 0.0f, 127.0f));
+
+            const float restored = static_cast<float>((quantized[c] << 1) | p);
+            error += (restored - endpoint[c]) * (restored - endpoint[c]);
+        }
+
+        if (error < bestError) {
+            bestError = error;
+            pBit = p;
+            std::copy(quantized, quantized + CHANNELS, result);
+        }
+    }
+}
+
+struct Bc7Endpoints {
+    uint32_t quantized[2][CHANNELS];
+    uint32_t pBits[2];
+};
+
+Bc7Endpoints QuantizeBc7Endpoints(const float (&endpoints)[2][CHANNELS]) {
+    Bc7Endpoints result {};
+
+    QuantizeBc7Endpoint(endpoints[0], result.quantized[0], result.pBits[0]);
+    QuantizeBc7Endpoint(endpoints[1], result.quantized[1], result.pBits[1]);
+
+    return result;
+}
+
+// nearest palette entry per pixel, returns the squared error
+int FitBc7Indices(const uint8_t* pixels, const Bc7Endpoints& endpoints, uint32_t* indices) {
+    int restored[2][CHANNELS] {};
+
+    for (size_t e = 0; e < 2; ++e) {
+        for (size_t c = 0; c < CHANNELS; ++c) {
+            restored[e][c] = static_cast<int>((endpoints.quantized[e][c] << 1) | endpoints.pBits[e]);
+        }
+    }
+
+    int totalError { 0 };
+
+    for (size_t i = 0; i < PIXELS; ++i) {
+        int bestError { INT32_MAX };
+
+        for (size_t index = 0; index < 16; ++index) {
+            int error { 0 };
+
+            for (size_t c = 0; c < CHANNELS; ++c) {
+                const int difference = Bc7Interpolate(restored[0][c], restored[1][c], index) -
+                                       pixels[i * CHANNELS + c];
+                error += difference * difference;
+            }
+
+            if (error < bestError) {
+                bestError = error;
+                indices[i] = static_cast<uint32_t>(index);
+            }
+        }
+
+        totalError += bestError;
+    }
+
+    return totalError;
+}
+
+// endpoints with the least squared error for fixed indices
+bool RefineBc7Endpoints(const uint8_t* pixels, const uint32_t* indices,
+                        float (&endpoints)[2][CHANNELS]) {
+    float aa { 0.0f }, ab { 0.0f }, bb { 0.0f };
+    float ap[CHANNELS] {}, bp[CHANNELS] {};
+
+    for (size_t i = 0; i < PIXELS; ++i) {
+        const float b = BC7_WEIGHTS[indices[i]] / 64.0f;
+        const float a = 1.0f - b;
+
+        aa += a * a;
+        ab += a * b;
+        bb += b * b;
+
+        for (size_t c = 0; c < CHANNELS; ++c) {
+            ap[c] += a * pixels[i * CHANNELS + c];
+            bp[c] += b * pixels[i * CHANNELS + c];
+        }
+    }
+
+    const float determinant = aa * bb - ab * ab;
+    if (std::abs(determinant) < 1e-6f) return false;
+
+    for (size_t c = 0; c < CHANNELS; ++c) {
+        endpoints[0][c] = std::clamp((bb * ap[c] - ab * bp[c]) / determinant, 0.0f, 255.0f);
+        endpoints[1][c] = std::clamp((aa * bp[c] - ab * ap[c]) / determinant, 0.0f, 255.0f);
+    }
+
+    return true;
+}
+
+} // namespace
+
+
+namespace blockcompression {
+
+void EncodeBc4(const uint8_t* values, uint8_t* block) {
+    const uint8_t high = *std::max_element(values, values + ::PIXELS);
+    const uint8_t low = *std::min_element(values, values + ::PIXELS);
+
+    // high > low selects the eight value mode
+    int palette[8] { high, low };
+    for (int i = 2; i < 8; ++i) {
+        palette[i] = ((8 - i) * high + (i - 1) * low + 3) / 7;
+    }
+
+    uint64_t indices { 0 };
+
+    if (high != low) {
+        for (size_t i = 0; i < ::PIXELS; ++i) {
+            uint64_t best { 0 };
+
+            for (uint64_t j = 1; j < 8; ++j) {
+                if (std::abs(palette[j] - values[i]) < std::abs(palette[best] - values[i])) {
+                    best = j;
+                }
+            }
+
+            indices |= best << (3 * i);
+        }
+    }
+
+    block[0] = high;
+    block[1] = low;
+
+    for (size_t i = 0; i < 6; ++i) {
+        block[2 + i] = static_cast<uint8_t>(indices >> (8 * i));
+    }
+}
+
+void EncodeBc7(const uint8_t* pixels, uint8_t* block) {
+    float mean[::CHANNELS] {};
+
+    for (size_t i = 0; i < ::PIXELS; ++i) {
+        for (size_t c = 0; c < ::CHANNELS; ++c) {
+            mean[c] += pixels[i * ::CHANNELS + c] / static_cast<float>(::PIXELS);
+        }
+    }
+
+    float covariance[::CHANNELS][::CHANNELS] {};
+
+    for (size_t i = 0; i < ::PIXELS; ++i) {
+        for (size_t a = 0; a < ::CHANNELS; ++a) {
+            for (size_t b = 0; b < ::CHANNELS; ++b) {
+                covariance[a][b] += (pixels[i * ::CHANNELS + a] - mean[a]) *
+                                    (pixels[i * ::CHANNELS + b] - mean[b]);
+            }
+        }
+    }
+
+    // principal axis by power iteration
+    float axis[::CHANNELS] { 1.0f, 1.0f, 1.0f, 1.0f };
+
+    for (size_t iteration = 0; iteration < ::POWER_ITERATIONS; ++iteration) {
+        float next[::CHANNELS] {};
+        float length { 0.0f };
+
+        for (size_t a = 0; a < ::CHANNELS; ++a) {
+            for (size_t b = 0; b < ::CHANNELS; ++b) {
+                next[a] += covariance[a][b] * axis[b];
+            }
+
+            length = std::max(length, std::abs(next[a]));
+        }
+
+        if (length == 0.0f) break;
+
+        for (size_t c = 0; c < ::CHANNELS; ++c) {
+            axis[c] = next[c] / length;
+        }
+    }
+
+    float lowest { INFINITY };
+    float highest { -INFINITY };
+
+    for (size_t i = 0; i < ::PIXELS; ++i) {
+        float projection { 0.0f };
+
+        for (size_t c = 0; c < ::CHANNELS; ++c) {
+            projection += (pixels[i * ::CHANNELS + c] - mean[c]) * axis[c];
+        }
+
+        lowest = std::min(lowest, projection);
+        highest = std::max(highest, projection);
+    }
+
+    float squaredLength { 0.0f };
+    for (float value : axis) squaredLength += value * value;
+    if (squaredLength == 0.0f) squaredLength = 1.0f;
+
+    float endpoints[2][::CHANNELS] {};
+
+    for (size_t c = 0; c < ::CHANNELS; ++c) {
+        endpoints[0][c] = std::clamp(mean[c] + axis[c] * lowest / squaredLength, 0.0f, 255.0f);
+        endpoints[1][c] = std::clamp(mean[c] + axis[c] * highest / squaredLength, 0.0f, 255.0f);
+    }
+
+    Bc7Endpoints quantized = ::QuantizeBc7Endpoints(endpoints);
+
+    uint32_t indices[::PIXELS] {};
+    const int error = ::FitBc7Indices(pixels, quantized, indices);
+
+    if (error && ::RefineBc7Endpoints(pixels, indices, endpoints)) {
+        const Bc7Endpoints refined = ::QuantizeBc7Endpoints(endpoints);
+
+        uint32_t refinedIndices[::PIXELS] {};
+        const int refinedError = ::FitBc7Indices(pixels, refined, refinedIndices);
+
+        if (refinedError < error) {
+            quantized = refined;
+            std::copy(refinedIndices, refinedIndices + ::PIXELS, indices);
+        }
+    }
+
+    // the first index is stored without its top bit, which has to be zero
+    if (indices[0] & 8u) {
+        std::swap(quantized.quantized[0], quantized.quantized[1]);
+        std::swap(quantized.pBits[0], quantized.pBits[1]);
+
+        for (uint32_t& index : indices) {
+            index = 15u - index;
+        }
+    }
+
+    BitWriter writer { block, BC7_BLOCK_BYTES };
+    writer.Write(1u << 6, 7); // mode 6
+
+    for (size_t c = 0; c < ::CHANNELS; ++c) {
+        writer.Write(quantized.quantized[0][c], 7);
+        writer.Write(quantized.quantized[1][c], 7);
+    }
+
+    writer.Write(quantized.pBits[0], 1);
+    writer.Write(quantized.pBits[1], 1);
+
+    writer.Write(indices[0], 3);
+    for (size_t i = 1; i < ::PIXELS; ++i) {
+        writer.Write(indices[i], 4);
+    }
+}
+
+} // namespace blockcompression
@@ -0,0 +1,346 @@
+#include "texture/compressedimage.h"
+
+#include "app_exceptions.h"
+#include "misc/fs.h"
+#include "misc/sourcestamp.h"
+#include "texture/blockcompression.h"
+#include "texture/decodedimage.h"
+
+#include <stb_image.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <string>
+
+
+namespace {
+
+namespace fs = std::filesystem;
+namespace bc = blockcompression;
+
+static const std::string EXTENSION { ".dds" };
+static constexpr uint32_t DDS_MAGIC { 0x20534444 }; // "DDS "
+static constexpr uint32_t DX10_FOURCC { 0x30315844 }; // "DX10"
+static constexpr uint32_t KOFE_TAG { 0x45464f4b }; // "KOFE"
+
+static constexpr uint32_t DDSD_CAPS { 0x1 };
+static constexpr uint32_t DDSD_HEIGHT { 0x2 };
+static constexpr uint32_t DDSD_WIDTH { 0x4 };
+static constexpr uint32_t DDSD_PIXELFORMAT { 0x1000 };
+static constexpr uint32_t DDSD_MIPMAPCOUNT { 0x20000 };
+static constexpr uint32_t DDSD_LINEARSIZE { 0x80000 };
+static constexpr uint32_t DDPF_FOURCC { 0x4 };
+static constexpr uint32_t DDSCAPS_COMPLEX { 0x8 };
+static constexpr uint32_t DDSCAPS_TEXTURE { 0x1000 };
+static constexpr uint32_t DDSCAPS_MIPMAP { 0x400000 };
+
+static constexpr uint32_t DXGI_FORMAT_BC4_UNORM { 80 };
+static constexpr uint32_t DXGI_FORMAT_BC7_UNORM { 98 };
+static constexpr uint32_t D3D10_RESOURCE_DIMENSION_TEXTURE2D { 3 };
+
+static constexpr int RGBA { 4 };
+
+
+struct DdsPixelFormat {
+    uint32_t size;
+    uint32_t flags;
+    uint32_t fourCC;
+    uint32_t rgbBitCount;
+    uint32_t masks[4];
+};
+
+struct DdsHeader {
+    uint32_t size;
+    uint32_t flags;
+    uint32_t height;
+    uint32_t width;
+    uint32_t pitchOrLinearSize;
+    uint32_t depth;
+    uint32_t mipMapCount;
+    // unused by readers, holds the kofe tag, version and source stamp
+    uint32_t reserved1[11];
+    DdsPixelFormat pixelFormat;
+    uint32_t caps[4];
+    uint32_t reserved2;
+};
+
+struct DdsHeaderDx10 {
+    uint32_t dxgiFormat;
+    uint32_t resourceDimension;
+    uint32_t miscFlag;
+    uint32_t arraySize;
+    uint32_t miscFlags2;
+};
+
+struct FileHeader {
+    uint32_t magic;
+    DdsHeader dds;
+    DdsHeaderDx10 dx10;
+};
+
+static_assert(sizeof(DdsHeader) == 124, "DDS header layout");
+static_assert(sizeof(FileHeader) == 148, "DDS file header layout");
+
+static constexpr size_t STAMP_OFFSET { offsetof(FileHeader, dds) + offsetof(DdsHeader, reserved1) + 8 };
+
+
+SourceStamp GetStamp(const FileHeader& header) {
+    SourceStamp stamp {};
+    std::memcpy(&stamp, &header.dds.reserved1[2], sizeof(stamp));
+
+    return stamp;
+}
+
+bool IsSupportedHeader(const FileHeader& header) {
+    return header.magic == DDS_MAGIC &&
+           header.dds.size == sizeof(DdsHeader) &&
+           header.dds.pixelFormat.fourCC == DX10_FOURCC &&
+           header.dds.reserved1[0] == KOFE_TAG &&
+           header.dds.reserved1[1] == CompressedImage::VERSION &&
+           (header.dx10.dxgiFormat == DXGI_FORMAT_BC4_UNORM ||
+            header.dx10.dxgiFormat == DXGI_FORMAT_BC7_UNORM);
+}
+
+GLsizei LevelBytes(GLsizei width, GLsizei height, size_t blockBytes) {
+    const GLsizei blocksX = (width + bc::BLOCK_SIZE - 1) / bc::BLOCK_SIZE;
+    const GLsizei blocksY = (height + bc::BLOCK_SIZE - 1) / bc::BLOCK_SIZE;
+
+    return blocksX * blocksY * static_cast<GLsizei>(blockBytes);
+}
+
+GLsizei MipLevels(GLsizei width, GLsizei height) {
+    return static_cast<GLsizei>(std::floor(std::log2(std::max(width, height)))) + 1;
+}
+
+// 2x2 box filter, the odd last row or column is repeated
+std::vector<uint8_t> Downsample(const std::vector<uint8_t>& image, int width, int height) {
+    const int nextWidth = std::max(1, width / 2);
+    const int nextHeight = std::max(1, height / 2);
+
+    std::vector<uint8_t> result(static_cast<size_t>(nextWidth) * nextHeight * RGBA);
+
+    for (int y = 0; y < nextHeight; ++y) {
+        const int y0 = std::min(2 * y, height - 1);
+        const int y1 = std::min(2 * y + 1, height - 1);
+
+        for (int x = 0; x < nextWidth; ++x) {
+            const int x0 = std::min(2 * x, width - 1);
+            const int x1 = std::min(2 * x + 1, width - 1);
+
+            for (int c = 0; c < RGBA; ++c) {
+                const int sum = image[(y0 * width + x0) * RGBA + c] + image[(y0 * width + x1) * RGBA + c] +
+                                image[(y1 * width + x0) * RGBA + c] + image[(y1 * width + x1) * RGBA + c];
+
+                result[(y * nextWidth + x) * RGBA + c] = static_cast<uint8_t>((sum + 2) / 4);
+            }
+        }
+    }
+
+    return result;
+}
+
+void EncodeLevel(const std::vector<uint8_t>& image, int width, int height, bool grey,
+                 std::vector<uint8_t>& result) {
+    uint8_t pixels[bc::BLOCK_SIZE * bc::BLOCK_SIZE * RGBA] {};
+    uint8_t values[bc::BLOCK_SIZE * bc::BLOCK_SIZE] {};
+    uint8_t block[bc::BC7_BLOCK_BYTES] {};
+
+    for (int blockY = 0; blockY < height; blockY += bc::BLOCK_SIZE) {
+        for (int blockX = 0; blockX < width; blockX += bc::BLOCK_SIZE) {
+            // blocks over the edge repeat the last pixels
+            for (size_t i = 0; i < bc::BLOCK_SIZE * bc::BLOCK_SIZE; ++i) {
+                const int x = std::min(blockX + static_cast<int>(i % bc::BLOCK_SIZE), width - 1);
+                const int y = std::min(blockY + static_cast<int>(i / bc::BLOCK_SIZE), height - 1);
+
+                std::memcpy(&pixels[i * RGBA], &image[(y * width + x) * RGBA], RGBA);
+                values[i] = pixels[i * RGBA];
+            }
+
+            if (grey) {
+                bc::EncodeBc4(values, block);
+                result.insert(result.end(), block, block + bc::BC4_BLOCK_BYTES);
+            } else {
+                bc::EncodeBc7(pixels, block);
+                result.insert(result.end(), block, block + bc::BC7_BLOCK_BYTES);
+            }
+        }
+    }
+}
+
+} // namespace
+
+
+CompressedImage::CompressedImage(const std::filesystem::path& sourcePath) :
+    m_file { GetPath(sourcePath) },
+    m_format {},
+    m_width {},
+    m_height {},
+    m_levels {} {
+    FileHeader header {};
+
+    if (m_file.GetSize() < sizeof(header)) {
+        throw TextureException { "File \"" + GetPath(sourcePath).string() + "\" is truncated." };
+    }
+
+    std::memcpy(&header, m_file.GetData(), sizeof(header));
+
+    if (!::IsSupportedHeader(header) || !header.dds.width || !header.dds.height ||
+        header.dds.mipMapCount != static_cast<uint32_t>(::MipLevels(header.dds.width,
+                                                                   header.dds.height))) {
+        throw TextureException { "File \"" + GetPath(sourcePath).string() + "\" is damaged." };
+    }
+
+    const bool grey = header.dx10.dxgiFormat == ::DXGI_FORMAT_BC4_UNORM;
+
+    m_format = grey ? GL_COMPRESSED_RED_RGTC1 : GL_COMPRESSED_RGBA_BPTC_UNORM;
+    m_width = static_cast<GLsizei>(header.dds.width);
+    m_height = static_cast<GLsizei>(header.dds.height);
+
+    size_t offset { sizeof(header) };
+
+    for (uint32_t level = 0; level < header.dds.mipMapCount; ++level) {
+        const GLsizei width = std::max(1, m_width >> level);
+        const GLsizei height = std::max(1, m_height >> level);
+        const GLsizei size = ::LevelBytes(width, height, grey ? bc::BC4_BLOCK_BYTES
+                                                              : bc::BC7_BLOCK_BYTES);
+
+        if (offset + static_cast<size_t>(size) > m_file.GetSize()) {
+            throw TextureException { "File \"" + GetPath(sourcePath).string() + "\" is truncated." };
+        }
+
+        m_levels.push_back(Level { m_file.GetData() + offset, size, width, height });
+        offset += static_cast<size_t>(size);
+    }
+}
+
+std::filesystem::path CompressedImage::GetPath(const std::filesystem::path& sourcePath) {
+    fs::path path { sourcePath };
+    path += ::EXTENSION;
+
+    return path;
+}
+
+bool CompressedImage::IsUpToDate(const std::filesystem::path& sourcePath) {
+    const fs::path path = GetPath(sourcePath);
+
+    FileHeader header {};
+
+    {
+        std::ifstream file { path, std::ios::in | std::ios::binary };
+        if (!file.read(reinterpret_cast<char*>(&header), sizeof(header))) return false;
+    }
+
+    if (!::IsSupportedHeader(header)) return false;
+
+    SourceStamp stamp = ::GetStamp(header);
+    const int64_t storedTime = stamp.time;
+
+    if (!stamp.Matches(sourcePath)) return false;
+
+    if (stamp.time != storedTime) {
+        std::fstream file { path, std::ios::in | std::ios::out | std::ios::binary };
+        file.seekp(::STAMP_OFFSET);
+        file.write(reinterpret_cast<const char*>(&stamp), sizeof(stamp));
+    }
+
+    return true;
+}
+
+bool CompressedImage::Compile(const std::filesystem::path& sourcePath) {
+    int width {}, height {}, channels {};
+
+    if (!stbi_info(sourcePath.string().c_str(), &width, &height, &channels)) return false;
+
+    std::vector<uint8_t> image {};
+
+    try {
+        // stored bottom up
+        const DecodedImage decoded { sourcePath, true };
+        image.assign(decoded.GetPixels(), decoded.GetPixels() + decoded.GetBytes());
+    } catch (const TextureException&) {
+        return false;
+    }
+
+    // grey alpha loses its alpha, as it does uncompressed
+    const bool grey = channels <= STBI_grey_alpha;
+    const GLsizei levels = ::MipLevels(width, height);
+
+    std::vector<uint8_t> blocks {};
+
+    for (GLsizei level = 0; level < levels; ++level) {
+        const int levelWidth = std::max(1, width >> level);
+        const int levelHeight = std::max(1, height >> level);
+
+        ::EncodeLevel(image, levelWidth, levelHeight, grey, blocks);
+
+        if (level + 1 < levels) {
+            image = ::Downsample(image, levelWidth, levelHeight);
+        }
+    }
+
+    FileHeader header {};
+    header.magic = ::DDS_MAGIC;
+
+    header.dds.size = sizeof(DdsHeader);
+    header.dds.flags = ::DDSD_CAPS | ::DDSD_HEIGHT | ::DDSD_WIDTH | ::DDSD_PIXELFORMAT |
+                       ::DDSD_MIPMAPCOUNT | ::DDSD_LINEARSIZE;
+    header.dds.width = static_cast<uint32_t>(width);
+    header.dds.height = static_cast<uint32_t>(height);
+    header.dds.pitchOrLinearSize = static_cast<uint32_t>(
+        ::LevelBytes(width, height, grey ? bc::BC4_BLOCK_BYTES : bc::BC7_BLOCK_BYTES));
+    header.dds.mipMapCount = static_cast<uint32_t>(levels);
+    header.dds.reserved1[0] = ::KOFE_TAG;
+    header.dds.reserved1[1] = VERSION;
+
+    const SourceStamp stamp = SourceStamp::Of(sourcePath);
+    std::memcpy(&header.dds.reserved1[2], &stamp, sizeof(stamp));
+
+    header.dds.pixelFormat.size = sizeof(DdsPixelFormat);
+    header.dds.pixelFormat.flags = ::DDPF_FOURCC;
+    header.dds.pixelFormat.fourCC = ::DX10_FOURCC;
+    header.dds.caps[0] = ::DDSCAPS_TEXTURE | ::DDSCAPS_MIPMAP | ::DDSCAPS_COMPLEX;
+
+    header.dx10.dxgiFormat = grey ? ::DXGI_FORMAT_BC4_UNORM : ::DXGI_FORMAT_BC7_UNORM;
+    header.dx10.resourceDimension = ::D3D10_RESOURCE_DIMENSION_TEXTURE2D;
+    header.dx10.arraySize = 1;
+
+    return filesystem::ReplaceContentFile(GetPath(sourcePath), [&](std::ostream& file) {
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(blocks.data()),
+                   static_cast<std::streamsize>(blocks.size()));
+    });
+}
+
+GLsizei CompressedImage::GetLevelBytes(GLenum format, GLsizei width, GLsizei height) {
+    return ::LevelBytes(width, height, format == GL_COMPRESSED_RED_RGTC1 ? bc::BC4_BLOCK_BYTES
+                                                                        : bc::BC7_BLOCK_BYTES);
+}
+
+void CompressedImage::ApplySwizzle(GLuint texture, GLenum format) {
+    if (format != GL_COMPRESSED_RED_RGTC1) return;
+
+    const GLint swizzle[4] { GL_RED, GL_RED, GL_RED, GL_ONE };
+    glTextureParameteriv(texture, GL_TEXTURE_SWIZZLE_RGBA, swizzle);
+}
+
+GLenum CompressedImage::GetFormat() const {
+    return m_format;
+}
+
+GLsizei CompressedImage::GetWidth() const {
+    return m_width;
+}
+
+GLsizei CompressedImage::GetHeight() const {
+    return m_height;
+}
+
+GLsizei CompressedImage::GetLevelCount() const {
+    return static_cast<GLsizei>(m_levels.size());
+}
+
+const CompressedImage::Level& CompressedImage::GetLevel(GLsizei level) const {
+    return m_levels[static_cast<size_t>(level)];
+}
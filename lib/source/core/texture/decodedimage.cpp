@@ -0,0 +1,62 @@
+#include "texture/decodedimage.h"
+
+#include "app_exceptions.h"
+
+#include <stb_image.h>
+
+#include <algorithm>
+
+
+namespace {
+
+static constexpr int RGBA { STBI_rgb_alpha };
+
+} // namespace
+
+
+DecodedImage::DecodedImage(const std::filesystem::path& path, bool flipVertical) :
+    m_path { std::filesystem::canonical(path) },
+    m_width {},
+    m_height {},
+    m_channels {},
+    m_pixels {} {
+    uint8_t* data = stbi_load(m_path.string().c_str(), &m_width, &m_height, &m_channels, ::RGBA);
+
+    if (!data) {
+        throw TextureException { "Cannot load image \"" + m_path.string() + '"' };
+    }
+
+    const size_t rowBytes = static_cast<size_t>(m_width) * ::RGBA;
+    m_pixels.resize(rowBytes * m_height);
+
+    for (GLsizei row = 0; row < m_height; ++row) {
+        const GLsizei source = flipVertical ? m_height - 1 - row : row;
+        std::copy_n(data + rowBytes * source, rowBytes, m_pixels.data() + rowBytes * row);
+    }
+
+    stbi_image_free(data);
+}
+
+const std::filesystem::path& DecodedImage::GetPath() const {
+    return m_path;
+}
+
+GLsizei DecodedImage::GetWidth() const {
+    return m_width;
+}
+
+GLsizei DecodedImage::GetHeight() const {
+    return m_height;
+}
+
+int DecodedImage::GetChannels() const {
+    return m_channels;
+}
+
+const uint8_t* DecodedImage::GetPixels() const {
+    return m_pixels.data();
+}
+
+size_t DecodedImage::GetBytes() const {
+    return m_pixels.size();
+}
@@ -1,6 +1,10 @@
 #include "texture/texture.h"
 
 #include "app_exceptions.h"
+#include "graphics/opengl.h"
+
+#include <algorithm>
+#include <cmath>
 
 
 namespace {
@@ -8,61 +12,80 @@ namespace {
 static const glm::vec4 TEXTURE_BORDER_COLOR { .0f, .0f, .0f, 1.f };
 static const GLsizei BUFFER_SIZE { 1 };
 static const GLint MIPMAP_LEVEL { 0 };
-static const GLint BORDER { 0 }; // always zero (legacy)
+static const GLenum UNCOMPRESSED_FORMAT { GL_RGB8 };
+static const size_t UNCOMPRESSED_TEXEL_BYTES { 4 }; // RGB8 is padded by drivers
 static const GLenum DEFAULT_TEXTURE_UNIT { GL_TEXTURE0 };
 static const GLenum LAST_TEXTURE_UNIT { GL_TEXTURE31 };
 static const bool DEFAULT_FLIP_VERTICAL { true };
 
+GLsizei MipLevels(GLsizei width, GLsizei height) {
+    return static_cast<GLsizei>(std::floor(std::log2(std::max(width, height)))) + 1;
+}
+
 } // namespace
 
 
-void Texture::InitTextureWrapParameters() const {
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+void Texture::InitTextureWrapParameters(GLuint texture) const {
+    glTextureParameteri(texture, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTextureParameteri(texture, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
 
     GLint currentTextureWrap {};
-    glGetTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, &currentTextureWrap);
+    glGetTextureParameteriv(texture, GL_TEXTURE_WRAP_S, &currentTextureWrap);
 
     if (currentTextureWrap == GL_CLAMP_TO_BORDER) {
-        glTexParameterfv(GL_TEXTURE_2D, GL_TEXTURE_BORDER_COLOR, &TEXTURE_BORDER_COLOR[0]);
+        glTextureParameterfv(texture, GL_TEXTURE_BORDER_COLOR, &TEXTURE_BORDER_COLOR[0]);
     }
 }
 
-void Texture::InitTextureFilterParameter() const {
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR); // firstTexture minimaze
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR); // firstTexture maximize
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 7);
+void Texture::InitTextureFilterParameter(GLuint texture) const {
+    glTextureParameteri(texture, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR); // firstTexture minimaze
+    glTextureParameteri(texture, GL_TEXTURE_MAG_FILTER, GL_LINEAR); // firstTexture maximize
 }
 
 void Texture::InitTexture(const std::filesystem::path& texturePath, bool flipVertical) {
-    glGenTextures(BUFFER_SIZE, &tex);
-    glBindTexture(GL_TEXTURE_2D, tex);
+    // compiled images are stored flipped
+    if (flipVertical && CompressedImage::IsUpToDate(texturePath)) {
+        try {
+            InitCompressedTexture(texturePath);
+            return;
+        } catch (const TextureException&) {
+            // damaged, decoded below
+        }
+    }
 
-    InitTextureWrapParameters();
-    InitTextureFilterParameter();
+    InitDecodedTexture(DecodedImage { texturePath, flipVertical });
+}
 
-    stbi_set_flip_vertically_on_load(static_cast<int>(flipVertical));
+void Texture::InitDecodedTexture(const DecodedImage& image) {
+    m_width = image.GetWidth();
+    m_height = image.GetHeight();
+    m_channels = image.GetChannels();
 
-    uint8_t* data = stbi_load(texturePath.string().c_str(), &m_width, &m_height, &m_channels,
-                              static_cast<int>(m_textureChannelComponents));
+    m_format = ::UNCOMPRESSED_FORMAT;
+    m_levels = ::MipLevels(m_width, m_height);
 
-    if (!data) {
-        glDeleteTextures(BUFFER_SIZE, &tex);
-        Unbind();
-        throw TextureException { "Cannot load image \"" + texturePath.string() + '"' };
-    }
+    glCreateTextures(GL_TEXTURE_2D, BUFFER_SIZE, &tex);
+    InitTextureWrapParameters(tex);
+    InitTextureFilterParameter(tex);
 
-    GLenum format { GL_RGB };
-    if (m_textureChannelComponents == TextureChannelComponents::RGBA ||
-        m_textureChannelComponents == TextureChannelComponents::GREY_ALPHA) {
-        format = GL_RGBA;
-    }
+    // decoded images are always RGBA
+    glTextureStorage2D(tex, m_levels, m_format, m_width, m_height);
+    glTextureSubImage2D(tex, MIPMAP_LEVEL, 0, 0, m_width, m_height, GL_RGBA, GL_UNSIGNED_BYTE,
+                        image.GetPixels());
+    glGenerateTextureMipmap(tex); // generate all mipmap levels
+}
 
-    glTexImage2D(GL_TEXTURE_2D, MIPMAP_LEVEL, GL_RGB, m_width, m_height, BORDER, format, GL_UNSIGNED_BYTE, data);
-    glGenerateMipmap(GL_TEXTURE_2D); // generate all mipmap levels
+void Texture::InitCompressedTexture(const std::filesystem::path& texturePath) {
+    m_image = std::make_unique<CompressedImage>(texturePath);
 
-    stbi_image_free(data);
-    Unbind();
+    m_width = m_image->GetWidth();
+    m_height = m_image->GetHeight();
+    m_channels = m_image->GetFormat() == GL_COMPRESSED_RED_RGTC1 ? 1 : 4;
+
+    m_format = m_image->GetFormat();
+    m_levels = m_image->GetLevelCount();
+
+    SetResidentLevel(GetCoarsestLevel(m_width, m_height, m_levels));
 }
 
 Texture::Texture(const std::filesystem::path& texturePath) :
@@ -78,16 +101,35 @@ Texture::Texture(const std::filesystem::path& texturePath, GLenum textureUnit, b
     m_width {},
     m_height {},
     m_channels {},
+    m_format {},
+    m_levels {},
+    m_residentLevel {},
+    m_image {},
     tex {} {
     InitTexture(texturePath, flipVertical);
 }
 
+Texture::Texture(const DecodedImage& image, GLenum textureUnit) :
+    m_textureChannelComponents { TextureChannelComponents::RGBA },
+    m_textureUnit { textureUnit },
+    m_samplePosition {},
+    m_width {},
+    m_height {},
+    m_channels {},
+    m_format {},
+    m_levels {},
+    m_residentLevel {},
+    m_image {},
+    tex {} {
+    InitDecodedTexture(image);
+}
+
 Texture::~Texture() {
     glDeleteTextures(BUFFER_SIZE, &tex);
-}
 
-void Texture::Unbind() const {
-    glBindTexture(GL_TEXTURE_2D, 0);
+    if (OpenGL::HasState()) {
+        OpenGL::State().ForgetTexture(tex);
+    }
 }
 
 GLenum Texture::GetTextureUnit() const {
@@ -115,7 +157,78 @@ GLenum Texture::NextTextureUnit() const {
     return m_textureUnit + 1;
 }
 
+bool Texture::IsStreamable() const {
+    return m_image != nullptr;
+}
+
+GLsizei Texture::GetWidth() const {
+    return m_width;
+}
+
+GLsizei Texture::GetHeight() const {
+    return m_height;
+}
+
+GLsizei Texture::GetLevelCount() const {
+    return m_levels;
+}
+
+GLsizei Texture::GetResidentLevel() const {
+    return m_residentLevel;
+}
+
+void Texture::SetResidentLevel(GLsizei level) {
+    if (!m_image) return;
+
+    level = std::clamp(level, 0, m_levels - 1);
+    if (tex && level == m_residentLevel) return;
+
+    // immutable storage can't shrink or grow, so the levels move to a new one
+    GLuint resized {};
+    glCreateTextures(GL_TEXTURE_2D, BUFFER_SIZE, &resized);
+    InitTextureWrapParameters(resized);
+    InitTextureFilterParameter(resized);
+    CompressedImage::ApplySwizzle(resized, m_format);
+
+    const CompressedImage::Level& top = m_image->GetLevel(level);
+    glTextureStorage2D(resized, m_levels - level, m_format, top.width, top.height);
+
+    for (GLsizei source = level; source < m_levels; ++source) {
+        const CompressedImage::Level& data = m_image->GetLevel(source);
+
+        if (tex && source >= m_residentLevel) {
+            glCopyImageSubData(tex, GL_TEXTURE_2D, source - m_residentLevel, 0, 0, 0,
+                               resized, GL_TEXTURE_2D, source - level, 0, 0, 0,
+                               data.width, data.height, 1);
+        } else {
+            glCompressedTextureSubImage2D(resized, source - level, 0, 0, data.width, data.height,
+                                          m_format, data.size, data.data);
+        }
+    }
+
+    if (tex) {
+        glDeleteTextures(BUFFER_SIZE, &tex);
+        OpenGL::State().ForgetTexture(tex);
+    }
+
+    tex = resized;
+    m_residentLevel = level;
+}
+
+size_t Texture::GetResidentBytes(GLsizei level) const {
+    size_t bytes { 0 };
+
+    for (GLsizei i = std::max(level, 0); i < m_levels; ++i) {
+        const GLsizei width = std::max(1, m_width >> i);
+        const GLsizei height = std::max(1, m_height >> i);
+
+        bytes += m_image ? static_cast<size_t>(CompressedImage::GetLevelBytes(m_format, width, height))
+                         : static_cast<size_t>(width) * height * ::UNCOMPRESSED_TEXEL_BYTES;
+    }
+
+    return bytes;
+}
+
 void Texture::Processing() {
-    glActiveTexture(m_textureUnit);
-    glBindTexture(GL_TEXTURE_2D, tex);
+    OpenGL::State().BindTexture(m_textureUnit, GL_TEXTURE_2D, tex);
 }
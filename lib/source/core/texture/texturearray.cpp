@@ -0,0 +1,215 @@
+#include "texture/texturearray.h"
+
+#include "app_exceptions.h"
+#include "graphics/opengl.h"
+
+#include <algorithm>
+#include <cmath>
+
+
+namespace {
+
+static const GLsizei INITIAL_CAPACITY { 4 };
+static const GLenum UNCOMPRESSED_FORMAT { GL_RGBA8 };
+static const size_t UNCOMPRESSED_TEXEL_BYTES { 4 };
+
+GLsizei MipLevels(GLsizei width, GLsizei height) {
+    return static_cast<GLsizei>(std::floor(std::log2(std::max(width, height)))) + 1;
+}
+
+} // namespace
+
+
+bool TextureArray::IsCompressed() const {
+    return m_format != ::UNCOMPRESSED_FORMAT;
+}
+
+void TextureArray::Recreate(GLsizei capacity, GLsizei residentLevel) {
+    const GLsizei width = std::max(1, m_width >> residentLevel);
+    const GLsizei height = std::max(1, m_height >> residentLevel);
+
+    GLuint grown {};
+    glCreateTextures(GL_TEXTURE_2D_ARRAY, 1, &grown);
+    glTextureStorage3D(grown, m_levels - residentLevel, m_format, width, height, capacity);
+
+    glTextureParameteri(grown, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTextureParameteri(grown, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTextureParameteri(grown, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTextureParameteri(grown, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    CompressedImage::ApplySwizzle(grown, m_format);
+
+    if (tex) {
+        for (GLsizei source = residentLevel; source < m_levels && m_layers; ++source) {
+            if (source >= m_residentLevel) {
+                glCopyImageSubData(tex, GL_TEXTURE_2D_ARRAY, source - m_residentLevel, 0, 0, 0,
+                                   grown, GL_TEXTURE_2D_ARRAY, source - residentLevel, 0, 0, 0,
+                                   std::max(1, m_width >> source), std::max(1, m_height >> source),
+                                   m_layers);
+                continue;
+            }
+
+            // finer than before, only compressed arrays get here
+            for (GLsizei layer = 0; layer < m_layers; ++layer) {
+                const CompressedImage::Level& data = m_images[layer]->GetLevel(source);
+
+                glCompressedTextureSubImage3D(grown, source - residentLevel, 0, 0, layer,
+                                              data.width, data.height, 1,
+                                              m_format, data.size, data.data);
+            }
+        }
+
+        glDeleteTextures(1, &tex);
+        OpenGL::State().ForgetTexture(tex);
+    }
+
+    tex = grown;
+    m_capacity = capacity;
+    m_residentLevel = residentLevel;
+}
+
+void TextureArray::Reserve(GLsizei capacity) {
+    Recreate(capacity, m_residentLevel);
+}
+
+TextureArray::TextureArray(GLsizei width, GLsizei height, GLenum format) :
+    m_width { width },
+    m_height { height },
+    m_format { format },
+    m_levels { ::MipLevels(width, height) },
+    m_residentLevel {},
+    m_layers {},
+    m_capacity {},
+    m_images {},
+    m_mipmapsDirty {},
+    tex {} {
+    if (IsCompressed()) {
+        m_residentLevel = GetCoarsestLevel(m_width, m_height, m_levels);
+    }
+
+    Reserve(::INITIAL_CAPACITY);
+}
+
+TextureArray::~TextureArray() {
+    glDeleteTextures(1, &tex);
+
+    if (OpenGL::HasState()) {
+        OpenGL::State().ForgetTexture(tex);
+    }
+}
+
+GLenum TextureArray::GetFormat() const {
+    return m_format;
+}
+
+GLsizei TextureArray::GetLayerCount() const {
+    return m_layers;
+}
+
+uint32_t TextureArray::AddLayer(const std::filesystem::path& texturePath, bool flipVertical) {
+    if (IsCompressed()) {
+        throw TextureException { "Image \"" + texturePath.string() + "\" is not compiled for the texture array" };
+    }
+
+    return AddLayer(DecodedImage { texturePath, flipVertical });
+}
+
+uint32_t TextureArray::AddLayer(const DecodedImage& image) {
+    if (IsCompressed()) {
+        throw TextureException { "Image \"" + image.GetPath().string() + "\" is not compiled for the texture array" };
+    }
+
+    if (image.GetWidth() != m_width || image.GetHeight() != m_height) {
+        throw TextureException { "Image \"" + image.GetPath().string() + "\" does not fit the texture array" };
+    }
+
+    if (m_layers == m_capacity) {
+        Reserve(m_capacity * 2);
+    }
+
+    const GLsizei layer = m_layers++;
+
+    glTextureSubImage3D(tex, 0, 0, 0, layer, m_width, m_height, 1,
+                        GL_RGBA, GL_UNSIGNED_BYTE, image.GetPixels());
+    m_mipmapsDirty = true;
+
+    return static_cast<uint32_t>(layer);
+}
+
+uint32_t TextureArray::AddLayer(std::unique_ptr<CompressedImage> image) {
+    if (image->GetWidth() != m_width || image->GetHeight() != m_height ||
+        image->GetFormat() != m_format || image->GetLevelCount() != m_levels) {
+        throw TextureException { "Compressed image does not fit the texture array" };
+    }
+
+    if (m_layers == m_capacity) {
+        Reserve(m_capacity * 2);
+    }
+
+    const GLsizei layer = m_layers++;
+
+    for (GLsizei level = m_residentLevel; level < m_levels; ++level) {
+        const CompressedImage::Level& data = image->GetLevel(level);
+
+        glCompressedTextureSubImage3D(tex, level - m_residentLevel, 0, 0, layer,
+                                      data.width, data.height, 1,
+                                      m_format, data.size, data.data);
+    }
+
+    m_images.push_back(std::move(image));
+
+    return static_cast<uint32_t>(layer);
+}
+
+void TextureArray::UpdateMipmaps() {
+    if (!m_mipmapsDirty) return;
+
+    glGenerateTextureMipmap(tex);
+    m_mipmapsDirty = false;
+}
+
+void TextureArray::Bind(GLenum textureUnit) const {
+    OpenGL::State().BindTexture(textureUnit, GL_TEXTURE_2D_ARRAY, tex);
+}
+
+bool TextureArray::IsStreamable() const {
+    return IsCompressed();
+}
+
+GLsizei TextureArray::GetWidth() const {
+    return m_width;
+}
+
+GLsizei TextureArray::GetHeight() const {
+    return m_height;
+}
+
+GLsizei TextureArray::GetLevelCount() const {
+    return m_levels;
+}
+
+GLsizei TextureArray::GetResidentLevel() const {
+    return m_residentLevel;
+}
+
+void TextureArray::SetResidentLevel(GLsizei level) {
+    if (!IsCompressed()) return;
+
+    level = std::clamp(level, 0, m_levels - 1);
+    if (level == m_residentLevel) return;
+
+    Recreate(m_capacity, level);
+}
+
+size_t TextureArray::GetResidentBytes(GLsizei level) const {
+    size_t bytes { 0 };
+
+    for (GLsizei i = std::max(level, 0); i < m_levels; ++i) {
+        const GLsizei width = std::max(1, m_width >> i);
+        const GLsizei height = std::max(1, m_height >> i);
+
+        bytes += IsCompressed() ? static_cast<size_t>(CompressedImage::GetLevelBytes(m_format, width, height))
+                                : static_cast<size_t>(width) * height * ::UNCOMPRESSED_TEXEL_BYTES;
+    }
+
+    return bytes * static_cast<size_t>(m_capacity);
+}
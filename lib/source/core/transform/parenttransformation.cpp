@@ -52,5 +52,8 @@ const Transform& ParentTransformation::GetParentTransform() const {
 }
 
 void ParentTransformation::SetParentTransform(const Transform& parentTransform) {
+    // static hierarchies hand down the same transform every frame
+    if (m_parentTransform.GetVersion() == parentTransform.GetVersion()) return;
+
     m_parentTransform = parentTransform;
 }
@@ -22,6 +22,9 @@ static const glm::quat DEFAULT_AXIS_ORIENTATION { 0.0f, 0.0f, 0.0f, 1.0f };
 
 } // namespace
 
+
+uint64_t Transform::s_lastVersion {};
+
 void swap(Transform& lhs, Transform& rhs) {
     if (&lhs == &rhs) return;
 
@@ -32,6 +35,9 @@ void swap(Transform& lhs, Transform& rhs) {
     swap(lhs.m_scale, rhs.m_scale);
     swap(lhs.m_axis, rhs.m_axis);
     swap(lhs.m_axisOrientation, rhs.m_axisOrientation);
+    swap(lhs.m_version, rhs.m_version);
+    swap(lhs.m_matrixVersion, rhs.m_matrixVersion);
+    swap(lhs.m_matrix, rhs.m_matrix);
 }
 
 Transform MatrixToTransform(const glm::mat4& matrix) {
@@ -53,18 +59,24 @@ Transform::Transform() :
                 DEFAULT_SCALE } {}
 
 Transform::Transform(const Transform& other) :
-    Transform { other.m_position,
-                other.m_orientation,
-                other.m_scale,
-                other.m_axis,
-                other.m_axisOrientation } {}
+    m_position { other.m_position },
+    m_orientation { other.m_orientation },
+    m_scale { other.m_scale },
+    m_axis { other.m_axis },
+    m_axisOrientation { other.m_axisOrientation },
+    m_version { other.m_version },
+    m_matrixVersion { other.m_matrixVersion },
+    m_matrix { other.m_matrix } {}
 
 Transform::Transform(Transform&& other) noexcept :
-    Transform { std::move(other.m_position),
-                std::move(other.m_orientation),
-                std::move(other.m_scale),
-                std::move(other.m_axis),
-                std::move(other.m_axisOrientation) } {}
+    m_position { std::move(other.m_position) },
+    m_orientation { std::move(other.m_orientation) },
+    m_scale { std::move(other.m_scale) },
+    m_axis { std::move(other.m_axis) },
+    m_axisOrientation { std::move(other.m_axisOrientation) },
+    m_version { other.m_version },
+    m_matrixVersion { other.m_matrixVersion },
+    m_matrix { other.m_matrix } {}
 
 Transform::Transform(const glm::vec3& position,
                      const glm::quat& orientation,
@@ -87,7 +99,10 @@ Transform::Transform(const glm::vec3& position,
     m_orientation { orientation },
     m_scale { scale },
     m_axis { axis },
-    m_axisOrientation { axisOrientation } {
+    m_axisOrientation { axisOrientation },
+    m_version {},
+    m_matrixVersion {},
+    m_matrix { 1.0f } {
     UpdateAxisByAxisOrientation();
 }
 
@@ -100,7 +115,10 @@ Transform::Transform(glm::vec3&& position,
     m_orientation { std::move(orientation) },
     m_scale { std::move(scale) },
     m_axis { std::move(axis) },
-    m_axisOrientation { std::move(axisOrientation) } {
+    m_axisOrientation { std::move(axisOrientation) },
+    m_version {},
+    m_matrixVersion {},
+    m_matrix { 1.0f } {
     UpdateAxisByAxisOrientation();
 }
 
@@ -111,6 +129,9 @@ Transform& Transform::operator=(const Transform& other) {
         m_scale = other.m_scale;
         m_axis = other.m_axis;
         m_axisOrientation = other.m_axisOrientation;
+        m_version = other.m_version;
+        m_matrixVersion = other.m_matrixVersion;
+        m_matrix = other.m_matrix;
     }
 
     return *this;
@@ -123,6 +144,9 @@ Transform& Transform::operator=(Transform&& other) noexcept {
         m_scale = std::move(other.m_scale);
         m_axis = std::move(other.m_axis);
         m_axisOrientation = std::move(other.m_axisOrientation);
+        m_version = other.m_version;
+        m_matrixVersion = other.m_matrixVersion;
+        m_matrix = other.m_matrix;
     }
 
     return *this;
@@ -147,12 +171,12 @@ bool Transform::operator!=(const Transform& other) {
 }
 
 Transform& Transform::operator+=(const Transform& other) {
-    const glm::quat axisOrientation = m_axisOrientation;
-
-    *this = MatrixToTransform(ToMatrix() * other.ToMatrix());
+    // exact for uniform parent scale, the decomposition dropped shear as well
+    m_position += m_orientation * (m_scale * other.m_position);
+    m_orientation = m_orientation * other.m_orientation;
+    m_scale *= other.m_scale;
 
-    SetAxisOrientation(axisOrientation);
-    // UpdateAxisByAxisOrientation();
+    UpdateAxisByAxisOrientation();
 
     return *this;
 }
@@ -200,10 +224,12 @@ glm::vec3 Transform::GetPosition() const {
 
 void Transform::SetPosition(const glm::vec3& position) {
     m_position = position;
+    Touch();
 }
 
 void Transform::AddPosition(const glm::vec3& position) {
     m_position += position;
+    Touch();
 }
 
 glm::quat Transform::GetOrientation() const {
@@ -250,10 +276,12 @@ glm::vec3 Transform::GetScale() const {
 
 void Transform::SetScale(const glm::vec3& scale) {
     m_scale = scale;
+    Touch();
 }
 
 void Transform::AddScale(const glm::vec3& scale) {
     m_scale += scale;
+    Touch();
 }
 
 Axis Transform::GetAxis() const {
@@ -270,7 +298,17 @@ void Transform::SetAxisOrientation(const glm::quat& axisOrientation) {
     UpdateAxisByAxisOrientation();
 }
 
+uint64_t Transform::GetVersion() const {
+    return m_version;
+}
+
+void Transform::Touch() {
+    m_version = ++s_lastVersion;
+}
+
 void Transform::UpdateAxisByAxisOrientation() {
+    Touch();
+
     const glm::quat ORIENTATION_FRONT =
         GetOrientation() * m_axisOrientation * glm::conjugate(GetOrientation());
 
@@ -293,7 +331,18 @@ glm::mat4 Transform::GetScaleMatrix() const {
 }
 
 glm::mat4 Transform::ToMatrix() const {
-    return GetPositionMatrix() * GetOrientationMatrix() * GetScaleMatrix();
+    if (m_matrixVersion != m_version) {
+        m_matrixVersion = m_version;
+
+        // T * R * S without the two full products
+        m_matrix = glm::mat4_cast(m_orientation);
+        m_matrix[0] = m_matrix[0] * m_scale.x;
+        m_matrix[1] = m_matrix[1] * m_scale.y;
+        m_matrix[2] = m_matrix[2] * m_scale.z;
+        m_matrix[3] = glm::vec4 { m_position, 1.0f };
+    }
+
+    return m_matrix;
 }
 
 /* Additional rotation methods */
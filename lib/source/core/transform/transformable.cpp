@@ -1,5 +1,7 @@
 #include "transform/transformable.h"
 
+#include "transform/transformhierarchy.h"
+
 #include <utility>
 
 
@@ -14,16 +16,43 @@ void swap(Transformable& lhs, Transformable& rhs) {
 
 Transformable::Transformable() :
     ParentTransformation {},
-    LocalTransformation {} {}
+    LocalTransformation {},
+    m_globalTransform {},
+    m_globalParentVersion {},
+    m_globalLocalVersion {},
+    m_globalMatrix { 1.0f },
+    m_matrixParentVersion {},
+    m_matrixLocalVersion {},
+    m_hierarchy {},
+    m_hierarchyNode {},
+    m_hierarchyVersion {} {}
 
 
 Transformable::Transformable(const Transformable& other) :
     ParentTransformation { other.m_parentTransform },
-    LocalTransformation { other.m_localTransform } {}
+    LocalTransformation { other.m_localTransform },
+    m_globalTransform {},
+    m_globalParentVersion {},
+    m_globalLocalVersion {},
+    m_globalMatrix { 1.0f },
+    m_matrixParentVersion {},
+    m_matrixLocalVersion {},
+    m_hierarchy {},
+    m_hierarchyNode {},
+    m_hierarchyVersion {} {}
 
 Transformable::Transformable(Transformable&& other) noexcept :
     ParentTransformation { std::move(other.m_parentTransform) },
-    LocalTransformation { std::move(other.m_localTransform) } {}
+    LocalTransformation { std::move(other.m_localTransform) },
+    m_globalTransform {},
+    m_globalParentVersion {},
+    m_globalLocalVersion {},
+    m_globalMatrix { 1.0f },
+    m_matrixParentVersion {},
+    m_matrixLocalVersion {},
+    m_hierarchy {},
+    m_hierarchyNode {},
+    m_hierarchyVersion {} {}
 
 Transformable& Transformable::operator=(const Transformable& other) {
     if (this != &other) {
@@ -45,16 +74,91 @@ Transformable& Transformable::operator=(Transformable&& other) noexcept {
 
 Transformable::Transformable(const Transform& parent, const Transform& local) :
     ParentTransformation { parent },
-    LocalTransformation { local } {}
+    LocalTransformation { local },
+    m_globalTransform {},
+    m_globalParentVersion {},
+    m_globalLocalVersion {},
+    m_globalMatrix { 1.0f },
+    m_matrixParentVersion {},
+    m_matrixLocalVersion {},
+    m_hierarchy {},
+    m_hierarchyNode {},
+    m_hierarchyVersion {} {}
 
 Transformable::Transformable(const ParentTransformation& parent, const LocalTransformation& local) :
     ParentTransformation { parent },
-    LocalTransformation { local } {}
+    LocalTransformation { local },
+    m_globalTransform {},
+    m_globalParentVersion {},
+    m_globalLocalVersion {},
+    m_globalMatrix { 1.0f },
+    m_matrixParentVersion {},
+    m_matrixLocalVersion {},
+    m_hierarchy {},
+    m_hierarchyNode {},
+    m_hierarchyVersion {} {}
+
+const Transform& Transformable::GetGlobalTransform() const {
+    const uint64_t parentVersion = GetParentTransform().GetVersion();
+    const uint64_t localVersion = GetTransform().GetVersion();
+
+    if (parentVersion != m_globalParentVersion || localVersion != m_globalLocalVersion) {
+        m_globalParentVersion = parentVersion;
+        m_globalLocalVersion = localVersion;
+        m_globalTransform = GetParentTransform() + GetTransform();
+    }
+
+    return m_globalTransform;
+}
+
+const glm::mat4& Transformable::GetGlobalMatrix() const {
+    if (m_hierarchy) {
+        // moved since the last update, Scene syncs every node before the next one
+        SyncHierarchy();
+
+        if (!m_hierarchy->IsDirty(m_hierarchyNode)) {
+            return m_hierarchy->GetWorldMatrix(m_hierarchyNode);
+        }
+    }
+
+    const uint64_t parentVersion = GetParentTransform().GetVersion();
+    const uint64_t localVersion = GetTransform().GetVersion();
+
+    if (parentVersion != m_matrixParentVersion || localVersion != m_matrixLocalVersion) {
+        m_matrixParentVersion = parentVersion;
+        m_matrixLocalVersion = localVersion;
+        m_globalMatrix = GetParentTransform().ToMatrix() * GetTransform().ToMatrix();
+    }
 
-Transform Transformable::GetGlobalTransform() {
-    return GetParentTransform() + GetTransform();
+    return m_globalMatrix;
 }
 
-const Transform Transformable::GetGlobalTransform() const {
-    return GetParentTransform() + GetTransform();
+void Transformable::BindHierarchy(TransformHierarchy& hierarchy, uint32_t node) {
+    m_hierarchy = &hierarchy;
+    m_hierarchyNode = node;
+    m_hierarchyVersion = GetTransform().GetVersion();
+}
+
+void Transformable::UnbindHierarchy() {
+    m_hierarchy = nullptr;
+    m_hierarchyNode = 0;
+    m_hierarchyVersion = 0;
+}
+
+bool Transformable::IsInHierarchy() const {
+    return m_hierarchy != nullptr;
+}
+
+uint32_t Transformable::GetHierarchyNode() const {
+    return m_hierarchyNode;
+}
+
+void Transformable::SyncHierarchy() const {
+    if (!m_hierarchy) return;
+
+    const uint64_t version = GetTransform().GetVersion();
+    if (version == m_hierarchyVersion) return;
+
+    m_hierarchyVersion = version;
+    m_hierarchy->SetLocal(m_hierarchyNode, GetTransform());
 }
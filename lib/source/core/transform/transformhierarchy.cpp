@@ -0,0 +1,273 @@
+#include "transform/transformhierarchy.h"
+
+#include "app_exceptions.h"
+
+#include <glm/gtc/quaternion.hpp>
+
+#include <algorithm>
+#include <string>
+
+#if defined(__SSE__) || defined(_M_X64)
+    #include <xmmintrin.h>
+    #define KOFE_TRANSFORM_SSE
+#endif
+
+
+namespace {
+
+static constexpr uint8_t LOCAL_DIRTY { 1 << 0 };
+static constexpr uint8_t WORLD_DIRTY { 1 << 1 };
+
+void Multiply(const glm::mat4& lhs, const glm::mat4& rhs, glm::mat4& result) {
+#ifdef KOFE_TRANSFORM_SSE
+    const float* a = &lhs[0][0];
+    const float* b = &rhs[0][0];
+    float* out = &result[0][0];
+
+    const __m128 column0 = _mm_loadu_ps(a + 0);
+    const __m128 column1 = _mm_loadu_ps(a + 4);
+    const __m128 column2 = _mm_loadu_ps(a + 8);
+    const __m128 column3 = _mm_loadu_ps(a + 12);
+
+    for (int i = 0; i < 4; ++i) {
+        __m128 column = _mm_mul_ps(column0, _mm_set1_ps(b[i * 4 + 0]));
+        column = _mm_add_ps(column, _mm_mul_ps(column1, _mm_set1_ps(b[i * 4 + 1])));
+        column = _mm_add_ps(column, _mm_mul_ps(column2, _mm_set1_ps(b[i * 4 + 2])));
+        column = _mm_add_ps(column, _mm_mul_ps(column3, _mm_set1_ps(b[i * 4 + 3])));
+
+        _mm_storeu_ps(out + i * 4, column);
+    }
+#else
+    result = lhs * rhs;
+#endif
+}
+
+} // namespace
+
+
+TransformHierarchy::TransformHierarchy() :
+    m_positionX {}, m_positionY {}, m_positionZ {},
+    m_orientationX {}, m_orientationY {}, m_orientationZ {}, m_orientationW {},
+    m_scaleX {}, m_scaleY {}, m_scaleZ {},
+    m_parents {},
+    m_dirty {},
+    m_localMatrices {},
+    m_worldMatrices {},
+    m_depths {},
+    m_levelBegins {},
+    m_breadthFirst { true },
+    m_root { 1.0f },
+    m_rootDirty { true } {}
+
+TransformHierarchy::NodeId TransformHierarchy::Add(NodeId parent, const Transform& local) {
+    const size_t node = GetSize();
+
+    if (parent != NO_PARENT && parent >= node) {
+        throw TransformException { "Parent " + std::to_string(parent) +
+                                   " is not in the hierarchy yet." };
+    }
+
+    const uint32_t depth = parent == NO_PARENT ? 0 : m_depths[parent] + 1;
+
+    if (m_levelBegins.empty() || depth == m_levelBegins.size()) {
+        m_levelBegins.push_back(node);
+    } else if (depth + 1 != m_levelBegins.size()) {
+        m_breadthFirst = false;
+    }
+
+    m_positionX.push_back(0.0f); m_positionY.push_back(0.0f); m_positionZ.push_back(0.0f);
+    m_orientationX.push_back(0.0f); m_orientationY.push_back(0.0f);
+    m_orientationZ.push_back(0.0f); m_orientationW.push_back(1.0f);
+    m_scaleX.push_back(1.0f); m_scaleY.push_back(1.0f); m_scaleZ.push_back(1.0f);
+
+    m_parents.push_back(parent);
+    m_dirty.push_back(0);
+    m_localMatrices.emplace_back(1.0f);
+    m_worldMatrices.emplace_back(1.0f);
+    m_depths.push_back(depth);
+
+    SetLocal(static_cast<NodeId>(node), local);
+
+    return static_cast<NodeId>(node);
+}
+
+void TransformHierarchy::SetLocal(NodeId node, const Transform& local) {
+    const glm::vec3 position = local.GetPosition();
+    const glm::quat orientation = local.GetOrientation();
+    const glm::vec3 scale = local.GetScale();
+
+    m_positionX[node] = position.x;
+    m_positionY[node] = position.y;
+    m_positionZ[node] = position.z;
+
+    m_orientationX[node] = orientation.x;
+    m_orientationY[node] = orientation.y;
+    m_orientationZ[node] = orientation.z;
+    m_orientationW[node] = orientation.w;
+
+    m_scaleX[node] = scale.x;
+    m_scaleY[node] = scale.y;
+    m_scaleZ[node] = scale.z;
+
+    m_dirty[node] = ::LOCAL_DIRTY | ::WORLD_DIRTY;
+}
+
+void TransformHierarchy::SetRoot(const glm::mat4& root) {
+    if (root == m_root) return;
+
+    m_root = root;
+    m_rootDirty = true;
+}
+
+void TransformHierarchy::Clear() {
+    m_positionX.clear(); m_positionY.clear(); m_positionZ.clear();
+    m_orientationX.clear(); m_orientationY.clear(); m_orientationZ.clear(); m_orientationW.clear();
+    m_scaleX.clear(); m_scaleY.clear(); m_scaleZ.clear();
+
+    m_parents.clear();
+    m_dirty.clear();
+    m_localMatrices.clear();
+    m_worldMatrices.clear();
+    m_depths.clear();
+    m_levelBegins.clear();
+
+    m_breadthFirst = true;
+    m_rootDirty = true;
+}
+
+size_t TransformHierarchy::GetSize() const {
+    return m_parents.size();
+}
+
+bool TransformHierarchy::IsDirty(NodeId node) const {
+    // a new root reaches every world matrix only on the next update
+    return m_rootDirty || m_dirty[node] != 0;
+}
+
+const glm::mat4& TransformHierarchy::GetWorldMatrix(NodeId node) const {
+    return m_worldMatrices[node];
+}
+
+bool TransformHierarchy::IsBreadthFirst() const {
+    return m_breadthFirst;
+}
+
+size_t TransformHierarchy::GetLevelCount() const {
+    if (m_parents.empty()) return 0;
+
+    // otherwise only the sequential order is safe
+    return m_breadthFirst ? m_levelBegins.size() : 1;
+}
+
+TransformHierarchy::Range TransformHierarchy::GetLevel(size_t level) const {
+    if (!m_breadthFirst) return { 0, GetSize() };
+
+    const size_t end = level + 1 < m_levelBegins.size() ? m_levelBegins[level + 1] : GetSize();
+    return { m_levelBegins[level], end };
+}
+
+void TransformHierarchy::UpdateLocal(size_t begin, size_t end) {
+    size_t i = begin;
+
+#ifdef KOFE_TRANSFORM_SSE
+    // four nodes per step, one lane each, transposed into columns at the end
+    for (; i + 4 <= end; i += 4) {
+        if (!((m_dirty[i] | m_dirty[i + 1] | m_dirty[i + 2] | m_dirty[i + 3]) & ::LOCAL_DIRTY)) {
+            continue;
+        }
+
+        const __m128 x = _mm_loadu_ps(&m_orientationX[i]);
+        const __m128 y = _mm_loadu_ps(&m_orientationY[i]);
+        const __m128 z = _mm_loadu_ps(&m_orientationZ[i]);
+        const __m128 w = _mm_loadu_ps(&m_orientationW[i]);
+
+        const __m128 one = _mm_set1_ps(1.0f);
+        const __m128 two = _mm_set1_ps(2.0f);
+
+        const __m128 xx = _mm_mul_ps(x, x), yy = _mm_mul_ps(y, y), zz = _mm_mul_ps(z, z);
+        const __m128 xy = _mm_mul_ps(x, y), xz = _mm_mul_ps(x, z), yz = _mm_mul_ps(y, z);
+        const __m128 wx = _mm_mul_ps(w, x), wy = _mm_mul_ps(w, y), wz = _mm_mul_ps(w, z);
+
+        const __m128 scaleX = _mm_loadu_ps(&m_scaleX[i]);
+        const __m128 scaleY = _mm_loadu_ps(&m_scaleY[i]);
+        const __m128 scaleZ = _mm_loadu_ps(&m_scaleZ[i]);
+
+        __m128 columns[4][4] {
+            {
+                _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(yy, zz))), scaleX),
+                _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(xy, wz)), scaleX),
+                _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(xz, wy)), scaleX),
+                _mm_setzero_ps()
+            },
+            {
+                _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(xy, wz)), scaleY),
+                _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, zz))), scaleY),
+                _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(yz, wx)), scaleY),
+                _mm_setzero_ps()
+            },
+            {
+                _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(xz, wy)), scaleZ),
+                _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(yz, wx)), scaleZ),
+                _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, yy))), scaleZ),
+                _mm_setzero_ps()
+            },
+            {
+                _mm_loadu_ps(&m_positionX[i]),
+                _mm_loadu_ps(&m_positionY[i]),
+                _mm_loadu_ps(&m_positionZ[i]),
+                one
+            }
+        };
+
+        for (size_t column = 0; column < 4; ++column) {
+            __m128* rows = columns[column];
+            _MM_TRANSPOSE4_PS(rows[0], rows[1], rows[2], rows[3]);
+
+            for (size_t lane = 0; lane < 4; ++lane) {
+                _mm_storeu_ps(&m_localMatrices[i + lane][column][0], rows[lane]);
+            }
+        }
+    }
+#endif
+
+    for (; i < end; ++i) {
+        if (!(m_dirty[i] & ::LOCAL_DIRTY)) continue;
+
+        glm::mat4& local = m_localMatrices[i];
+        local = glm::mat4_cast(glm::quat { m_orientationW[i], m_orientationX[i],
+                                           m_orientationY[i], m_orientationZ[i] });
+        local[0] = local[0] * m_scaleX[i];
+        local[1] = local[1] * m_scaleY[i];
+        local[2] = local[2] * m_scaleZ[i];
+        local[3] = glm::vec4 { m_positionX[i], m_positionY[i], m_positionZ[i], 1.0f };
+    }
+}
+
+void TransformHierarchy::UpdateWorld(size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+        const NodeId parent = m_parents[i];
+
+        if (parent == NO_PARENT) {
+            if (m_rootDirty) m_dirty[i] |= ::WORLD_DIRTY;
+            if (!(m_dirty[i] & ::WORLD_DIRTY)) continue;
+
+            ::Multiply(m_root, m_localMatrices[i], m_worldMatrices[i]);
+        } else {
+            m_dirty[i] |= m_dirty[parent] & ::WORLD_DIRTY;
+            if (!(m_dirty[i] & ::WORLD_DIRTY)) continue;
+
+            ::Multiply(m_worldMatrices[parent], m_localMatrices[i], m_worldMatrices[i]);
+        }
+    }
+}
+
+void TransformHierarchy::ClearDirty() {
+    std::fill(m_dirty.begin(), m_dirty.end(), 0);
+    m_rootDirty = false;
+}
+
+void TransformHierarchy::Update() {
+    UpdateLocal(0, GetSize());
+    UpdateWorld(0, GetSize());
+    ClearDirty();
+}
@@ -0,0 +1,42 @@
+#version 460 core
+
+#ifdef INDEXED_TEXTURES
+// Filled by MaterialTable, slots are x: texture array, y: layer
+struct MaterialRecord {
+    uvec2 diffuse;
+    uvec2 specular;
+    uvec2 emission;
+    float shininess;
+    float padding;
+};
+
+layout (std430, binding = 1) readonly buffer Materials {
+    MaterialRecord materials[];
+};
+
+// One material per draw of a multi draw, so the index is dynamically uniform
+uniform sampler2DArray textureArrays[MAX_TEXTURE_ARRAYS];
+flat in uint MaterialIndex;
+#endif
+
+// Without the material table there is nothing to sample by draw
+const vec3 DEFAULT_ALBEDO = vec3(0.8f);
+
+in vec3 Normal;
+in vec2 TextureCoordinates;
+
+layout (location = 0) out vec4 Albedo;
+layout (location = 1) out vec4 NormalDepth;
+
+void main() {
+#ifdef INDEXED_TEXTURES
+    const uvec2 slot = materials[MaterialIndex].diffuse;
+    const vec3 albedo = texture(textureArrays[slot.x], vec3(TextureCoordinates, float(slot.y))).rgb;
+#else
+    const vec3 albedo = DEFAULT_ALBEDO;
+#endif
+
+    Albedo = vec4(albedo, 1.0f);
+    // The orthographic depth is linear, 0 at the front of the bounding sphere, 1 at its back
+    NormalDepth = vec4(normalize(Normal) * 0.5f + 0.5f, gl_FragCoord.z);
+}
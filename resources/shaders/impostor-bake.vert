@@ -0,0 +1,39 @@
+#version 460 core
+
+struct MVP {
+    mat4 model;
+    mat4 view;
+    mat4 projection;
+};
+
+const uint ATTRIB_POSITION = 0;
+const uint ATTRIB_NORMAL = 1;
+const uint ATTRIB_TEXTURE = 2;
+const uint ATTRIB_INSTANCE_TRANSFORM = 3;
+const uint ATTRIB_INSTANCE_MATERIAL = 7;
+
+layout (location = ATTRIB_POSITION) in vec3 aPosition;
+layout (location = ATTRIB_NORMAL) in vec3 aNormal;
+layout (location = ATTRIB_TEXTURE) in vec2 aTexture;
+layout (location = ATTRIB_INSTANCE_TRANSFORM) in mat4 aTransform;
+#ifdef INDEXED_TEXTURES
+layout (location = ATTRIB_INSTANCE_MATERIAL) in uint aMaterial;
+#endif
+
+// view and projection of the frame being baked, model space is the model data's
+uniform MVP mvp;
+
+out vec3 Normal;
+out vec2 TextureCoordinates;
+#ifdef INDEXED_TEXTURES
+flat out uint MaterialIndex;
+#endif
+
+void main() {
+    gl_Position = mvp.projection * mvp.view * mvp.model * aTransform * vec4(aPosition.xyz, 1.0f);
+    Normal = mat3(transpose(inverse(mvp.model * aTransform))) * aNormal;
+    TextureCoordinates = aTexture;
+#ifdef INDEXED_TEXTURES
+    MaterialIndex = aMaterial;
+#endif
+}
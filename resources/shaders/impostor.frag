@@ -0,0 +1,108 @@
+#version 460 core
+
+struct MVP {
+    mat4 model;
+    mat4 view;
+    mat4 projection;
+};
+
+const int MAX_DIRECTIONAL_LIGHTS = 4;
+const int MAX_POINT_LIGHTS = 12;
+const int MAX_SPOT_LIGHTS = 6;
+
+// Filled once per frame by LightStorage
+layout (std140, binding = 0) uniform Lights {
+    uvec4 lightCounts; // x: directional, y: point, z: spot
+
+    vec4 directionalDirection[MAX_DIRECTIONAL_LIGHTS];
+    vec4 directionalAmbient[MAX_DIRECTIONAL_LIGHTS];
+    vec4 directionalDiffuse[MAX_DIRECTIONAL_LIGHTS];
+    vec4 directionalSpecular[MAX_DIRECTIONAL_LIGHTS];
+
+    vec4 pointPosition[MAX_POINT_LIGHTS];
+    vec4 pointAmbient[MAX_POINT_LIGHTS];
+    vec4 pointDiffuse[MAX_POINT_LIGHTS];
+    vec4 pointSpecular[MAX_POINT_LIGHTS];
+    vec4 pointAttenuation[MAX_POINT_LIGHTS]; // x: constant, y: linear, z: quadratic
+
+    vec4 spotPosition[MAX_SPOT_LIGHTS];
+    vec4 spotDirection[MAX_SPOT_LIGHTS];
+    vec4 spotAmbient[MAX_SPOT_LIGHTS];
+    vec4 spotDiffuse[MAX_SPOT_LIGHTS];
+    vec4 spotSpecular[MAX_SPOT_LIGHTS];
+    vec4 spotAttenuation[MAX_SPOT_LIGHTS]; // x: constant, y: linear, z: quadratic
+    vec4 spotCutoff[MAX_SPOT_LIGHTS]; // x: cutoff, y: outercutoff
+};
+
+// Below this coverage the texel is outside the silhouette
+const float COVERAGE_THRESHOLD = 0.5f;
+
+uniform MVP mvp;
+uniform vec4 sphere; // model space center, radius in w
+
+// Cleared to zero, so the mip levels hold everything premultiplied by the coverage
+uniform sampler2D albedoAtlas;
+uniform sampler2D normalDepthAtlas;
+
+in vec2 AtlasCoordinates;
+in vec3 QuadPosition;
+flat in vec3 FrameDirection;
+flat in mat4 Transform;
+flat in mat3 NormalMatrix;
+
+out vec4 FragColor;
+
+float Attenuation(vec4 attenuation, float lightDistance) {
+    return 1.0f / (attenuation.x + attenuation.y * lightDistance + attenuation.z * pow(lightDistance, 2));
+}
+
+// No specular, the atlas keeps none
+vec3 ApplyLights(vec3 position, vec3 normal, vec3 albedo) {
+    vec3 result = vec3(0.0f);
+
+    for (uint i = 0; i < lightCounts.x; i++) {
+        const float diff = max(dot(normal, normalize(-directionalDirection[i].xyz)), 0.0f);
+        result += (directionalAmbient[i].rgb + directionalDiffuse[i].rgb * diff) * albedo;
+    }
+
+    for (uint i = 0; i < lightCounts.y; i++) {
+        const vec3 lightDirection = normalize(pointPosition[i].xyz - position);
+        const float diff = max(dot(normal, lightDirection), 0.0f);
+        const float attenuation = Attenuation(pointAttenuation[i], distance(pointPosition[i].xyz, position));
+
+        result += (pointAmbient[i].rgb + pointDiffuse[i].rgb * diff) * albedo * attenuation;
+    }
+
+    for (uint i = 0; i < lightCounts.z; i++) {
+        const vec3 lightDirection = normalize(spotPosition[i].xyz - position);
+        const float diff = max(dot(normal, lightDirection), 0.0f);
+        const float attenuation = Attenuation(spotAttenuation[i], distance(spotPosition[i].xyz, position));
+
+        const float theta = dot(lightDirection, normalize(-spotDirection[i].xyz));
+        const float epsilon = spotCutoff[i].x - spotCutoff[i].y;
+        const float intencity = clamp((theta - spotCutoff[i].y) / epsilon, 0.0f, 1.0f);
+
+        result += (spotAmbient[i].rgb + spotDiffuse[i].rgb * diff) * albedo * attenuation * intencity;
+    }
+
+    return result;
+}
+
+void main() {
+    const vec4 albedo = texture(albedoAtlas, AtlasCoordinates);
+    if (albedo.a < COVERAGE_THRESHOLD) discard;
+
+    const vec4 normalDepth = texture(normalDepthAtlas, AtlasCoordinates) / albedo.a;
+
+    // Back from the front of the bounding sphere by the baked share of its diameter
+    const vec3 localPosition = QuadPosition + FrameDirection * sphere.w * (1.0f - 2.0f * normalDepth.w);
+    const vec4 position = Transform * vec4(localPosition, 1.0f);
+
+    // The surface depth instead of the quad's, so impostors intersect like meshes
+    const vec4 clipPosition = mvp.projection * mvp.view * position;
+    gl_FragDepth = clipPosition.z / clipPosition.w * 0.5f + 0.5f;
+
+    const vec3 normal = normalize(NormalMatrix * (normalDepth.xyz * 2.0f - 1.0f));
+
+    FragColor = vec4(ApplyLights(position.xyz, normal, albedo.rgb / albedo.a), 1.0f);
+}
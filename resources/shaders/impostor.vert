@@ -0,0 +1,78 @@
+#version 460 core
+
+struct MVP {
+    mat4 model;
+    mat4 view;
+    mat4 projection;
+};
+
+// Filled per impostor by ImpostorStorage, one model transform per instance
+layout (std430, binding = 2) readonly buffer ImpostorInstances {
+    mat4 instanceTransforms[];
+};
+
+// Past this the up of the frame camera turns from y to z
+const float POLE_COSINE = 0.999f;
+
+// A triangle strip facing the frame direction
+const vec2 CORNERS[4] = vec2[](
+    vec2(-1.0f, -1.0f), vec2(1.0f, -1.0f), vec2(-1.0f, 1.0f), vec2(1.0f, 1.0f)
+);
+
+uniform MVP mvp;
+uniform vec3 cameraPosition;
+uniform vec4 sphere; // model space center, radius in w
+
+out vec2 AtlasCoordinates;
+out vec3 QuadPosition; // model space
+flat out vec3 FrameDirection;
+flat out mat4 Transform;
+flat out mat3 NormalMatrix;
+
+vec2 SignNotZero(vec2 value) {
+    return vec2(value.x < 0.0f ? -1.0f : 1.0f, value.y < 0.0f ? -1.0f : 1.0f);
+}
+
+// Same mapping as Impostor::GetFrameDirection, the lower half folded over the corners
+vec3 DecodeOctahedron(vec2 octahedron) {
+    vec3 direction = vec3(octahedron.x, 1.0f - abs(octahedron.x) - abs(octahedron.y), octahedron.y);
+
+    if (direction.y < 0.0f) {
+        direction.xz = (1.0f - abs(octahedron.yx)) * SignNotZero(octahedron);
+    }
+
+    return normalize(direction);
+}
+
+vec2 EncodeOctahedron(vec3 direction) {
+    direction /= abs(direction.x) + abs(direction.y) + abs(direction.z);
+
+    return direction.y < 0.0f
+        ? (1.0f - abs(direction.zx)) * SignNotZero(direction.xz)
+        : direction.xz;
+}
+
+void main() {
+    Transform = mvp.model * instanceTransforms[gl_InstanceID];
+    NormalMatrix = mat3(transpose(inverse(Transform)));
+
+    const vec3 localCamera = vec3(inverse(Transform) * vec4(cameraPosition, 1.0f));
+    const vec3 viewDirection = normalize(localCamera - sphere.xyz);
+
+    // The baked frame closest to the view, the whole quad takes the same one
+    const float lastFrame = float(IMPOSTOR_FRAMES - 1);
+    const vec2 frame = clamp(round((EncodeOctahedron(viewDirection) * 0.5f + 0.5f) * lastFrame),
+                             vec2(0.0f), vec2(lastFrame));
+    FrameDirection = DecodeOctahedron(frame / lastFrame * 2.0f - 1.0f);
+
+    // The basis glm::lookAt builds for Impostor::GetFrameUp
+    const vec3 lookUp = abs(FrameDirection.y) > POLE_COSINE ? vec3(0.0f, 0.0f, -1.0f) : vec3(0.0f, 1.0f, 0.0f);
+    const vec3 right = normalize(cross(lookUp, FrameDirection));
+    const vec3 up = cross(FrameDirection, right);
+
+    const vec2 corner = CORNERS[gl_VertexID];
+    QuadPosition = sphere.xyz + (right * corner.x + up * corner.y) * sphere.w;
+    AtlasCoordinates = (frame + corner * 0.5f + 0.5f) / float(IMPOSTOR_FRAMES);
+
+    gl_Position = mvp.projection * mvp.view * Transform * vec4(QuadPosition, 1.0f);
+}
@@ -9,17 +9,18 @@ struct MVP {
 const uint ATTRIB_POSITION = 0;
 const uint ATTRIB_NORMAL = 1;
 const uint ATTRIB_TEXTURE = 2;
+const uint ATTRIB_INSTANCE_TRANSFORM = 3;
 
 layout (location = ATTRIB_POSITION) in vec3 aPosition;
 layout (location = ATTRIB_NORMAL) in vec3 aNormal;
 layout (location = ATTRIB_TEXTURE) in vec2 aTexture;
+layout (location = ATTRIB_INSTANCE_TRANSFORM) in mat4 aTransform;
 
 uniform MVP mvp;
-uniform mat4 transform;
 
 out vec3 FragPos;
 
 void main() {
-    gl_Position = mvp.projection * mvp.view * mvp.model * transform * vec4(aPosition.xyz, 1.0f);
-    FragPos = vec3(mvp.model * transform * vec4(aPosition.xyz, 1.0f));
+    gl_Position = mvp.projection * mvp.view * mvp.model * aTransform * vec4(aPosition.xyz, 1.0f);
+    FragPos = vec3(mvp.model * aTransform * vec4(aPosition.xyz, 1.0f));
 }
@@ -7,51 +7,37 @@ struct Material {
     float shininess;
 };
 
-struct DirectionalLight {
-    vec3 direction;
-    vec3 ambient;
-    vec3 diffuse;
-    vec3 specular;
-};
-
-struct PointLight {
-    vec3 position;
-    vec3 ambient;
-    vec3 diffuse;
-    vec3 specular;
-    float constant;
-    float linear;
-    float quadratic;
-};
-
-struct SpotLight {
-    vec3 position;
-    vec3 direction;
-    float cutoff;
-    float outercutoff;
-    vec3 ambient;
-    vec3 diffuse;
-    vec3 specular;
-    float constant;
-    float linear;
-    float quadratic;
-};
-
 const int MAX_DIRECTIONAL_LIGHTS = 4;
 const int MAX_POINT_LIGHTS = 12;
 const int MAX_SPOT_LIGHTS = 6;
 
+// Filled once per frame by LightStorage
+layout (std140, binding = 0) uniform Lights {
+    uvec4 lightCounts; // x: directional, y: point, z: spot
+
+    vec4 directionalDirection[MAX_DIRECTIONAL_LIGHTS];
+    vec4 directionalAmbient[MAX_DIRECTIONAL_LIGHTS];
+    vec4 directionalDiffuse[MAX_DIRECTIONAL_LIGHTS];
+    vec4 directionalSpecular[MAX_DIRECTIONAL_LIGHTS];
+
+    vec4 pointPosition[MAX_POINT_LIGHTS];
+    vec4 pointAmbient[MAX_POINT_LIGHTS];
+    vec4 pointDiffuse[MAX_POINT_LIGHTS];
+    vec4 pointSpecular[MAX_POINT_LIGHTS];
+    vec4 pointAttenuation[MAX_POINT_LIGHTS]; // x: constant, y: linear, z: quadratic
+
+    vec4 spotPosition[MAX_SPOT_LIGHTS];
+    vec4 spotDirection[MAX_SPOT_LIGHTS];
+    vec4 spotAmbient[MAX_SPOT_LIGHTS];
+    vec4 spotDiffuse[MAX_SPOT_LIGHTS];
+    vec4 spotSpecular[MAX_SPOT_LIGHTS];
+    vec4 spotAttenuation[MAX_SPOT_LIGHTS]; // x: constant, y: linear, z: quadratic
+    vec4 spotCutoff[MAX_SPOT_LIGHTS]; // x: cutoff, y: outercutoff
+};
+
 uniform Material material;
 uniform vec3 cameraPosition;
 
-uniform DirectionalLight directionalLights[MAX_DIRECTIONAL_LIGHTS];
-uniform PointLight pointLights[MAX_POINT_LIGHTS];
-uniform SpotLight spotLights[MAX_SPOT_LIGHTS];
-
-uniform uint directionalLightArraySize;
-uniform uint pointLightArraySize;
-uniform uint spotLightArraySize;
-
 in vec3 FragPos;
 in vec3 Normal;
 
@@ -60,20 +46,18 @@ out vec4 FragColor;
 void ApplyDirectionalLights(inout vec3 result) {
     const vec3 NORM = normalize(Normal);
 
-    for (uint i = 0; i < directionalLightArraySize; i++) {
-        const DirectionalLight directionalLight = directionalLights[i];
-
-        const vec3 ambient = directionalLight.ambient * material.ambient;
+    for (uint i = 0; i < lightCounts.x; i++) {
+        const vec3 ambient = directionalAmbient[i].rgb * material.ambient;
 
-        const vec3 lightDirection = normalize(-directionalLight.direction);
+        const vec3 lightDirection = normalize(-directionalDirection[i].xyz);
         const float diff = max(dot(NORM, lightDirection), 0.0f);
-        const vec3 diffuse = directionalLight.diffuse * (diff * material.diffuse);
+        const vec3 diffuse = directionalDiffuse[i].rgb * (diff * material.diffuse);
 
         const vec3 viewDirection = normalize(cameraPosition - FragPos);
         // Reflection vector along the normal axis
         const vec3 reflectDirection = reflect(-lightDirection, NORM);
         const float spec = pow(max(dot(viewDirection, reflectDirection), 0.0), material.shininess);
-        const vec3 specular = directionalLight.specular * (spec * material.specular);
+        const vec3 specular = directionalSpecular[i].rgb * (spec * material.specular);
 
         result += ambient + diffuse + specular;
     }
@@ -82,23 +66,21 @@ void ApplyDirectionalLights(inout vec3 result) {
 void ApplyPointLights(inout vec3 result) {
     const vec3 NORM = normalize(Normal);
 
-    for (uint i = 0; i < pointLightArraySize; i++) {
-        const PointLight pointLight = pointLights[i];
+    for (uint i = 0; i < lightCounts.y; i++) {
+        vec3 ambient = pointAmbient[i].rgb * material.ambient;
 
-        vec3 ambient = pointLight.ambient * material.ambient;
-
-        const vec3 lightDirection = normalize(pointLight.position - FragPos);
+        const vec3 lightDirection = normalize(pointPosition[i].xyz - FragPos);
         const float diff = max(dot(NORM, lightDirection), 0.0f);
-        vec3 diffuse = pointLight.diffuse * (diff * material.diffuse);
+        vec3 diffuse = pointDiffuse[i].rgb * (diff * material.diffuse);
 
         const vec3 viewDirection = normalize(cameraPosition - FragPos);
         // Reflection vector along the normal axis
         const vec3 reflectDirection = reflect(-lightDirection, NORM);
         const float spec = pow(max(dot(viewDirection, reflectDirection), 0.0), material.shininess);
-        vec3 specular = pointLight.specular * (spec * material.specular);
+        vec3 specular = pointSpecular[i].rgb * (spec * material.specular);
 
-        const float DISTANCE = distance(pointLight.position, FragPos);
-        const float attenuation = 1.0f / (pointLight.constant + pointLight.linear * DISTANCE + pointLight.quadratic * pow(DISTANCE, 2));
+        const float DISTANCE = distance(pointPosition[i].xyz, FragPos);
+        const float attenuation = 1.0f / (pointAttenuation[i].x + pointAttenuation[i].y * DISTANCE + pointAttenuation[i].z * pow(DISTANCE, 2));
 
         result += attenuation * (ambient + diffuse + specular);
     }
@@ -107,27 +89,25 @@ void ApplyPointLights(inout vec3 result) {
 void ApplySpotLights(inout vec3 result) {
     const vec3 NORM = normalize(Normal);
 
-    for (uint i = 0; i < spotLightArraySize; i++) {
-        const SpotLight spotLight = spotLights[i];
-
-        vec3 ambient = spotLight.ambient * material.ambient;
+    for (uint i = 0; i < lightCounts.z; i++) {
+        vec3 ambient = spotAmbient[i].rgb * material.ambient;
 
-        const vec3 lightDirection = normalize(spotLight.position - FragPos);
+        const vec3 lightDirection = normalize(spotPosition[i].xyz - FragPos);
         const float diff = max(dot(NORM, lightDirection), 0.0f);
-        vec3 diffuse = spotLight.diffuse * (diff * material.diffuse);
+        vec3 diffuse = spotDiffuse[i].rgb * (diff * material.diffuse);
 
         const vec3 viewDirection = normalize(cameraPosition - FragPos);
         // Reflection vector along the normal axis
         const vec3 reflectDirection = reflect(-lightDirection, NORM);
         const float spec = pow(max(dot(viewDirection, reflectDirection), 0.0), material.shininess);
-        vec3 specular = spotLight.specular * (spec * material.specular);
+        vec3 specular = spotSpecular[i].rgb * (spec * material.specular);
 
-        const float theta = dot(lightDirection, normalize(-spotLight.direction));
-        const float epsilon = spotLight.cutoff - spotLight.outercutoff;
-        const float intencity = clamp((theta - spotLight.outercutoff) / epsilon, 0.0f, 1.0f);
+        const float theta = dot(lightDirection, normalize(-spotDirection[i].xyz));
+        const float epsilon = spotCutoff[i].x - spotCutoff[i].y;
+        const float intencity = clamp((theta - spotCutoff[i].y) / epsilon, 0.0f, 1.0f);
 
-        const float DISTANCE = distance(spotLight.position, FragPos);
-        const float attenuation = 1.0f / (spotLight.constant + spotLight.linear * DISTANCE + spotLight.quadratic * pow(DISTANCE, 2));
+        const float DISTANCE = distance(spotPosition[i].xyz, FragPos);
+        const float attenuation = 1.0f / (spotAttenuation[i].x + spotAttenuation[i].y * DISTANCE + spotAttenuation[i].z * pow(DISTANCE, 2));
 
         result += (ambient + diffuse + specular) * attenuation * intencity;
     }
@@ -1,56 +1,62 @@
 #version 460 core
 
-struct Material {
-    sampler2D diffuse;
-    sampler2D specular;
-    sampler2D emission;
+#ifdef INDEXED_TEXTURES
+// Filled by MaterialTable, slots are x: texture array, y: layer
+struct MaterialRecord {
+    uvec2 diffuse;
+    uvec2 specular;
+    uvec2 emission;
     float shininess;
+    float padding;
 };
 
-struct DirectionalLight {
-    vec3 direction;
-    vec3 ambient;
-    vec3 diffuse;
-    vec3 specular;
+layout (std430, binding = 1) readonly buffer Materials {
+    MaterialRecord materials[];
 };
 
-struct PointLight {
-    vec3 position;
-    vec3 ambient;
-    vec3 diffuse;
-    vec3 specular;
-    float constant;
-    float linear;
-    float quadratic;
+// One material per draw of a multi draw, so the index is dynamically uniform
+uniform sampler2DArray textureArrays[MAX_TEXTURE_ARRAYS];
+flat in uint MaterialIndex;
+#else
+struct Material {
+    sampler2D diffuse;
+    sampler2D specular;
+    sampler2D emission;
+    float shininess;
 };
 
-struct SpotLight {
-    vec3 position;
-    vec3 direction;
-    float cutoff;
-    float outercutoff;
-    vec3 ambient;
-    vec3 diffuse;
-    vec3 specular;
-    float constant;
-    float linear;
-    float quadratic;
-};
+uniform Material material;
+#endif
 
 const int MAX_DIRECTIONAL_LIGHTS = 4;
 const int MAX_POINT_LIGHTS = 12;
 const int MAX_SPOT_LIGHTS = 6;
 
-uniform Material material;
-uniform vec3 cameraPosition;
-
-uniform DirectionalLight directionalLights[MAX_DIRECTIONAL_LIGHTS];
-uniform PointLight pointLights[MAX_POINT_LIGHTS];
-uniform SpotLight spotLights[MAX_SPOT_LIGHTS];
+// Filled once per frame by LightStorage
+layout (std140, binding = 0) uniform Lights {
+    uvec4 lightCounts; // x: directional, y: point, z: spot
+
+    vec4 directionalDirection[MAX_DIRECTIONAL_LIGHTS];
+    vec4 directionalAmbient[MAX_DIRECTIONAL_LIGHTS];
+    vec4 directionalDiffuse[MAX_DIRECTIONAL_LIGHTS];
+    vec4 directionalSpecular[MAX_DIRECTIONAL_LIGHTS];
+
+    vec4 pointPosition[MAX_POINT_LIGHTS];
+    vec4 pointAmbient[MAX_POINT_LIGHTS];
+    vec4 pointDiffuse[MAX_POINT_LIGHTS];
+    vec4 pointSpecular[MAX_POINT_LIGHTS];
+    vec4 pointAttenuation[MAX_POINT_LIGHTS]; // x: constant, y: linear, z: quadratic
+
+    vec4 spotPosition[MAX_SPOT_LIGHTS];
+    vec4 spotDirection[MAX_SPOT_LIGHTS];
+    vec4 spotAmbient[MAX_SPOT_LIGHTS];
+    vec4 spotDiffuse[MAX_SPOT_LIGHTS];
+    vec4 spotSpecular[MAX_SPOT_LIGHTS];
+    vec4 spotAttenuation[MAX_SPOT_LIGHTS]; // x: constant, y: linear, z: quadratic
+    vec4 spotCutoff[MAX_SPOT_LIGHTS]; // x: cutoff, y: outercutoff
+};
 
-uniform uint directionalLightArraySize;
-uniform uint pointLightArraySize;
-uniform uint spotLightArraySize;
+uniform vec3 cameraPosition;
 
 in vec3 FragPos;
 in vec3 Normal;
@@ -58,23 +64,37 @@ in vec2 TextureCoordinates;
 
 out vec4 FragColor;
 
+#ifdef INDEXED_TEXTURES
+vec3 SampleSlot(uvec2 slot) {
+    return texture(textureArrays[slot.x], vec3(TextureCoordinates, float(slot.y))).rgb;
+}
+
+vec3 DiffuseColor() { return SampleSlot(materials[MaterialIndex].diffuse); }
+vec3 SpecularColor() { return SampleSlot(materials[MaterialIndex].specular); }
+vec3 EmissionColor() { return SampleSlot(materials[MaterialIndex].emission); }
+float Shininess() { return materials[MaterialIndex].shininess; }
+#else
+vec3 DiffuseColor() { return texture(material.diffuse, TextureCoordinates).rgb; }
+vec3 SpecularColor() { return texture(material.specular, TextureCoordinates).rgb; }
+vec3 EmissionColor() { return texture(material.emission, TextureCoordinates).rgb; }
+float Shininess() { return material.shininess; }
+#endif
+
 void ApplyDirectionalLights(inout vec3 result) {
     const vec3 NORM = normalize(Normal);
     
-    for (uint i = 0; i < directionalLightArraySize; i++) {
-        const DirectionalLight directionalLight = directionalLights[i];
-
-        const vec3 ambient = directionalLight.ambient * texture(material.diffuse, TextureCoordinates).rgb;
+    for (uint i = 0; i < lightCounts.x; i++) {
+        const vec3 ambient = directionalAmbient[i].rgb * DiffuseColor();
 
-        const vec3 lightDirection = normalize(-directionalLight.direction);
+        const vec3 lightDirection = normalize(-directionalDirection[i].xyz);
         const float diff = max(dot(NORM, lightDirection), 0.0f);
-        const vec3 diffuse = directionalLight.diffuse * diff * texture(material.diffuse, TextureCoordinates).rgb;
+        const vec3 diffuse = directionalDiffuse[i].rgb * diff * DiffuseColor();
 
         const vec3 viewDirection = normalize(cameraPosition - FragPos);
         // Reflection vector along the normal axis
         const vec3 reflectDirection = reflect(-lightDirection, NORM);
-        const float spec = pow(max(dot(viewDirection, reflectDirection), 0.0), material.shininess);
-        const vec3 specular = directionalLight.specular * spec * texture(material.specular, TextureCoordinates).rgb;
+        const float spec = pow(max(dot(viewDirection, reflectDirection), 0.0), Shininess());
+        const vec3 specular = directionalSpecular[i].rgb * spec * SpecularColor();
 
         result += ambient + diffuse + specular;
     }
@@ -83,23 +103,21 @@ void ApplyDirectionalLights(inout vec3 result) {
 void ApplyPointLights(inout vec3 result) {
     const vec3 NORM = normalize(Normal);
     
-    for (uint i = 0; i < pointLightArraySize; i++) {
-        const PointLight pointLight = pointLights[i];
+    for (uint i = 0; i < lightCounts.y; i++) {
+        vec3 ambient = pointAmbient[i].rgb * DiffuseColor();
 
-        vec3 ambient = pointLight.ambient * texture(material.diffuse, TextureCoordinates).rgb;
-
-        const vec3 lightDirection = normalize(pointLight.position - FragPos);
+        const vec3 lightDirection = normalize(pointPosition[i].xyz - FragPos);
         const float diff = max(dot(NORM, lightDirection), 0.0f);
-        vec3 diffuse = pointLight.diffuse * diff * texture(material.diffuse, TextureCoordinates).rgb;
+        vec3 diffuse = pointDiffuse[i].rgb * diff * DiffuseColor();
 
         const vec3 viewDirection = normalize(cameraPosition - FragPos);
         // Reflection vector along the normal axis
         const vec3 reflectDirection = reflect(-lightDirection, NORM);
-        const float spec = pow(max(dot(viewDirection, reflectDirection), 0.0), material.shininess);
-        vec3 specular = pointLight.specular * spec * texture(material.specular, TextureCoordinates).rgb;
+        const float spec = pow(max(dot(viewDirection, reflectDirection), 0.0), Shininess());
+        vec3 specular = pointSpecular[i].rgb * spec * SpecularColor();
 
-        const float DISTANCE = distance(pointLight.position, FragPos);
-        const float attenuation = 1.0f / (pointLight.constant + pointLight.linear * DISTANCE + pointLight.quadratic * pow(DISTANCE, 2));
+        const float DISTANCE = distance(pointPosition[i].xyz, FragPos);
+        const float attenuation = 1.0f / (pointAttenuation[i].x + pointAttenuation[i].y * DISTANCE + pointAttenuation[i].z * pow(DISTANCE, 2));
 
         result += attenuation * (ambient + diffuse + specular);
     }
@@ -108,35 +126,33 @@ void ApplyPointLights(inout vec3 result) {
 void ApplySpotLights(inout vec3 result) {
     const vec3 NORM = normalize(Normal);
     
-    for (uint i = 0; i < spotLightArraySize; i++) {
-        const SpotLight spotLight = spotLights[i];
-
-        vec3 ambient = spotLight.ambient * texture(material.diffuse, TextureCoordinates).rgb;
+    for (uint i = 0; i < lightCounts.z; i++) {
+        vec3 ambient = spotAmbient[i].rgb * DiffuseColor();
 
-        const vec3 lightDirection = normalize(spotLight.position - FragPos);
+        const vec3 lightDirection = normalize(spotPosition[i].xyz - FragPos);
         const float diff = max(dot(NORM, lightDirection), 0.0f);
-        vec3 diffuse = spotLight.diffuse * diff * texture(material.diffuse, TextureCoordinates).rgb;
+        vec3 diffuse = spotDiffuse[i].rgb * diff * DiffuseColor();
 
         const vec3 viewDirection = normalize(cameraPosition - FragPos);
         // Reflection vector along the normal axis
         const vec3 reflectDirection = reflect(-lightDirection, NORM);
-        const float spec = pow(max(dot(viewDirection, reflectDirection), 0.0f), material.shininess);
-        vec3 specular = spotLight.specular * spec * texture(material.specular, TextureCoordinates).rgb;
+        const float spec = pow(max(dot(viewDirection, reflectDirection), 0.0f), Shininess());
+        vec3 specular = spotSpecular[i].rgb * spec * SpecularColor();
 
-        const float theta = dot(lightDirection, normalize(-spotLight.direction));
-        const float epsilon = spotLight.cutoff - spotLight.outercutoff;
-        const float intencity = clamp((theta - spotLight.outercutoff) / epsilon, 0.0f, 1.0f);
+        const float theta = dot(lightDirection, normalize(-spotDirection[i].xyz));
+        const float epsilon = spotCutoff[i].x - spotCutoff[i].y;
+        const float intencity = clamp((theta - spotCutoff[i].y) / epsilon, 0.0f, 1.0f);
 
-        const float DISTANCE = distance(spotLight.position, FragPos);
-        const float attenuation = 1.0f / (spotLight.constant + spotLight.linear * DISTANCE + spotLight.quadratic * pow(DISTANCE, 2));
+        const float DISTANCE = distance(spotPosition[i].xyz, FragPos);
+        const float attenuation = 1.0f / (spotAttenuation[i].x + spotAttenuation[i].y * DISTANCE + spotAttenuation[i].z * pow(DISTANCE, 2));
 
         result += (ambient + diffuse + specular) * attenuation * intencity;
     }
 }
 
 void ApplyEmission(inout vec3 result) {
-    const vec3 emissionFactor = step(vec3(1.0f), vec3(1.0f) - vec3(texture(material.specular, TextureCoordinates)));
-    const vec3 emission = vec3(texture(material.emission, TextureCoordinates)) * emissionFactor;
+    const vec3 emissionFactor = step(vec3(1.0f), vec3(1.0f) - SpecularColor());
+    const vec3 emission = EmissionColor() * emissionFactor;
 
     result += emission;
 }
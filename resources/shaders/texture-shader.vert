@@ -9,22 +9,33 @@ struct MVP {
 const uint ATTRIB_POSITION = 0;
 const uint ATTRIB_NORMAL = 1;
 const uint ATTRIB_TEXTURE = 2;
+const uint ATTRIB_INSTANCE_TRANSFORM = 3;
+const uint ATTRIB_INSTANCE_MATERIAL = 7;
 
 layout (location = ATTRIB_POSITION) in vec3 aPosition;
 layout (location = ATTRIB_NORMAL) in vec3 aNormal;
 layout (location = ATTRIB_TEXTURE) in vec2 aTexture;
+layout (location = ATTRIB_INSTANCE_TRANSFORM) in mat4 aTransform;
+#ifdef INDEXED_TEXTURES
+layout (location = ATTRIB_INSTANCE_MATERIAL) in uint aMaterial;
+#endif
 
 uniform MVP mvp;
-uniform mat4 transform;
 
 out vec3 FragPos;
 out vec3 Normal;
 out vec2 TextureCoordinates;
+#ifdef INDEXED_TEXTURES
+flat out uint MaterialIndex;
+#endif
 
 void main() {
-    gl_Position = mvp.projection * mvp.view * mvp.model * transform * vec4(aPosition.xyz, 1.0f);
-    FragPos = vec3(mvp.model * transform * vec4(aPosition.xyz, 1.0f));
+    gl_Position = mvp.projection * mvp.view * mvp.model * aTransform * vec4(aPosition.xyz, 1.0f);
+    FragPos = vec3(mvp.model * aTransform * vec4(aPosition.xyz, 1.0f));
     // Adjust aNormal to the transformed aPosition
-    Normal = mat3(transpose(inverse(mvp.model * transform))) * aNormal;
+    Normal = mat3(transpose(inverse(mvp.model * aTransform))) * aNormal;
     TextureCoordinates = aTexture;
+#ifdef INDEXED_TEXTURES
+    MaterialIndex = aMaterial;
+#endif
 }
@@ -0,0 +1,122 @@
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <typeinfo>
+#include <unordered_map>
+#include <utility>
+
+#include <everywhere/everywhere.h>
+
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+static constexpr size_t DEFAULT_ITERATIONS { 10'000'000 };
+// about as many units as the application registers
+static constexpr size_t UNIT_COUNT { 20 };
+static constexpr size_t LOOKUPS_PER_ITERATION { 4 };
+
+volatile size_t g_sink {};
+
+
+template <size_t N>
+struct BenchUnit final : public ICanBeEverywhere {
+    size_t value { N };
+};
+
+
+// Everywhere before the per-type slots: typeid name, two hash lookups, dynamic_cast
+class StringLookup final {
+private:
+    std::unordered_map<std::string, ICanBeEverywhere*> m_units;
+
+    template <typename T>
+    static std::string ClassName() {
+        static const std::string CLASS_NAME { typeid(T).name() };
+        return CLASS_NAME;
+    }
+
+public:
+    template <typename U>
+    void Init(U* unit) {
+        m_units[ClassName<U>()] = unit;
+    }
+
+    template <typename U>
+    U& Get() {
+        if (!m_units.count(ClassName<U>())) {
+            throw EverywhereException { "Unit \"" + ClassName<U>() + "\" is not exists" };
+        }
+
+        return *dynamic_cast<U*>(m_units.at(ClassName<U>()));
+    }
+};
+
+
+template <size_t... N>
+void InitUnits(StringLookup& lookup, std::index_sequence<N...>) {
+    (Everywhere::Instance().Init<BenchUnit<N>>(new BenchUnit<N> {}), ...);
+    (lookup.Init<BenchUnit<N>>(&Everywhere::Instance().Get<BenchUnit<N>>()), ...);
+}
+
+template <size_t... N>
+void FreeUnits(std::index_sequence<N...>) {
+    (Everywhere::Instance().Free<BenchUnit<N>>(), ...);
+}
+
+// nanoseconds per lookup
+template <typename Lookup>
+double Measure(size_t iterations, Lookup lookup) {
+    size_t sum { 0 };
+
+    const Clock::time_point begin = Clock::now();
+
+    for (size_t i = 0; i < iterations; ++i) {
+        sum += lookup();
+    }
+
+    const std::chrono::duration<double, std::nano> elapsed { Clock::now() - begin };
+    g_sink = g_sink + sum;
+
+    return elapsed.count() / static_cast<double>(iterations * ::LOOKUPS_PER_ITERATION);
+}
+
+} // namespace
+
+
+// times Everywhere::Get<T>() against the string keyed lookup it replaced,
+// the optional argument is the iteration count
+int main(int argc, char** argv) {
+    const size_t iterations = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : ::DEFAULT_ITERATIONS;
+
+    if (!iterations) {
+        std::cerr << "[Error] \"" << argv[1] << "\" is not an iteration count" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    StringLookup stringLookup {};
+    ::InitUnits(stringLookup, std::make_index_sequence<::UNIT_COUNT> {});
+
+    // spread over the table, the way the main loop reaches different units
+    const double slotTime = ::Measure(iterations, [] {
+        Everywhere& everywhere = Everywhere::Instance();
+        return everywhere.Get<BenchUnit<0>>().value + everywhere.Get<BenchUnit<7>>().value +
+               everywhere.Get<BenchUnit<13>>().value + everywhere.Get<BenchUnit<19>>().value;
+    });
+
+    const double stringTime = ::Measure(iterations, [&stringLookup] {
+        return stringLookup.Get<BenchUnit<0>>().value + stringLookup.Get<BenchUnit<7>>().value +
+               stringLookup.Get<BenchUnit<13>>().value + stringLookup.Get<BenchUnit<19>>().value;
+    });
+
+    ::FreeUnits(std::make_index_sequence<::UNIT_COUNT> {});
+
+    std::cout << "kofe-bench-everywhere: " << iterations * ::LOOKUPS_PER_ITERATION << " lookups\n"
+              << "  typeid string + dynamic_cast: " << stringTime << " ns\n"
+              << "  per-type slot:                " << slotTime << " ns\n"
+              << "  speedup:                      " << stringTime / slotTime << "x" << std::endl;
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,71 @@
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <string>
+
+#include <assimp/Importer.hpp>
+
+#include <app_exceptions.h>
+#include <mesh/kmeshfile.h>
+
+
+namespace fs = std::filesystem;
+
+
+// compiles every model below the given directories into .kmesh files,
+// up to date ones are skipped unless --force is given
+int main(int argc, char** argv) {
+    bool force { false };
+    size_t compiled { 0 };
+    size_t failed { 0 };
+    indexoptimization::OptimizationStats stats {};
+
+    Assimp::Importer importer {};
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string argument { argv[i] };
+
+        if (argument == "--force") {
+            force = true;
+            continue;
+        }
+
+        if (!fs::is_directory(argument)) {
+            std::cerr << "[Error] \"" << argument << "\" is not a directory" << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        for (auto& entry : fs::recursive_directory_iterator(argument)) {
+            if (!entry.is_regular_file()) continue;
+
+            const fs::path& path = entry.path();
+            if (!importer.IsExtensionSupported(path.extension().string())) continue;
+            if (!force && KMeshFile::IsUpToDate(path)) continue;
+
+            try {
+                if (KMeshFile::Compile(path, path.parent_path(), &stats)) {
+                    ++compiled;
+                } else {
+                    std::cerr << "[Error] Can't write " << KMeshFile::GetPath(path) << std::endl;
+                    ++failed;
+                }
+            } catch (const ApplicationException& e) {
+                std::cerr << e.what() << std::endl;
+                ++failed;
+            } catch (const std::exception& e) {
+                std::cerr << "[Exception] " << e.what() << std::endl;
+                ++failed;
+            }
+        }
+    }
+
+    std::cout << "kofe-meshc: " << compiled << " compiled, " << failed << " failed" << std::endl;
+
+    if (stats.before.triangles) {
+        std::cout << "kofe-meshc: " << stats.after.triangles << " triangles, ACMR "
+                  << stats.before.GetAcmr() << " -> " << stats.after.GetAcmr() << ", ATVR "
+                  << stats.before.GetAtvr() << " -> " << stats.after.GetAtvr() << std::endl;
+    }
+
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
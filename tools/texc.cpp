@@ -0,0 +1,62 @@
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <string>
+
+#include <stb_image.h>
+
+#include <texture/compressedimage.h>
+
+
+namespace fs = std::filesystem;
+
+
+// compiles every image below the given directories into block compressed
+// .dds files with full mip chains, up to date ones are skipped unless
+// --force is given
+int main(int argc, char** argv) {
+    bool force { false };
+    size_t compiled { 0 };
+    size_t failed { 0 };
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string argument { argv[i] };
+
+        if (argument == "--force") {
+            force = true;
+            continue;
+        }
+
+        if (!fs::is_directory(argument)) {
+            std::cerr << "[Error] \"" << argument << "\" is not a directory" << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        for (auto& entry : fs::recursive_directory_iterator(argument)) {
+            if (!entry.is_regular_file()) continue;
+
+            const fs::path& path = entry.path();
+            if (path.extension() == ".dds") continue;
+
+            int width {}, height {}, channels {};
+            if (!stbi_info(path.string().c_str(), &width, &height, &channels)) continue;
+            if (!force && CompressedImage::IsUpToDate(path)) continue;
+
+            try {
+                if (CompressedImage::Compile(path)) {
+                    ++compiled;
+                } else {
+                    std::cerr << "[Error] Can't compile " << path << std::endl;
+                    ++failed;
+                }
+            } catch (const std::exception& e) {
+                std::cerr << "[Exception] " << e.what() << std::endl;
+                ++failed;
+            }
+        }
+    }
+
+    std::cout << "kofe-texc: " << compiled << " compiled, " << failed << " failed" << std::endl;
+
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}